@@ -7,6 +7,8 @@
 
 #include <atomic>
 #include <iomanip>
+#include <optional>
+#include <string>
 
 #include "core/IChildProcessManager.hpp"
 #include "core/IConfig.hpp"
@@ -24,6 +26,29 @@ namespace lms::audio
     {
         return std::make_unique<ffmpeg::Transcoder>(parameters);
     }
+
+    std::string_view getOutputMimeType(const TranscodeOutputParameters& outputParameters)
+    {
+        // TODO: use input mime type
+        if (outputParameters.format)
+        {
+            switch (*outputParameters.format)
+            {
+            case OutputFormat::MP3:
+                return "audio/mpeg";
+            case OutputFormat::OGG_OPUS:
+                return "audio/opus";
+            case OutputFormat::MATROSKA_OPUS:
+                return "audio/x-matroska";
+            case OutputFormat::OGG_VORBIS:
+                return "audio/ogg";
+            case OutputFormat::WEBM_VORBIS:
+                return "audio/webm";
+            }
+        }
+
+        return "application/octet-stream"; // default, should not happen
+    }
 } // namespace lms::audio
 
 // 使用lms::audio::ffmpeg命名空间
@@ -191,25 +216,7 @@ namespace lms::audio::ffmpeg
 
     std::string_view Transcoder::getOutputMimeType() const
     {
-        // TODO: use input mime type
-        if (_outputParams.format)
-        {
-            switch (*_outputParams.format)
-            {
-            case OutputFormat::MP3:
-                return "audio/mpeg";
-            case OutputFormat::OGG_OPUS:
-                return "audio/opus";
-            case OutputFormat::MATROSKA_OPUS:
-                return "audio/x-matroska";
-            case OutputFormat::OGG_VORBIS:
-                return "audio/ogg";
-            case OutputFormat::WEBM_VORBIS:
-                return "audio/webm";
-            }
-        }
-
-        return "application/octet-stream"; // default, should not happen
+        return audio::getOutputMimeType(_outputParams);
     }
 
     bool Transcoder::finished() const
@@ -218,4 +225,15 @@ namespace lms::audio::ffmpeg
 
         return _childProcess->finished();
     }
+
+    bool Transcoder::succeeded()
+    {
+        assert(_childProcess);
+
+        const std::optional<int> exitCode{ _childProcess->waitForExit() };
+        if (exitCode != 0)
+            LOG(ERROR, "ffmpeg failed, exit code = " << (exitCode ? std::to_string(*exitCode) : "none"));
+
+        return exitCode == 0;
+    }
 } // namespace lms::audio::ffmpeg
@@ -27,6 +27,7 @@ namespace lms::audio::ffmpeg
         const TranscodeOutputParameters& getOutputParameters() const override { return _outputParams; }
 
         bool finished() const override;
+        bool succeeded() override;
         static void init();
         void start();
 
@@ -25,7 +25,11 @@ namespace lms::audio
         virtual const TranscodeOutputParameters& getOutputParameters() const = 0;
 
         virtual bool finished() const = 0;
+        virtual bool succeeded() = 0; // blocking call, to be called once finished
     };
 
     std::unique_ptr<ITranscoder> createTranscoder(const TranscodeParameters& parameters);
+
+    // Mime type of the data produced by a transcoder created using these output parameters
+    std::string_view getOutputMimeType(const TranscodeOutputParameters& outputParameters);
 } // namespace lms::audio
\ No newline at end of file
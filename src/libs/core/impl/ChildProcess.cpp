@@ -139,6 +139,9 @@ namespace lms::core
                 LMS_LOG(CHILDPROCESS, ERROR, "Closed failed: " << closeError.message());
         }
 
+        if (_waited)
+            return;
+
         if (!_finished)
             kill();
 
@@ -220,4 +223,24 @@ namespace lms::core
     {
         return _finished;
     }
+
+    std::optional<int> ChildProcess::waitForExit()
+    {
+        assert(finished());
+
+        if (!_waited)
+        {
+            try
+            {
+                wait(true);
+            }
+            catch (const ChildProcessException& e)
+            {
+                LMS_LOG(CHILDPROCESS, ERROR, "Cannot wait for child process: " << e.what());
+                return std::nullopt;
+            }
+        }
+
+        return _exitCode;
+    }
 } // namespace lms::core
\ No newline at end of file
@@ -29,6 +29,7 @@ namespace lms::core
         void asyncRead(std::byte* data, std::size_t bufferSize, ReadCallback callback) override;
         std::size_t readSome(std::byte* data, std::size_t bufferSize) override;
         bool finished() const override;
+        std::optional<int> waitForExit() override;
 
         void kill();
         bool wait(bool block); // return true if waited
@@ -0,0 +1,220 @@
+// 磁盘 LRU 缓存实现
+
+#include "core/DiskLruCache.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <span>
+#include <sstream>
+#include <vector>
+
+#include "core/ILogger.hpp"
+#include "core/XxHash3.hpp"
+
+namespace lms::core
+{
+    namespace
+    {
+        constexpr std::string_view tmpFileExtension{ ".tmp" };
+    }
+
+    DiskLruCache::DiskLruCache(const std::filesystem::path& directory, std::size_t maxCacheSize)
+        : _directory{ directory }
+        , _maxCacheSize{ maxCacheSize }
+    {
+        std::filesystem::create_directories(_directory);
+        loadEntries();
+    }
+
+    DiskLruCache::~DiskLruCache() = default;
+
+    DiskLruCache::Key DiskLruCache::computeKey(std::string_view description)
+    {
+        const std::uint64_t hash{ xxHash3_64(std::as_bytes(std::span{ description })) };
+
+        std::ostringstream key;
+        key << std::hex << std::setfill('0') << std::setw(16) << hash;
+        return key.str();
+    }
+
+    std::optional<std::filesystem::path> DiskLruCache::getEntry(const Key& key)
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        const auto itEntry{ _entriesByKey.find(key) };
+        if (itEntry == std::cend(_entriesByKey))
+        {
+            _cacheMisses++;
+            return std::nullopt;
+        }
+
+        // Also keeps track of the use in order to preserve the LRU order across restarts
+        const std::filesystem::path entryPath{ getEntryPath(key) };
+        std::error_code ec;
+        std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), ec);
+        if (ec)
+        {
+            // removed behind our back
+            LMS_LOG(UTILS, DEBUG, "Cannot access cache entry " << entryPath << ": " << ec.message());
+            removeEntry(itEntry->second);
+            _cacheMisses++;
+            return std::nullopt;
+        }
+
+        _cacheHits++;
+        _entries.splice(std::begin(_entries), _entries, itEntry->second);
+
+        return entryPath;
+    }
+
+    bool DiskLruCache::hasEntry(const Key& key) const
+    {
+        const std::scoped_lock lock{ _mutex };
+        return _entriesByKey.contains(key);
+    }
+
+    void DiskLruCache::removeInvalidEntry(const Key& key)
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        // may have been evicted in the meantime
+        if (const auto itEntry{ _entriesByKey.find(key) }; itEntry != std::cend(_entriesByKey))
+            removeEntry(itEntry->second);
+
+        _cacheHits--;
+        _cacheMisses++;
+    }
+
+    std::optional<std::filesystem::path> DiskLruCache::beginWrite(const Key& key)
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        if (!_keysBeingWritten.insert(key).second)
+            return std::nullopt;
+
+        return _directory / (key + "." + std::to_string(_writeCount++) + std::string{ tmpFileExtension });
+    }
+
+    bool DiskLruCache::endWrite(const Key& key, const std::filesystem::path& tmpFilePath, std::optional<std::size_t> size)
+    {
+        std::error_code ec;
+
+        const std::scoped_lock lock{ _mutex };
+
+        _keysBeingWritten.erase(key);
+
+        if (size && *size > 0 && *size <= _maxCacheSize)
+        {
+            std::filesystem::rename(tmpFilePath, getEntryPath(key), ec);
+            if (!ec)
+            {
+                addEntry(key, *size);
+                return true;
+            }
+
+            LMS_LOG(UTILS, ERROR, "Cannot move " << tmpFilePath << " in cache: " << ec.message());
+        }
+
+        std::filesystem::remove(tmpFilePath, ec);
+        return false;
+    }
+
+    DiskLruCache::Stats DiskLruCache::getStats() const
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        return Stats{
+            .hits = _cacheHits,
+            .misses = _cacheMisses,
+            .entryCount = _entries.size(),
+            .size = _cacheSize,
+            .maxSize = _maxCacheSize,
+        };
+    }
+
+    void DiskLruCache::loadEntries()
+    {
+        struct FileEntry
+        {
+            Entry entry;
+            std::filesystem::file_time_type lastWriteTime;
+        };
+        std::vector<FileEntry> fileEntries;
+
+        for (const std::filesystem::directory_entry& directoryEntry : std::filesystem::directory_iterator{ _directory })
+        {
+            if (!directoryEntry.is_regular_file())
+                continue;
+
+            std::error_code ec;
+
+            // Leftovers of entries that were being written
+            if (directoryEntry.path().extension() == tmpFileExtension)
+            {
+                std::filesystem::remove(directoryEntry.path(), ec);
+                continue;
+            }
+
+            const std::size_t size{ directoryEntry.file_size(ec) };
+            if (ec)
+                continue;
+
+            // max size may have been lowered
+            if (size > _maxCacheSize)
+            {
+                std::filesystem::remove(directoryEntry.path(), ec);
+                continue;
+            }
+
+            const std::filesystem::file_time_type lastWriteTime{ directoryEntry.last_write_time(ec) };
+            if (ec)
+                continue;
+
+            fileEntries.push_back(FileEntry{ .entry = Entry{ .key = directoryEntry.path().filename().string(), .size = size }, .lastWriteTime = lastWriteTime });
+        }
+
+        // oldest first, so that the most recently used end up at the front (and the oldest get evicted if needed)
+        std::sort(std::begin(fileEntries), std::end(fileEntries), [](const FileEntry& lhs, const FileEntry& rhs) { return lhs.lastWriteTime < rhs.lastWriteTime; });
+
+        const std::scoped_lock lock{ _mutex };
+        for (const FileEntry& fileEntry : fileEntries)
+            addEntry(fileEntry.entry.key, fileEntry.entry.size);
+    }
+
+    std::filesystem::path DiskLruCache::getEntryPath(const Key& key) const
+    {
+        return _directory / key;
+    }
+
+    void DiskLruCache::addEntry(const Key& key, std::size_t size)
+    {
+        // the file may just have been replaced
+        if (const auto itEntry{ _entriesByKey.find(key) }; itEntry != std::cend(_entriesByKey))
+        {
+            const Entries::iterator itReplacedEntry{ itEntry->second };
+            _cacheSize -= itReplacedEntry->size;
+            _entriesByKey.erase(itEntry);
+            _entries.erase(itReplacedEntry);
+        }
+
+        while (_cacheSize + size > _maxCacheSize && !_entries.empty())
+            removeEntry(std::prev(std::end(_entries)));
+
+        _entries.push_front(Entry{ .key = key, .size = size });
+        _entriesByKey.emplace(_entries.front().key, std::begin(_entries));
+        _cacheSize += size;
+    }
+
+    void DiskLruCache::removeEntry(Entries::iterator itEntry)
+    {
+        // files being read remain readable until they are closed
+        std::error_code ec;
+        std::filesystem::remove(getEntryPath(itEntry->key), ec);
+        if (ec)
+            LMS_LOG(UTILS, ERROR, "Cannot remove cache entry " << getEntryPath(itEntry->key) << ": " << ec.message());
+
+        _cacheSize -= itEntry->size;
+        _entriesByKey.erase(itEntry->key);
+        _entries.erase(itEntry);
+    }
+} // namespace lms::core
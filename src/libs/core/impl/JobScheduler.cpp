@@ -8,10 +8,20 @@
 
 #include "core/IJob.hpp"
 
+#include "WorkStealingJobScheduler.hpp"
+
 namespace lms::core
 {
-    std::unique_ptr<IJobScheduler> createJobScheduler(core::LiteralString name, std::size_t threadCount)
+    std::unique_ptr<IJobScheduler> createJobScheduler(core::LiteralString name, std::size_t threadCount, JobSchedulerType type)
     {
+        switch (type)
+        {
+        case JobSchedulerType::IOContext:
+            break;
+        case JobSchedulerType::WorkStealing:
+            return std::make_unique<WorkStealingJobScheduler>(name, threadCount);
+        }
+
         return std::make_unique<JobScheduler>(name, threadCount);
     }
 
@@ -33,24 +43,33 @@ namespace lms::core
         return _ioContextRunner.getThreadCount();
     }
 
-    void JobScheduler::scheduleJob(std::unique_ptr<IJob> job)
+    void JobScheduler::scheduleJob(std::unique_ptr<IJob> job, JobPriority /* priority */)
     {
+        // boost::asio runs the handlers in order, priorities are not supported
         {
             std::scoped_lock lock{ _mutex };
             _ongoingJobCount += 1;
         }
+        _metrics.onJobScheduled();
 
-        auto jobHandler{ [job = std::move(job), this]() mutable {
+        auto jobHandler{ [job = std::move(job), scheduleTime = JobSchedulerMetrics::Clock::now(), this]() mutable {
             if (_abortCallback && _abortCallback())
             {
+                _metrics.onJobAborted();
+
                 std::scoped_lock lock{ _mutex };
                 _ongoingJobCount -= 1;
             }
             else
             {
                 {
+                    const auto startTime{ JobSchedulerMetrics::Clock::now() };
+                    _metrics.onJobStarted(scheduleTime, startTime);
+
                     LMS_SCOPED_TRACE_OVERVIEW(_name, job->getName());
                     job->run();
+
+                    _metrics.onJobExecuted(startTime, JobSchedulerMetrics::Clock::now());
                 }
 
                 {
@@ -109,4 +128,15 @@ namespace lms::core
         waitUntilJobCountAtMost(0);
     }
 
+    JobScheduler::Metrics JobScheduler::getMetrics() const
+    {
+        Metrics metrics{ _metrics.get() };
+
+        std::scoped_lock lock{ _mutex };
+        metrics.ongoingJobCount = _ongoingJobCount;
+        metrics.doneJobCount = _doneJobs.size();
+
+        return metrics;
+    }
+
 } // namespace lms::core
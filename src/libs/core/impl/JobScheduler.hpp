@@ -8,6 +8,8 @@
 #include "core/IJobScheduler.hpp"
 #include "core/IOContextRunner.hpp"
 
+#include "JobSchedulerMetrics.hpp"
+
 namespace lms::core
 {
     // JobScheduler: 基于 boost::asio 的任务调度器实现，在独立线程中执行任务并支持等待/中止。
@@ -24,7 +26,7 @@ namespace lms::core
         void setShouldAbortCallback(ShouldAbortCallback callback) override;
 
         std::size_t getThreadCount() const override;
-        void scheduleJob(std::unique_ptr<IJob> job) override;
+        void scheduleJob(std::unique_ptr<IJob> job, JobPriority priority) override;
 
         std::size_t getJobsDoneCount() const override;
         size_t popJobsDone(std::vector<std::unique_ptr<IJob>>& jobs, std::size_t maxCount) override;
@@ -32,6 +34,8 @@ namespace lms::core
         void waitUntilJobCountAtMost(std::size_t maxOngoingJobs) override;
         void wait() override;
 
+        Metrics getMetrics() const override;
+
         core::LiteralString _name;
         boost::asio::io_context _ioContext;
         core::IOContextRunner _ioContextRunner;
@@ -42,5 +46,6 @@ namespace lms::core
         std::atomic<std::size_t> _ongoingJobCount;
         std::deque<std::unique_ptr<IJob>> _doneJobs;
         std::condition_variable _condVar;
+        JobSchedulerMetrics _metrics;
     };
 } // namespace lms::core
\ No newline at end of file
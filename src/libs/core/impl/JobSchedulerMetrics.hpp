@@ -0,0 +1,69 @@
+// 任务调度器统计数据收集
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "core/IJobScheduler.hpp"
+
+namespace lms::core
+{
+    // JobSchedulerMetrics: 无锁地累计任务的排队时间与执行时间。
+    // JobSchedulerMetrics: накапливает без блокировок время ожидания и выполнения задач.
+    class JobSchedulerMetrics
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void onJobScheduled() { _queuedJobCount.fetch_add(1, std::memory_order_relaxed); }
+
+        void onJobStarted(Clock::time_point scheduleTime, Clock::time_point startTime)
+        {
+            _queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+            add(_totalWaitTime, _maxWaitTime, startTime - scheduleTime);
+        }
+
+        void onJobAborted() { _queuedJobCount.fetch_sub(1, std::memory_order_relaxed); }
+
+        void onJobExecuted(Clock::time_point startTime, Clock::time_point endTime)
+        {
+            _executedJobCount.fetch_add(1, std::memory_order_relaxed);
+            add(_totalRunTime, _maxRunTime, endTime - startTime);
+        }
+
+        // ongoing and done job counts are tracked by the schedulers
+        IJobScheduler::Metrics get() const
+        {
+            IJobScheduler::Metrics metrics;
+            metrics.queuedJobCount = _queuedJobCount.load(std::memory_order_relaxed);
+            metrics.executedJobCount = _executedJobCount.load(std::memory_order_relaxed);
+            metrics.totalWaitTime = std::chrono::microseconds{ _totalWaitTime.load(std::memory_order_relaxed) };
+            metrics.maxWaitTime = std::chrono::microseconds{ _maxWaitTime.load(std::memory_order_relaxed) };
+            metrics.totalRunTime = std::chrono::microseconds{ _totalRunTime.load(std::memory_order_relaxed) };
+            metrics.maxRunTime = std::chrono::microseconds{ _maxRunTime.load(std::memory_order_relaxed) };
+
+            return metrics;
+        }
+
+    private:
+        static void add(std::atomic<std::uint64_t>& total, std::atomic<std::uint64_t>& max, Clock::duration duration)
+        {
+            const std::uint64_t value{ static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) };
+
+            total.fetch_add(value, std::memory_order_relaxed);
+
+            std::uint64_t currentMax{ max.load(std::memory_order_relaxed) };
+            while (currentMax < value && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed))
+                ;
+        }
+
+        std::atomic<std::size_t> _queuedJobCount{};
+        std::atomic<std::uint64_t> _executedJobCount{};
+        std::atomic<std::uint64_t> _totalWaitTime{}; // in microseconds
+        std::atomic<std::uint64_t> _maxWaitTime{};
+        std::atomic<std::uint64_t> _totalRunTime{};
+        std::atomic<std::uint64_t> _maxRunTime{};
+    };
+} // namespace lms::core
@@ -67,14 +67,20 @@ namespace lms::core::stringUtils
         template<std::size_t N>
         void writeEscapedString(std::ostream& os, std::string_view str, const std::pair<char, std::string_view> (&charsToEscape)[N])
         {
-            for (const char c : str)
+            // write runs of chars that do not need escaping at once
+            std::size_t runBegin{};
+            for (std::size_t i{}; i < str.size(); ++i)
             {
+                const char c{ str[i] };
                 auto itEntry{ std::find_if(std::cbegin(charsToEscape), std::cend(charsToEscape), [=](const auto& entry) { return entry.first == c; }) };
-                if (itEntry != std::cend(charsToEscape))
-                    os << itEntry->second;
-                else
-                    os << c;
+                if (itEntry == std::cend(charsToEscape))
+                    continue;
+
+                os.write(str.data() + runBegin, static_cast<std::streamsize>(i - runBegin));
+                os << itEntry->second;
+                runBegin = i + 1;
             }
+            os.write(str.data() + runBegin, static_cast<std::streamsize>(str.size() - runBegin));
         }
 
         template<typename StringType>
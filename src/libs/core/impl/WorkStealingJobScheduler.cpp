@@ -0,0 +1,321 @@
+// 工作窃取式任务调度器实现
+
+#include "WorkStealingJobScheduler.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include "core/IJob.hpp"
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+#include "core/Service.hpp"
+
+namespace lms::core
+{
+    namespace
+    {
+        // Used to push the jobs scheduled by a job in the queue of the current worker
+        thread_local const WorkStealingJobScheduler* currentScheduler{};
+        thread_local std::size_t currentWorkerIndex{};
+    } // namespace
+
+    WorkStealingJobScheduler::WorkStealingJobScheduler(core::LiteralString name, std::size_t threadCount)
+        : _name{ name }
+    {
+        threadCount = std::max<std::size_t>(threadCount, 1);
+
+        LMS_LOG(UTILS, INFO, "Starting work stealing job scheduler with " << threadCount << " threads...");
+
+        _workers.reserve(threadCount);
+        for (std::size_t i{}; i < threadCount; ++i)
+            _workers.push_back(std::make_unique<Worker>());
+
+        // start threads once all the workers are created, as they may steal from each other
+        for (std::size_t i{}; i < threadCount; ++i)
+            _workers[i]->thread = std::thread{ [this, i] { workerLoop(i); } };
+    }
+
+    WorkStealingJobScheduler::~WorkStealingJobScheduler()
+    {
+        // like the io_context based scheduler, pending jobs are just dropped
+        _stopping = true;
+        for (const std::unique_ptr<Worker>& worker : _workers)
+        {
+            {
+                std::scoped_lock lock{ worker->sleepMutex };
+            }
+            worker->sleepCondVar.notify_one();
+        }
+
+        for (const std::unique_ptr<Worker>& worker : _workers)
+            worker->thread.join();
+
+        DoneJobNode* node{ _doneJobsHead.exchange(nullptr) };
+        while (node)
+        {
+            DoneJobNode* next{ node->next };
+            delete node;
+            node = next;
+        }
+    }
+
+    void WorkStealingJobScheduler::setShouldAbortCallback(ShouldAbortCallback callback)
+    {
+        _abortCallback = callback;
+    }
+
+    std::size_t WorkStealingJobScheduler::getThreadCount() const
+    {
+        return _workers.size();
+    }
+
+    void WorkStealingJobScheduler::scheduleJob(std::unique_ptr<IJob> job, JobPriority priority)
+    {
+        _ongoingJobCount += 1;
+        _metrics.onJobScheduled();
+
+        const std::size_t workerIndex{ currentScheduler == this ? currentWorkerIndex : _nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) % _workers.size() };
+
+        Worker& worker{ *_workers[workerIndex] };
+        {
+            std::scoped_lock lock{ worker.queueMutex };
+
+            // count first: a worker that sees a null count is guaranteed not to miss this job, see sleep()
+            _queuedJobCount += 1;
+            worker.queues[static_cast<std::size_t>(priority)].push_back(Task{ std::move(job), JobSchedulerMetrics::Clock::now() });
+        }
+
+        wakeOneWorker(workerIndex);
+    }
+
+    std::size_t WorkStealingJobScheduler::getJobsDoneCount() const
+    {
+        return _doneJobCount.load();
+    }
+
+    size_t WorkStealingJobScheduler::popJobsDone(std::vector<std::unique_ptr<IJob>>& doneJobs, std::size_t maxCount)
+    {
+        doneJobs.clear();
+        doneJobs.reserve(maxCount);
+
+        {
+            std::scoped_lock lock{ _doneJobsMutex };
+
+            if (_doneJobs.size() < maxCount)
+                collectDoneJobs();
+
+            while (doneJobs.size() < maxCount && !_doneJobs.empty())
+            {
+                doneJobs.push_back(std::move(_doneJobs.front()));
+                _doneJobs.pop_front();
+            }
+        }
+
+        _doneJobCount -= doneJobs.size();
+
+        return doneJobs.size();
+    }
+
+    void WorkStealingJobScheduler::waitUntilJobCountAtMost(std::size_t maxOngoingJobs)
+    {
+        if (_ongoingJobCount <= maxOngoingJobs)
+            return;
+
+        {
+            LMS_SCOPED_TRACE_OVERVIEW(_name, "WaitJobs");
+
+            std::unique_lock lock{ _waitMutex };
+
+            // workers only notify when the ongoing job count reaches a threshold someone is waiting for
+            const auto itThreshold{ _waitThresholds.insert(maxOngoingJobs) };
+            _maxWaitThreshold = *_waitThresholds.rbegin() + 1;
+
+            _waitCondVar.wait(lock, [=, this] { return _ongoingJobCount <= maxOngoingJobs; });
+
+            _waitThresholds.erase(itThreshold);
+            _maxWaitThreshold = _waitThresholds.empty() ? 0 : *_waitThresholds.rbegin() + 1;
+        }
+    }
+
+    void WorkStealingJobScheduler::wait()
+    {
+        waitUntilJobCountAtMost(0);
+    }
+
+    WorkStealingJobScheduler::Metrics WorkStealingJobScheduler::getMetrics() const
+    {
+        Metrics metrics{ _metrics.get() };
+        metrics.ongoingJobCount = _ongoingJobCount.load();
+        metrics.doneJobCount = _doneJobCount.load();
+
+        return metrics;
+    }
+
+    void WorkStealingJobScheduler::workerLoop(std::size_t workerIndex)
+    {
+        currentScheduler = this;
+        currentWorkerIndex = workerIndex;
+
+        if (!_name.empty())
+        {
+            if (auto* traceLogger{ Service<tracing::ITraceLogger>::get() })
+                traceLogger->setThreadName(std::this_thread::get_id(), std::string{ _name.str() } + "Thread_" + std::to_string(workerIndex));
+        }
+
+        Worker& worker{ *_workers[workerIndex] };
+
+        try
+        {
+            while (!_stopping)
+            {
+                if (std::optional<Task> task{ popTask(workerIndex) })
+                    runTask(*task);
+                else
+                    sleep(worker);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            LMS_LOG(UTILS, FATAL, "Exception caught in job scheduler: " << e.what());
+            std::abort();
+        }
+    }
+
+    std::optional<WorkStealingJobScheduler::Task> WorkStealingJobScheduler::popTask(std::size_t workerIndex)
+    {
+        for (std::size_t priority{ priorityCount }; priority-- > 0;)
+        {
+            // Own queue first, oldest job first
+            {
+                Worker& worker{ *_workers[workerIndex] };
+                std::scoped_lock lock{ worker.queueMutex };
+
+                std::deque<Task>& queue{ worker.queues[priority] };
+                if (!queue.empty())
+                {
+                    Task task{ std::move(queue.front()) };
+                    queue.pop_front();
+                    _queuedJobCount -= 1;
+                    return task;
+                }
+            }
+
+            // Then steal the most recent job of the other workers
+            for (std::size_t i{ 1 }; i < _workers.size(); ++i)
+            {
+                if (_queuedJobCount == 0)
+                    return std::nullopt;
+
+                Worker& victim{ *_workers[(workerIndex + i) % _workers.size()] };
+                std::scoped_lock lock{ victim.queueMutex };
+
+                std::deque<Task>& queue{ victim.queues[priority] };
+                if (!queue.empty())
+                {
+                    Task task{ std::move(queue.back()) };
+                    queue.pop_back();
+                    _queuedJobCount -= 1;
+                    return task;
+                }
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void WorkStealingJobScheduler::runTask(Task& task)
+    {
+        if (_abortCallback && _abortCallback())
+        {
+            _metrics.onJobAborted();
+            onJobDone();
+            return;
+        }
+
+        const auto startTime{ JobSchedulerMetrics::Clock::now() };
+        _metrics.onJobStarted(task.scheduleTime, startTime);
+
+        {
+            LMS_SCOPED_TRACE_OVERVIEW(_name, task.job->getName());
+            task.job->run();
+        }
+
+        _metrics.onJobExecuted(startTime, JobSchedulerMetrics::Clock::now());
+
+        pushDoneJob(std::move(task.job));
+        onJobDone();
+    }
+
+    void WorkStealingJobScheduler::sleep(Worker& worker)
+    {
+        std::unique_lock lock{ worker.sleepMutex };
+
+        // Announce first, then check: either the scheduling thread sees this worker sleeping, or this worker sees the queued job
+        worker.sleeping = true;
+        if (_queuedJobCount == 0 && !_stopping)
+            worker.sleepCondVar.wait(lock, [&] { return worker.wakeRequested || _stopping; });
+
+        worker.wakeRequested = false;
+        worker.sleeping = false;
+    }
+
+    void WorkStealingJobScheduler::wakeOneWorker(std::size_t preferredWorkerIndex)
+    {
+        // Wake the worker that owns the job if it is idle, otherwise another idle worker that will steal it
+        for (std::size_t i{}; i < _workers.size(); ++i)
+        {
+            Worker& worker{ *_workers[(preferredWorkerIndex + i) % _workers.size()] };
+            if (!worker.sleeping)
+                continue;
+
+            {
+                std::scoped_lock lock{ worker.sleepMutex };
+                worker.wakeRequested = true;
+            }
+            worker.sleepCondVar.notify_one();
+            return;
+        }
+    }
+
+    void WorkStealingJobScheduler::pushDoneJob(std::unique_ptr<IJob> job)
+    {
+        // count first so that the count never goes below the actual number of collectable jobs
+        _doneJobCount += 1;
+
+        DoneJobNode* node{ new DoneJobNode{ std::move(job), _doneJobsHead.load(std::memory_order_relaxed) } };
+        while (!_doneJobsHead.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    void WorkStealingJobScheduler::collectDoneJobs()
+    {
+        DoneJobNode* node{ _doneJobsHead.exchange(nullptr, std::memory_order_acquire) };
+
+        const std::size_t firstNewJobIndex{ _doneJobs.size() };
+        while (node)
+        {
+            _doneJobs.push_back(std::move(node->job));
+
+            DoneJobNode* next{ node->next };
+            delete node;
+            node = next;
+        }
+
+        // stack order is the reverse completion order
+        std::reverse(std::next(std::begin(_doneJobs), firstNewJobIndex), std::end(_doneJobs));
+    }
+
+    void WorkStealingJobScheduler::onJobDone()
+    {
+        const std::size_t ongoingJobCount{ --_ongoingJobCount };
+
+        if (ongoingJobCount < _maxWaitThreshold)
+        {
+            {
+                std::scoped_lock lock{ _waitMutex };
+            }
+            _waitCondVar.notify_all();
+        }
+    }
+} // namespace lms::core
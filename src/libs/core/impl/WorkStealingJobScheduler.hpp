@@ -0,0 +1,104 @@
+// 工作窃取式任务调度器声明
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "core/IJobScheduler.hpp"
+
+#include "JobSchedulerMetrics.hpp"
+
+namespace lms::core
+{
+    // WorkStealingJobScheduler: 每个线程拥有按优先级划分的任务队列，空闲线程从其他线程窃取任务，完成的任务放入无锁队列。
+    // WorkStealingJobScheduler: у каждого потока свои очереди задач по приоритетам, простаивающие потоки крадут задачи у других, завершённые задачи попадают в очередь без блокировок.
+    class WorkStealingJobScheduler : public IJobScheduler
+    {
+    public:
+        WorkStealingJobScheduler(core::LiteralString name, std::size_t threadCount);
+        ~WorkStealingJobScheduler() override;
+        WorkStealingJobScheduler(const WorkStealingJobScheduler&) = delete;
+        WorkStealingJobScheduler& operator=(const WorkStealingJobScheduler&) = delete;
+
+    private:
+        void setShouldAbortCallback(ShouldAbortCallback callback) override;
+
+        std::size_t getThreadCount() const override;
+        void scheduleJob(std::unique_ptr<IJob> job, JobPriority priority) override;
+
+        std::size_t getJobsDoneCount() const override;
+        size_t popJobsDone(std::vector<std::unique_ptr<IJob>>& jobs, std::size_t maxCount) override;
+
+        void waitUntilJobCountAtMost(std::size_t maxOngoingJobs) override;
+        void wait() override;
+
+        Metrics getMetrics() const override;
+
+        struct Task
+        {
+            std::unique_ptr<IJob> job;
+            JobSchedulerMetrics::Clock::time_point scheduleTime;
+        };
+
+        static constexpr std::size_t priorityCount{ 3 };
+
+        struct Worker
+        {
+            std::mutex queueMutex;
+            std::array<std::deque<Task>, priorityCount> queues; // indexed by priority
+
+            std::mutex sleepMutex;
+            std::condition_variable sleepCondVar;
+            std::atomic<bool> sleeping{};
+            bool wakeRequested{};
+
+            std::thread thread;
+        };
+
+        // Intrusive stack node, used to push done jobs without locking
+        struct DoneJobNode
+        {
+            std::unique_ptr<IJob> job;
+            DoneJobNode* next{};
+        };
+
+        void workerLoop(std::size_t workerIndex);
+        std::optional<Task> popTask(std::size_t workerIndex);
+        void runTask(Task& task);
+        void sleep(Worker& worker);
+        void wakeOneWorker(std::size_t preferredWorkerIndex);
+        void pushDoneJob(std::unique_ptr<IJob> job);
+        void collectDoneJobs(); // _doneJobsMutex must be held
+        void onJobDone();
+
+        core::LiteralString _name;
+        ShouldAbortCallback _abortCallback;
+
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::atomic<std::size_t> _nextWorkerIndex{}; // round robin for jobs scheduled from outside the workers
+        std::atomic<std::size_t> _queuedJobCount{};
+        std::atomic<std::size_t> _ongoingJobCount{};
+        std::atomic<bool> _stopping{};
+
+        std::atomic<DoneJobNode*> _doneJobsHead{}; // most recently done job first
+        std::atomic<std::size_t> _doneJobCount{};
+        mutable std::mutex _doneJobsMutex;           // only taken by the consumers of done jobs
+        std::deque<std::unique_ptr<IJob>> _doneJobs; // collected done jobs, in completion order
+
+        std::mutex _waitMutex;
+        std::condition_variable _waitCondVar;
+        std::multiset<std::size_t> _waitThresholds;   // one per waiting thread
+        std::atomic<std::size_t> _maxWaitThreshold{}; // 1 + max of _waitThresholds, 0 if no one is waiting
+
+        JobSchedulerMetrics _metrics;
+    };
+} // namespace lms::core
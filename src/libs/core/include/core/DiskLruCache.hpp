@@ -0,0 +1,83 @@
+// 磁盘 LRU 缓存接口
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lms::core
+{
+    // DiskLruCache: 目录中的文件缓存（每个条目一个以键命名的文件），按 LRU 限制磁盘占用，重启后根据修改时间恢复 LRU 顺序。
+    // DiskLruCache: файловый кэш в каталоге (один файл на запись, названный по ключу), ограничивает место на диске по LRU, порядок LRU восстанавливается после перезапуска по времени изменения.
+    //
+    // Entries are written in temporary files that are moved in the cache once complete
+    class DiskLruCache
+    {
+    public:
+        DiskLruCache(const std::filesystem::path& directory, std::size_t maxCacheSize);
+        ~DiskLruCache();
+        DiskLruCache(const DiskLruCache&) = delete;
+        DiskLruCache& operator=(const DiskLruCache&) = delete;
+
+        using Key = std::string;
+
+        // description must contain everything the entry depends on
+        static Key computeKey(std::string_view description);
+
+        std::size_t getMaxCacheSize() const { return _maxCacheSize; }
+
+        // No path if there is no such entry, otherwise the entry becomes the most recently used
+        std::optional<std::filesystem::path> getEntry(const Key& key);
+        bool hasEntry(const Key& key) const; // not counted as an access
+        // For entries that turn out to be unusable once returned by getEntry: the access is counted as a miss
+        void removeInvalidEntry(const Key& key);
+
+        // No path if the entry is already being written, otherwise endWrite must be called
+        std::optional<std::filesystem::path> beginWrite(const Key& key);
+        // size: no value to discard what has been written. Returns true if the entry has been added
+        bool endWrite(const Key& key, const std::filesystem::path& tmpFilePath, std::optional<std::size_t> size);
+
+        // Counters are cumulated since the cache creation
+        struct Stats
+        {
+            std::size_t hits{};
+            std::size_t misses{};
+            std::size_t entryCount{};
+            std::size_t size{};
+            std::size_t maxSize{};
+        };
+        Stats getStats() const;
+
+    private:
+        struct Entry
+        {
+            Key key;
+            std::size_t size{};
+        };
+        using Entries = std::list<Entry>; // most recently used first
+
+        void loadEntries();
+        std::filesystem::path getEntryPath(const Key& key) const;
+        void addEntry(const Key& key, std::size_t size);
+        void removeEntry(Entries::iterator itEntry);
+
+        const std::filesystem::path _directory;
+        const std::size_t _maxCacheSize;
+
+        mutable std::mutex _mutex;
+        Entries _entries;
+        std::unordered_map<std::string_view, Entries::iterator> _entriesByKey; // keys owned by _entries
+        std::unordered_set<Key> _keysBeingWritten;
+        std::size_t _cacheSize{};
+        std::size_t _cacheHits{};
+        std::size_t _cacheMisses{};
+        std::size_t _writeCount{}; // to generate unique temporary file names
+    };
+} // namespace lms::core
@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <functional>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -39,5 +40,8 @@ namespace lms::core
 
         virtual std::size_t readSome(std::byte* data, std::size_t bufferSize) = 0;
         virtual bool finished() const = 0;
+
+        // Blocks until the process exits, to be called once finished. No exit code if killed by a signal
+        virtual std::optional<int> waitForExit() = 0;
     };
 } // namespace lms::core
\ No newline at end of file
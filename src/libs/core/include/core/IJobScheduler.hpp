@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -11,6 +13,14 @@
 namespace lms::core
 {
     class IJob;
+
+    enum class JobPriority
+    {
+        Low,
+        Normal,
+        High,
+    };
+
     // IJobScheduler: 后台任务调度器接口，负责在线程池中调度 IJob 并跟踪完成情况。
     // IJobScheduler: интерфейс планировщика фоновых задач, выполняет IJob в пуле потоков и отслеживает их завершение.
     class IJobScheduler
@@ -22,14 +32,33 @@ namespace lms::core
         virtual void setShouldAbortCallback(ShouldAbortCallback callback) = 0;
 
         virtual std::size_t getThreadCount() const = 0;
-        virtual void scheduleJob(std::unique_ptr<IJob> job) = 0;
+        virtual void scheduleJob(std::unique_ptr<IJob> job, JobPriority priority = JobPriority::Normal) = 0;
 
         virtual std::size_t getJobsDoneCount() const = 0;
         virtual size_t popJobsDone(std::vector<std::unique_ptr<IJob>>& jobs, std::size_t maxCount) = 0;
 
         virtual void waitUntilJobCountAtMost(std::size_t maxOngoingJobs) = 0;
         virtual void wait() = 0;
+
+        struct Metrics
+        {
+            std::size_t queuedJobCount{};  // scheduled, not started yet
+            std::size_t ongoingJobCount{}; // scheduled, not done yet
+            std::size_t doneJobCount{};    // done, not popped yet
+            std::uint64_t executedJobCount{};
+            std::chrono::microseconds totalWaitTime{}; // time spent in queue
+            std::chrono::microseconds maxWaitTime{};
+            std::chrono::microseconds totalRunTime{};
+            std::chrono::microseconds maxRunTime{};
+        };
+        virtual Metrics getMetrics() const = 0;
+    };
+
+    enum class JobSchedulerType
+    {
+        IOContext,    // all the jobs are posted in a shared boost::asio::io_context
+        WorkStealing, // per thread queues, idle threads steal jobs from the busy ones
     };
 
-    std::unique_ptr<IJobScheduler> createJobScheduler(core::LiteralString name, std::size_t threadCount);
+    std::unique_ptr<IJobScheduler> createJobScheduler(core::LiteralString name, std::size_t threadCount, JobSchedulerType type = JobSchedulerType::IOContext);
 } // namespace lms::core
\ No newline at end of file
@@ -0,0 +1,36 @@
+// 并行区间处理辅助函数
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace lms::core
+{
+    // Splits [0, count) into at most threadCount contiguous ranges and calls func(begin, end) for each of them in its own thread
+    // func must not throw
+    template<typename Func>
+    void parallelForRanges(std::size_t count, std::size_t threadCount, Func func)
+    {
+        threadCount = std::clamp<std::size_t>(threadCount, 1, std::max<std::size_t>(count, 1));
+        if (threadCount == 1)
+        {
+            func(std::size_t{ 0 }, count);
+            return;
+        }
+
+        const std::size_t rangeSize{ (count + threadCount - 1) / threadCount };
+
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (std::size_t begin{ rangeSize }; begin < count; begin += rangeSize)
+            threads.emplace_back([=, &func] { func(begin, std::min(begin + rangeSize, count)); });
+
+        func(std::size_t{ 0 }, std::min(rangeSize, count));
+
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+} // namespace lms::core
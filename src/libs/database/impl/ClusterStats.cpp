@@ -0,0 +1,64 @@
+// 聚类统计脏标记表维护实现
+
+#include "ClusterStats.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "core/ILogger.hpp"
+#include "database/Session.hpp"
+
+#include "Utils.hpp"
+
+namespace lms::db::clusterStats
+{
+    namespace
+    {
+        // track_cluster insert and delete (including the ones done by cascade), track release update
+        constexpr std::array<std::string_view, 3> triggerNames{ "cluster_stats_dirty_tc_ai", "cluster_stats_dirty_tc_ad", "cluster_stats_dirty_t_au" };
+
+        // Changes may have been missed if any trigger is missing (dropped along with its table during a migration)
+        bool isComplete(Session& session)
+        {
+            auto query{ session.getDboSession()->query<int>("SELECT COUNT(*) FROM sqlite_master") };
+            query.where("name IN (?, ?, ?, ?)").bind("cluster_stats_dirty");
+            for (std::string_view triggerName : triggerNames)
+                query.bind(triggerName);
+
+            return static_cast<std::size_t>(utils::fetchQuerySingleResult(query)) == 1 + triggerNames.size();
+        }
+
+        void create(Session& session)
+        {
+            for (std::string_view triggerName : triggerNames)
+                utils::executeCommand(*session.getDboSession(), "DROP TRIGGER IF EXISTS " + std::string{ triggerName });
+            utils::executeCommand(*session.getDboSession(), "DROP TABLE IF EXISTS cluster_stats_dirty");
+
+            // no foreign key: rows of removed clusters are just ignored and cleared when the stats are computed
+            utils::executeCommand(*session.getDboSession(), "CREATE TABLE cluster_stats_dirty (cluster_id bigint NOT NULL PRIMARY KEY) WITHOUT ROWID");
+
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER cluster_stats_dirty_tc_ai AFTER INSERT ON track_cluster BEGIN"
+                                                            " INSERT OR IGNORE INTO cluster_stats_dirty(cluster_id) VALUES (new.cluster_id); END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER cluster_stats_dirty_tc_ad AFTER DELETE ON track_cluster BEGIN"
+                                                            " INSERT OR IGNORE INTO cluster_stats_dirty(cluster_id) VALUES (old.cluster_id); END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER cluster_stats_dirty_t_au AFTER UPDATE OF release_id ON track WHEN old.release_id IS NOT new.release_id BEGIN"
+                                                            " INSERT OR IGNORE INTO cluster_stats_dirty(cluster_id) SELECT t_c.cluster_id FROM track_cluster t_c WHERE t_c.track_id = new.id; END");
+
+            // the current stats cannot be trusted
+            utils::executeCommand(*session.getDboSession(), "INSERT INTO cluster_stats_dirty(cluster_id) SELECT id FROM cluster");
+        }
+    } // namespace
+
+    void createIfNeeded(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        if (isComplete(session))
+            return;
+
+        LMS_LOG(DB, INFO, "Creating cluster stats tracking...");
+        create(session);
+        LMS_LOG(DB, INFO, "Cluster stats tracking created!");
+    }
+} // namespace lms::db::clusterStats
@@ -0,0 +1,19 @@
+// 聚类统计脏标记表维护声明
+
+#pragma once
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::db::clusterStats
+{
+    // Clusters whose track/release counts may be out of date, one row per cluster
+    // It is kept up to date using triggers on the track_cluster and track tables, in the same transaction as the changes,
+    // so that an interrupted scan does not lose track of them
+    // Table: "cluster_stats_dirty"
+
+    // Creates the table if it is missing or may be out of sync (all the clusters are then marked as dirty)
+    void createIfNeeded(Session& session);
+} // namespace lms::db::clusterStats
@@ -3,6 +3,7 @@
 #include <functional>
 #include <memory>
 
+#include <Wt/Dbo/Exception.h>
 #include <Wt/Dbo/FixedSqlConnectionPool.h>
 #include <Wt/Dbo/Logger.h>
 #include <Wt/Dbo/backend/Sqlite3.h>
@@ -201,6 +202,7 @@ namespace lms::db
         logPageSize();
         logCacheSize();
         logCompileOptions();
+        detectFullTextSearchSupport();
         if (checkType == "quick")
         {
             performQuickCheck();
@@ -271,6 +273,25 @@ namespace lms::db
         });
     }
 
+    void Db::detectFullTextSearchSupport()
+    {
+        ScopedConnection connection{ *_connectionPool };
+
+        // FTS5 may not be compiled in, and the trigram tokenizer requires Sqlite3 >= 3.34
+        try
+        {
+            connection->executeSql("CREATE VIRTUAL TABLE temp.fts_support_check USING fts5(value, tokenize='trigram')");
+            connection->executeSql("DROP TABLE temp.fts_support_check");
+            _fullTextSearchSupported = true;
+        }
+        catch (const Wt::Dbo::Exception& e)
+        {
+            LMS_LOG(DB, DEBUG, "Full-text search check failed: " << e.what());
+        }
+
+        LMS_LOG(DB, INFO, "Full-text search supported: " << (_fullTextSearchSupported ? "yes" : "no"));
+    }
+
     void Db::performQuickCheck()
     {
         ScopedConnection connection{ *_connectionPool };
@@ -21,6 +21,8 @@ namespace lms::db
 
         void executeSql(const std::string& sql);
 
+        bool isFullTextSearchSupported() const { return _fullTextSearchSupported; }
+
     private:
         Db(const Db&) = delete;
         Db& operator=(const Db&) = delete;
@@ -35,6 +37,7 @@ namespace lms::db
         void logPageSize();
         void logCacheSize();
         void logCompileOptions();
+        void detectFullTextSearchSupport();
         void performQuickCheck();
         void performIntegrityCheck();
         void performForeignKeyConstraintsCheck();
@@ -58,6 +61,7 @@ namespace lms::db
 
         core::RecursiveSharedMutex _sharedMutex;
         std::unique_ptr<Wt::Dbo::SqlConnectionPool> _connectionPool;
+        bool _fullTextSearchSupported{};
 
         std::mutex _tlsSessionsMutex;
         std::vector<std::unique_ptr<Session>> _tlsSessions;
@@ -0,0 +1,141 @@
+// 收听统计汇总表维护实现
+
+#include "ListenStats.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include "core/ILogger.hpp"
+#include "database/Session.hpp"
+
+#include "Utils.hpp"
+
+namespace lms::db::listenStats
+{
+    namespace
+    {
+        struct Rollup
+        {
+            std::string_view table;
+            std::size_t bucketLength; // prefix of the ISO 8601 date time
+        };
+
+        constexpr std::array<Rollup, 2> rollups{
+            Rollup{ .table = "listen_stats", .bucketLength = 7 },        // "YYYY-MM"
+            Rollup{ .table = "listen_stats_daily", .bucketLength = 10 }, // "YYYY-MM-DD"
+        };
+
+        // insert, delete and update
+        constexpr std::array<std::string_view, 3> triggerNames{ "listen_stats_ai", "listen_stats_ad", "listen_stats_au" };
+
+        std::string getBucket(const Rollup& rollup, std::string_view row)
+        {
+            return "substr(" + std::string{ row } + ".date_time, 1, " + std::to_string(rollup.bucketLength) + ")";
+        }
+
+        std::string createAddListenStatement(const Rollup& rollup, std::string_view row)
+        {
+            const std::string r{ row };
+            const std::string table{ rollup.table };
+
+            std::string statement{ "INSERT INTO " + table + "(user_id, backend, track_id, bucket, listen_count, last_date_time)" };
+            statement += " SELECT " + r + ".user_id, " + r + ".backend, " + r + ".track_id, " + getBucket(rollup, row) + ", 1, " + r + ".date_time";
+            statement += " WHERE " + r + ".user_id IS NOT NULL AND " + r + ".track_id IS NOT NULL AND " + r + ".date_time IS NOT NULL";
+            statement += " ON CONFLICT(user_id, backend, track_id, bucket) DO UPDATE SET listen_count = listen_count + 1, last_date_time = MAX(last_date_time, excluded.last_date_time);";
+
+            return statement;
+        }
+
+        std::string createRemoveListenStatement(const Rollup& rollup, std::string_view row)
+        {
+            const std::string r{ row };
+            const std::string table{ rollup.table };
+            const std::string whereClause{ " WHERE user_id = " + r + ".user_id AND backend = " + r + ".backend AND track_id = " + r + ".track_id AND bucket = " + getBucket(rollup, row) };
+
+            // the last listen of the bucket may have been removed
+            std::string statement{ "UPDATE " + table + " SET listen_count = listen_count - 1" };
+            statement += ", last_date_time = IFNULL((SELECT MAX(l.date_time) FROM listen l WHERE l.user_id = " + r + ".user_id AND l.backend = " + r + ".backend AND l.track_id = " + r + ".track_id AND " + getBucket(rollup, "l") + " = " + table + ".bucket), last_date_time)";
+            statement += whereClause + ";";
+            statement += " DELETE FROM " + table + whereClause + " AND listen_count <= 0;";
+
+            return statement;
+        }
+
+        std::string createAddListenStatements(std::string_view row)
+        {
+            std::string statements;
+            for (const Rollup& rollup : rollups)
+                statements += createAddListenStatement(rollup, row) + " ";
+
+            return statements;
+        }
+
+        std::string createRemoveListenStatements(std::string_view row)
+        {
+            std::string statements;
+            for (const Rollup& rollup : rollups)
+                statements += createRemoveListenStatement(rollup, row) + " ";
+
+            return statements;
+        }
+
+        // The rollups may be out of sync if any of them or any trigger is missing (dropped along with the listen table during a migration)
+        bool isComplete(Session& session)
+        {
+            auto query{ session.getDboSession()->query<int>("SELECT COUNT(*) FROM sqlite_master") };
+            query.where("name IN (?, ?, ?, ?, ?)");
+            for (const Rollup& rollup : rollups)
+                query.bind(rollup.table);
+            for (std::string_view triggerName : triggerNames)
+                query.bind(triggerName);
+
+            return static_cast<std::size_t>(utils::fetchQuerySingleResult(query)) == rollups.size() + triggerNames.size();
+        }
+
+        void create(Session& session)
+        {
+            for (std::string_view triggerName : triggerNames)
+                utils::executeCommand(*session.getDboSession(), "DROP TRIGGER IF EXISTS " + std::string{ triggerName });
+
+            for (const Rollup& rollup : rollups)
+            {
+                const std::string table{ rollup.table };
+
+                utils::executeCommand(*session.getDboSession(), "DROP TABLE IF EXISTS " + table);
+                utils::executeCommand(*session.getDboSession(), "CREATE TABLE " + table + " ("
+                                                                " user_id bigint NOT NULL,"
+                                                                " backend integer NOT NULL,"
+                                                                " track_id bigint NOT NULL,"
+                                                                " bucket text NOT NULL,"
+                                                                " listen_count integer NOT NULL,"
+                                                                " last_date_time text NOT NULL,"
+                                                                " PRIMARY KEY (user_id, backend, track_id, bucket)) WITHOUT ROWID");
+
+                // backfill
+                std::string backfill{ "INSERT INTO " + table + "(user_id, backend, track_id, bucket, listen_count, last_date_time)" };
+                backfill += " SELECT l.user_id, l.backend, l.track_id, " + getBucket(rollup, "l") + ", COUNT(*), MAX(l.date_time) FROM listen l";
+                backfill += " WHERE l.user_id IS NOT NULL AND l.track_id IS NOT NULL AND l.date_time IS NOT NULL";
+                backfill += " GROUP BY l.user_id, l.backend, l.track_id, " + getBucket(rollup, "l");
+                utils::executeCommand(*session.getDboSession(), backfill);
+            }
+
+            // no foreign keys: rows go away along with their listens, including the ones removed by cascade
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER listen_stats_ai AFTER INSERT ON listen BEGIN " + createAddListenStatements("new") + "END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER listen_stats_ad AFTER DELETE ON listen BEGIN " + createRemoveListenStatements("old") + "END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER listen_stats_au AFTER UPDATE OF user_id, backend, track_id, date_time ON listen BEGIN " + createRemoveListenStatements("old") + createAddListenStatements("new") + "END");
+        }
+    } // namespace
+
+    void createIfNeeded(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        if (isComplete(session))
+            return;
+
+        LMS_LOG(DB, INFO, "Creating listen stats...");
+        create(session);
+        LMS_LOG(DB, INFO, "Listen stats created!");
+    }
+} // namespace lms::db::listenStats
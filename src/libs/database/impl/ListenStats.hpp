@@ -0,0 +1,18 @@
+// 收听统计汇总表维护声明
+
+#pragma once
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::db::listenStats
+{
+    // Rollups of the listens: one row per user, backend, track and month (resp. day), with the listen count and the last listen date time
+    // They are kept up to date using triggers on the listen table, so that any write (recorded or synchronized listens, removals) is reflected
+    // Tables: "listen_stats" (month buckets), "listen_stats_daily" (day buckets)
+
+    // Creates (and fills) the rollup table if it is missing or may be out of sync
+    void createIfNeeded(Session& session);
+} // namespace lms::db::listenStats
@@ -11,13 +11,16 @@
 #include "database/objects/ScanSettings.hpp"
 
 #include "Db.hpp"
+#include "ClusterStats.hpp"
+#include "ListenStats.hpp"
+#include "SearchIndex.hpp"
 #include "Utils.hpp"
 
 namespace lms::db
 {
     namespace
     {
-        static constexpr Version LMS_DATABASE_VERSION{ 100 };
+        static constexpr Version LMS_DATABASE_VERSION{ 104 };
     }
 
     VersionInfo::VersionInfo()
@@ -1564,6 +1567,30 @@ FROM track)");
   constraint "fk_podcast_episode_podcast" foreign key ("podcast_id") references "podcast" ("id") on delete cascade deferrable initially deferred))");
     }
 
+    void migrateFromV100(Session& session)
+    {
+        // Full-text search indexes for artist, release and track names (filled from the existing entries)
+        searchIndex::createIfNeeded(session);
+    }
+
+    void migrateFromV101(Session& session)
+    {
+        // Listen stats rollup (filled from the existing listens)
+        listenStats::createIfNeeded(session);
+    }
+
+    void migrateFromV102(Session& session)
+    {
+        // Persistent dirty flags for the cluster stats (all the clusters are recomputed once)
+        clusterStats::createIfNeeded(session);
+    }
+
+    void migrateFromV103(Session& session)
+    {
+        // Day buckets for the listen stats rollup (the whole rollup is rebuilt from the existing listens)
+        listenStats::createIfNeeded(session);
+    }
+
     bool doDbMigration(Session& session)
     {
         constexpr std::string_view outdatedMsg{ "Outdated database, please rebuild it (delete the .db file and restart)" };
@@ -1640,6 +1667,10 @@ FROM track)");
             { 97, migrateFromV97 },
             { 98, migrateFromV98 },
             { 99, migrateFromV99 },
+            { 100, migrateFromV100 },
+            { 101, migrateFromV101 },
+            { 102, migrateFromV102 },
+            { 103, migrateFromV103 },
         };
 
         bool migrationPerformed{};
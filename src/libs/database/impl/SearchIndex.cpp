@@ -0,0 +1,183 @@
+// 全文搜索索引（FTS5）维护与查询实现
+
+#include "SearchIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <array>
+
+#include "core/ILogger.hpp"
+#include "core/String.hpp"
+#include "database/Session.hpp"
+
+#include "Db.hpp"
+#include "Utils.hpp"
+
+namespace lms::db::searchIndex
+{
+    namespace
+    {
+        struct IndexedTable
+        {
+            std::string_view name;
+            std::vector<std::string_view> columns;
+        };
+
+        const std::array<IndexedTable, 3>& getIndexedTables()
+        {
+            static const std::array<IndexedTable, 3> indexedTables{ {
+                { "artist", { "name", "sort_name" } },
+                { "release", { "name", "sort_name" } },
+                { "track", { "name" } },
+            } };
+
+            return indexedTables;
+        }
+
+        // insert, delete and update
+        constexpr std::array<std::string_view, 3> triggerSuffixes{ "ai", "ad", "au" };
+
+        // the trigram tokenizer cannot look up shorter keywords
+        constexpr std::size_t minKeywordCharCount{ 3 };
+
+        bool isFullTextSearchSupported(Session& session)
+        {
+            return static_cast<Db&>(session.getDb()).isFullTextSearchSupported();
+        }
+
+        std::string getFtsTableName(std::string_view table)
+        {
+            return std::string{ table } + "_fts";
+        }
+
+        std::string getTriggerName(std::string_view table, std::string_view suffix)
+        {
+            return getFtsTableName(table) + "_" + std::string{ suffix };
+        }
+
+        std::string joinColumns(std::span<const std::string_view> columns, std::string_view prefix)
+        {
+            std::string res;
+            for (std::string_view column : columns)
+            {
+                if (!res.empty())
+                    res += ", ";
+                res += prefix;
+                res += column;
+            }
+
+            return res;
+        }
+
+        std::size_t getCharCount(std::string_view utf8Str)
+        {
+            return std::count_if(std::cbegin(utf8Str), std::cend(utf8Str), [](char c) { return (static_cast<unsigned char>(c) & 0xC0) != 0x80; });
+        }
+
+        // The index may be out of sync if any trigger is missing (dropped along with its table during a migration, or by a run without FTS5 support)
+        bool isIndexComplete(Session& session, std::string_view table)
+        {
+            auto query{ session.getDboSession()->query<int>("SELECT COUNT(*) FROM sqlite_master") };
+            query.where("name IN (?, ?, ?, ?)").bind(getFtsTableName(table));
+            for (std::string_view suffix : triggerSuffixes)
+                query.bind(getTriggerName(table, suffix));
+
+            return static_cast<std::size_t>(utils::fetchQuerySingleResult(query)) == 1 + triggerSuffixes.size();
+        }
+
+        void dropTriggers(Session& session, std::string_view table)
+        {
+            for (std::string_view suffix : triggerSuffixes)
+                utils::executeCommand(*session.getDboSession(), "DROP TRIGGER IF EXISTS " + getTriggerName(table, suffix));
+        }
+
+        void createIndex(Session& session, const IndexedTable& table)
+        {
+            const std::string ftsTable{ getFtsTableName(table.name) };
+            const std::string columns{ joinColumns(table.columns, "") };
+            const std::string newValues{ "new.id, " + joinColumns(table.columns, "new.") };
+            const std::string oldValues{ "'delete', old.id, " + joinColumns(table.columns, "old.") };
+
+            dropTriggers(session, table.name);
+            utils::executeCommand(*session.getDboSession(), "DROP TABLE IF EXISTS " + ftsTable);
+
+            // External content table: only the index is stored
+            utils::executeCommand(*session.getDboSession(), "CREATE VIRTUAL TABLE " + ftsTable + " USING fts5(" + columns + ", content='" + std::string{ table.name } + "', content_rowid='id', tokenize='trigram')");
+
+            const std::string insertNewEntry{ "INSERT INTO " + ftsTable + "(rowid, " + columns + ") VALUES (" + newValues + ");" };
+            const std::string deleteOldEntry{ "INSERT INTO " + ftsTable + "(" + ftsTable + ", rowid, " + columns + ") VALUES (" + oldValues + ");" };
+
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER " + getTriggerName(table.name, "ai") + " AFTER INSERT ON " + std::string{ table.name } + " BEGIN " + insertNewEntry + " END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER " + getTriggerName(table.name, "ad") + " AFTER DELETE ON " + std::string{ table.name } + " BEGIN " + deleteOldEntry + " END");
+            utils::executeCommand(*session.getDboSession(), "CREATE TRIGGER " + getTriggerName(table.name, "au") + " AFTER UPDATE OF " + columns + " ON " + std::string{ table.name } + " BEGIN " + deleteOldEntry + " " + insertNewEntry + " END");
+
+            utils::executeCommand(*session.getDboSession(), "INSERT INTO " + ftsTable + "(" + ftsTable + ") VALUES ('rebuild')");
+        }
+    } // namespace
+
+    void createIfNeeded(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        const bool fullTextSearchSupported{ isFullTextSearchSupported(session) };
+        if (!fullTextSearchSupported)
+            LMS_LOG(DB, WARNING, "FTS5 not supported by Sqlite3, searches will be slower");
+
+        for (const IndexedTable& table : getIndexedTables())
+        {
+            if (!fullTextSearchSupported)
+            {
+                // Triggers would make any write on the table fail
+                dropTriggers(session, table.name);
+                continue;
+            }
+
+            if (isIndexComplete(session, table.name))
+                continue;
+
+            LMS_LOG(DB, INFO, "Creating full-text search index for '" << table.name << "'...");
+            createIndex(session, table);
+            LMS_LOG(DB, INFO, "Full-text search index for '" << table.name << "' created!");
+        }
+    }
+
+    std::string createMatchExpression(Session& session, std::span<const std::string_view> columns, std::span<const std::string_view> keywords, std::vector<std::string_view>& remainingKeywords)
+    {
+        assert(!columns.empty());
+
+        const bool fullTextSearchSupported{ isFullTextSearchSupported(session) };
+
+        std::string keywordsExpression;
+        for (std::string_view keyword : keywords)
+        {
+            if (!fullTextSearchSupported || getCharCount(keyword) < minKeywordCharCount)
+            {
+                remainingKeywords.push_back(keyword);
+                continue;
+            }
+
+            if (!keywordsExpression.empty())
+                keywordsExpression += " AND ";
+
+            // quoted: keywords are matched as substrings, whatever the chars they contain
+            keywordsExpression += '"';
+            keywordsExpression += core::stringUtils::escapeString(keyword, "\"", '"');
+            keywordsExpression += '"';
+        }
+
+        if (keywordsExpression.empty())
+            return keywordsExpression;
+
+        // "{name} : (...) OR {sort_name} : (...)"
+        std::string matchExpression;
+        for (std::string_view column : columns)
+        {
+            if (!matchExpression.empty())
+                matchExpression += " OR ";
+
+            matchExpression += "{" + std::string{ column } + "} : (" + keywordsExpression + ")";
+        }
+
+        return matchExpression;
+    }
+} // namespace lms::db::searchIndex
@@ -0,0 +1,44 @@
+// 全文搜索索引（FTS5）维护与查询声明
+
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::db::searchIndex
+{
+    // Full-text indexes (FTS5, trigram tokenizer) on the names of the artists, releases and tracks
+    // They are kept up to date using triggers, so that any write (mostly the scanner) is reflected
+    // Tables: "<table>_fts", rowid is the id of the indexed object
+
+    // Creates (and fills) the indexes that are missing or that may be out of sync
+    void createIfNeeded(Session& session);
+
+    // Match expression for the keywords that can be looked up in the index
+    // All of them must match within a single column, any of the given ones (matching "a b" with "a" in name and "b" in sort_name is not wanted)
+    // The other ones (index not available, or too short keywords) must be handled by the caller using LIKE clauses
+    std::string createMatchExpression(Session& session, std::span<const std::string_view> columns, std::span<const std::string_view> keywords, std::vector<std::string_view>& remainingKeywords);
+
+    // Restricts the query to the rows of 'table' (aliased as 'alias') that match the keywords, in one of the given columns
+    // Returns true if the index is joined: "<table>_fts.rank" can then be used to sort by relevance
+    template<typename Query>
+    bool joinMatchingRows(Session& session, Query& query, std::string_view table, std::string_view alias, std::span<const std::string_view> columns, std::span<const std::string_view> keywords, std::vector<std::string_view>& remainingKeywords)
+    {
+        const std::string matchExpression{ createMatchExpression(session, columns, keywords, remainingKeywords) };
+        if (matchExpression.empty())
+            return false;
+
+        const std::string ftsTable{ std::string{ table } + "_fts" };
+        query.join(ftsTable + " ON " + ftsTable + ".rowid = " + std::string{ alias } + ".id");
+        query.where(ftsTable + " MATCH ?").bind(matchExpression);
+
+        return true;
+    }
+} // namespace lms::db::searchIndex
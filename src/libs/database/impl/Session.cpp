@@ -40,8 +40,11 @@
 #include "database/objects/UIState.hpp"
 #include "database/objects/User.hpp"
 
+#include "ClusterStats.hpp"
 #include "Db.hpp"
+#include "ListenStats.hpp"
 #include "Migration.hpp"
+#include "SearchIndex.hpp"
 #include "TransactionChecker.hpp"
 #include "Utils.hpp"
 #include "traits/EnumSetTraits.hpp"
@@ -297,6 +300,10 @@ namespace lms::db
 
             utils::executeCommand(_session, "CREATE INDEX IF NOT EXISTS starred_track_user_backend_idx ON starred_track(user_id,backend)");
             utils::executeCommand(_session, "CREATE INDEX IF NOT EXISTS starred_track_track_user_backend_idx ON starred_track(track_id,user_id,backend)");
+
+            searchIndex::createIfNeeded(*this);
+            listenStats::createIfNeeded(*this);
+            clusterStats::createIfNeeded(*this);
         }
 
         LMS_LOG(DB, INFO, "Indexes created!");
@@ -351,7 +358,7 @@ namespace lms::db
     {
         checkReadTransaction();
 
-        const std::vector<std::string> entryList{ utils::fetchQueryResults(_session.query<std::string>("SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%'")) };
+        const std::vector<std::string> entryList{ utils::fetchQueryResults(_session.query<std::string>("SELECT name FROM sqlite_master WHERE type='table' AND name NOT LIKE 'sqlite_%' AND name NOT LIKE '%\\_fts%' ESCAPE '\\'")) };
 
         return std::all_of(entryList.cbegin(), entryList.cend(), [this](const std::string& entry) {
             const auto count{ utils::fetchQuerySingleResult(_session.query<long>("SELECT COUNT(*) FROM " + entry)) };
@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <cassert>
+#include <span>
+#include <sstream>
 #include <string>
 #include <string_view>
 
@@ -33,6 +36,24 @@ namespace lms::db::utils
             if (IQueryPlanRecorder * recorder{ core::Service<IQueryPlanRecorder>::get() })
                 static_cast<QueryPlanRecorder*>(recorder)->recordQueryPlanIfNeeded(query.session(), query.asString());
         }
+
+        // "<column> IN (?, ?, ...)"
+        inline std::string getInCondition(std::string_view column, std::size_t valueCount)
+        {
+            assert(valueCount > 0);
+
+            std::ostringstream oss;
+            oss << column << " IN (";
+            for (std::size_t i{}; i < valueCount; ++i)
+            {
+                if (i != 0)
+                    oss << ", ";
+                oss << "?";
+            }
+            oss << ")";
+
+            return oss.str();
+        }
     } // namespace details
 
     template<typename Query>
@@ -46,6 +67,34 @@ namespace lms::db::utils
         }
     }
 
+    // Adds a "<column> IN (?, ?, ...)" condition and binds the given values
+    template<typename Query, typename T>
+    void whereIn(Query& query, std::string_view column, std::span<const T> values)
+    {
+        query.where(details::getInCondition(column, values.size()));
+        for (const T& value : values)
+            query.bind(value);
+    }
+
+    // Keyset pagination: only keeps the rows sorted after the given cursor
+    // The query must be sorted using "<alias>.<sortColumn> COLLATE NOCASE, <alias>.id", or just "<alias>.id" if sortColumn is empty
+    template<typename Query, typename IdType>
+    void whereSortedAfter(Query& query, std::string_view alias, std::string_view sortColumn, const KeysetCursor<IdType>& after)
+    {
+        const std::string idColumn{ std::string{ alias } + ".id" };
+        if (sortColumn.empty())
+        {
+            query.where(idColumn + " > ?").bind(after.id);
+            return;
+        }
+
+        const std::string column{ std::string{ alias } + "." + std::string{ sortColumn } + " COLLATE NOCASE" };
+
+        // The first condition is redundant, but it lets the query planner seek in the sort column index
+        query.where(column + " >= ?").bind(after.sortKey);
+        query.where("(" + column + ", " + idColumn + ") > (?, ?)").bind(after.sortKey).bind(after.id);
+    }
+
     template<typename T>
     auto fetchFirstResult(const Wt::Dbo::collection<T>& collection)
     {
@@ -193,4 +242,20 @@ namespace lms::db::utils
             call.run();
         }
     }
+
+    // Executes "<command> WHERE <column> IN (?, ?, ...)", binding the given values
+    template<typename T>
+    void executeCommandWhereIn(Wt::Dbo::Session& session, std::string_view command, std::string_view column, std::span<const T> values)
+    {
+        const std::string commandWithCondition{ std::string{ command } + " WHERE " + details::getInCondition(column, values.size()) };
+
+        Wt::Dbo::Call call{ session.execute(commandWithCondition) };
+        for (const T& value : values)
+            call.bind(value);
+
+        {
+            LMS_SCOPED_TRACE_DETAILED_WITH_ARG("Database", "ExecuteCommand", "Command", command);
+            call.run();
+        }
+    }
 } // namespace lms::db::utils
\ No newline at end of file
@@ -1,6 +1,8 @@
 // 艺人实体的数据库持久化实现
 #include "database/objects/Artist.hpp"
 
+#include <array>
+
 #include <Wt/Dbo/Impl.h>
 #include <Wt/Dbo/WtSqlTraits.h>
 
@@ -15,6 +17,7 @@
 #include "database/objects/TrackArtistLink.hpp"
 #include "database/objects/User.hpp"
 
+#include "SearchIndex.hpp"
 #include "SqlQuery.hpp"
 #include "Utils.hpp"
 #include "traits/IdTypeTraits.hpp"
@@ -26,6 +29,29 @@ namespace lms::db
 {
     namespace
     {
+        // Column used to resume the iteration (empty if sorted by id)
+        std::string_view getKeysetSortColumn(ArtistSortMethod sortMethod)
+        {
+            switch (sortMethod)
+            {
+            case ArtistSortMethod::Id:
+                return "";
+            case ArtistSortMethod::Name:
+                return "name";
+            case ArtistSortMethod::SortName:
+                return "sort_name";
+            case ArtistSortMethod::None:
+            case ArtistSortMethod::Random:
+            case ArtistSortMethod::LastWrittenDesc:
+            case ArtistSortMethod::AddedDesc:
+            case ArtistSortMethod::StarredDateDesc:
+            case ArtistSortMethod::Relevance:
+                break;
+            }
+
+            throw Exception{ "Keyset pagination not supported for this artist sort method" };
+        }
+
         template<typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Artist::FindParameters& params)
         {
@@ -81,8 +107,12 @@ namespace lms::db
             if (params.linkType)
                 query.where("+t_a_l.type = ?").bind(*params.linkType); // Exclude this since the query planner does not do a good job when db is not analyzed
 
-            if (!params.keywords.empty())
+            // All the keywords must match the name, or all of them must match the sort name
+            std::vector<std::string_view> likeKeywords;
+            const bool matchesSearchIndex{ searchIndex::joinMatchingRows(session, query, "artist", "a", std::array<std::string_view, 2>{ "name", "sort_name" }, params.keywords, likeKeywords) };
+            if (!likeKeywords.empty())
             {
+                // All the keywords are checked again here, so that the indexed ones match the same column as the other ones
                 std::vector<std::string> clauses;
                 std::vector<std::string> sortClauses;
 
@@ -141,6 +171,9 @@ namespace lms::db
             if (params.track.isValid())
                 query.where("t_a_l.track_id = ?").bind(params.track);
 
+            if (params.after)
+                utils::whereSortedAfter(query, "a", getKeysetSortColumn(params.sortMethod), *params.after);
+
             switch (params.sortMethod)
             {
             case ArtistSortMethod::None:
@@ -149,10 +182,10 @@ namespace lms::db
                 query.orderBy("a.id");
                 break;
             case ArtistSortMethod::Name:
-                query.orderBy("a.name COLLATE NOCASE");
+                query.orderBy("a.name COLLATE NOCASE, a.id");
                 break;
             case ArtistSortMethod::SortName:
-                query.orderBy("a.sort_name COLLATE NOCASE");
+                query.orderBy("a.sort_name COLLATE NOCASE, a.id");
                 break;
             case ArtistSortMethod::Random:
                 query.orderBy("RANDOM()");
@@ -167,6 +200,9 @@ namespace lms::db
                 assert(params.starringUser.isValid());
                 query.orderBy("s_a.date_time DESC");
                 break;
+            case ArtistSortMethod::Relevance:
+                query.orderBy(matchesSearchIndex ? "artist_fts.rank, a.id" : "a.id");
+                break;
             }
 
             query.groupBy("a.id");
@@ -311,6 +347,25 @@ AND NOT EXISTS (
         return utils::execRangeQuery<ArtistId>(query, range);
     }
 
+    void Artist::findReleaseCounts(Session& session, std::span<const ArtistId> artistIds, const std::function<void(ArtistId artistId, std::size_t releaseCount)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (artistIds.empty())
+            return;
+
+        using ResultType = std::tuple<ArtistId, int>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t_a_l.artist_id, COUNT(DISTINCT t.release_id) FROM track_artist_link t_a_l") };
+        query.join("track t ON t.id = t_a_l.track_id");
+        utils::whereIn(query, "t_a_l.artist_id", artistIds);
+        query.groupBy("t_a_l.artist_id");
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<ArtistId>(result), static_cast<std::size_t>(std::get<int>(result)));
+        });
+    }
+
     bool Artist::exists(Session& session, ArtistId id)
     {
         session.checkReadTransaction();
@@ -87,6 +87,28 @@ namespace lms::db
         return utils::fetchQuerySingleResult(query);
     }
 
+    void Artwork::findLastWrittenTimes(Session& session, std::span<const ArtworkId> artworkIds, const std::function<void(ArtworkId artworkId, const Wt::WDateTime& lastWrittenTime)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (artworkIds.empty())
+            return;
+
+        using ResultType = std::tuple<ArtworkId, Wt::WDateTime>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT artwork.id, MAX(COALESCE(image.file_last_write, track.file_last_write)) AS last_written_datetime FROM artwork") };
+        query.leftJoin("image ON artwork.image_id = image.id");
+        query.leftJoin("track_embedded_image ON artwork.track_embedded_image_id = track_embedded_image.id");
+        query.leftJoin("track_embedded_image_link ON track_embedded_image.id = track_embedded_image_link.track_embedded_image_id");
+        query.leftJoin("track ON track.id = track_embedded_image_link.track_id");
+        utils::whereIn(query, "artwork.id", artworkIds);
+        query.groupBy("artwork.id");
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<ArtworkId>(result), std::get<Wt::WDateTime>(result));
+        });
+    }
+
     std::filesystem::path Artwork::getAbsoluteFilePath() const
     {
         auto query{ session()->query<std::filesystem::path>("SELECT COALESCE(image.absolute_file_path, track.absolute_file_path) AS absolute_file_path FROM artwork") };
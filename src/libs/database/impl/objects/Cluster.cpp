@@ -147,6 +147,27 @@ namespace lms::db
         return utils::fetchQuerySingleResult(session.getDboSession()->find<Cluster>().where("id = ?").bind(id));
     }
 
+    void Cluster::find(Session& session, std::span<const TrackId> trackIds, std::string_view clusterTypeName, const std::function<void(TrackId trackId, const pointer& cluster)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (trackIds.empty())
+            return;
+
+        using ResultType = std::tuple<TrackId, Wt::Dbo::ptr<Cluster>>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t_c.track_id, c FROM cluster c") };
+        query.join("track_cluster t_c ON t_c.cluster_id = c.id");
+        query.join("cluster_type c_t ON c_t.id = c.cluster_type_id");
+        query.where("c_t.name = ?").bind(clusterTypeName);
+        utils::whereIn(query, "t_c.track_id", trackIds);
+        query.orderBy("c.id");
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<TrackId>(result), std::get<Wt::Dbo::ptr<Cluster>>(result));
+        });
+    }
+
     std::size_t Cluster::computeTrackCount(Session& session, ClusterId id)
     {
         session.checkReadTransaction();
@@ -161,6 +182,55 @@ namespace lms::db
         return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(DISTINCT t.release_id) FROM track t INNER JOIN track_cluster t_c ON t_c.track_id = t.id").where("t_c.cluster_id = ?").bind(id));
     }
 
+    void Cluster::computeStats(Session& session, std::span<const ClusterId> clusterIds, const std::function<void(const pointer& cluster, std::size_t trackCount, std::size_t releaseCount)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (clusterIds.empty())
+            return;
+
+        // left joins: clusters no longer used by any track are reported too
+        auto query{ session.getDboSession()->query<std::tuple<Wt::Dbo::ptr<Cluster>, int, int>>("SELECT c, COUNT(t.id), COUNT(DISTINCT t.release_id) FROM cluster c LEFT JOIN track_cluster t_c ON t_c.cluster_id = c.id LEFT JOIN track t ON t.id = t_c.track_id") };
+        utils::whereIn(query, "c.id", clusterIds);
+        query.groupBy("c.id");
+
+        utils::forEachQueryResult(query, [&](const auto& res) {
+            func(std::get<0>(res), std::get<1>(res), std::get<2>(res));
+        });
+    }
+
+    std::size_t Cluster::getStatsDirtyCount(Session& session)
+    {
+        session.checkReadTransaction();
+
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) FROM cluster_stats_dirty"));
+    }
+
+    std::vector<ClusterId> Cluster::findStatsDirtyIds(Session& session, std::size_t maxCount)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<ClusterId>("SELECT cluster_id FROM cluster_stats_dirty").orderBy("cluster_id").limit(static_cast<int>(maxCount)) };
+        return utils::fetchQueryResults(query);
+    }
+
+    void Cluster::markAllStatsDirty(Session& session)
+    {
+        session.checkWriteTransaction();
+
+        utils::executeCommand(*session.getDboSession(), "INSERT OR IGNORE INTO cluster_stats_dirty(cluster_id) SELECT id FROM cluster");
+    }
+
+    void Cluster::clearStatsDirty(Session& session, std::span<const ClusterId> clusterIds)
+    {
+        session.checkWriteTransaction();
+
+        if (clusterIds.empty())
+            return;
+
+        utils::executeCommandWhereIn(*session.getDboSession(), "DELETE FROM cluster_stats_dirty", "cluster_id", clusterIds);
+    }
+
     void Cluster::addTrack(ObjectPtr<Track> track)
     {
         _tracks.insert(getDboPtr(track));
@@ -21,13 +21,13 @@ namespace lms::db
     {
         Wt::Dbo::Query<ArtistId> createArtistsQuery(Session& session, const Listen::ArtistStatsFindParameters& params)
         {
-            auto query{ session.getDboSession()->query<ArtistId>("SELECT a.id from artist a").join("track_artist_link t_a_l ON t_a_l.artist_id = a.id").join("listen l ON l.track_id = t_a_l.track_id") };
+            auto query{ session.getDboSession()->query<ArtistId>("SELECT a.id from artist a").join("track_artist_link t_a_l ON t_a_l.artist_id = a.id").join("listen_stats l_s ON l_s.track_id = t_a_l.track_id") };
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             assert(!params.artist.isValid()); // poor check
 
@@ -100,13 +100,13 @@ namespace lms::db
 
         Wt::Dbo::Query<ReleaseId> createReleasesQuery(Session& session, const Listen::StatsFindParameters& params)
         {
-            auto query{ session.getDboSession()->query<ReleaseId>("SELECT r.id from release r").join("track t ON t.release_id = r.id").join("listen l ON l.track_id = t.id") };
+            auto query{ session.getDboSession()->query<ReleaseId>("SELECT r.id from release r").join("track t ON t.release_id = r.id").join("listen_stats l_s ON l_s.track_id = t.id") };
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             if (params.artist.isValid())
             {
@@ -159,13 +159,13 @@ namespace lms::db
 
         Wt::Dbo::Query<TrackId> createTracksQuery(Session& session, const Listen::StatsFindParameters& params)
         {
-            auto query{ session.getDboSession()->query<TrackId>("SELECT t.id from track t").join("listen l ON l.track_id = t.id") };
+            auto query{ session.getDboSession()->query<TrackId>("SELECT t.id from track t").join("listen_stats l_s ON l_s.track_id = t.id") };
 
             if (params.user.isValid())
-                query.where("l.user_id = ?").bind(params.user);
+                query.where("l_s.user_id = ?").bind(params.user);
 
             if (params.backend)
-                query.where("l.backend = ?").bind(*params.backend);
+                query.where("l_s.backend = ?").bind(*params.backend);
 
             if (params.artist.isValid())
             {
@@ -273,7 +273,7 @@ namespace lms::db
         auto query{ createArtistsQuery(session, params) };
 
         auto collection{ query
-                             .orderBy("COUNT(a.id) DESC")
+                             .orderBy("SUM(l_s.listen_count) DESC")
                              .groupBy("a.id") };
 
         return utils::execRangeQuery<ArtistId>(query, params.range);
@@ -283,7 +283,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createReleasesQuery(session, params)
-                        .orderBy("COUNT(r.id) DESC")
+                        .orderBy("SUM(l_s.listen_count) DESC")
                         .groupBy("r.id") };
 
         return utils::execRangeQuery<ReleaseId>(query, params.range);
@@ -293,7 +293,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
         auto query{ createTracksQuery(session, params)
-                        .orderBy("COUNT(t.id) DESC")
+                        .orderBy("SUM(l_s.listen_count) DESC")
                         .groupBy("t.id") };
 
         return utils::execRangeQuery<TrackId>(query, params.range);
@@ -304,8 +304,7 @@ namespace lms::db
         session.checkReadTransaction();
         auto query{ createArtistsQuery(session, params)
                         .groupBy("a.id")
-                        .having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .orderBy("MAX(l_s.last_date_time) DESC") };
 
         return utils::execRangeQuery<ArtistId>(query, params.range);
     }
@@ -315,8 +314,7 @@ namespace lms::db
         session.checkReadTransaction();
         auto query{ createReleasesQuery(session, params)
                         .groupBy("r.id")
-                        .having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .orderBy("MAX(l_s.last_date_time) DESC") };
 
         return utils::execRangeQuery<ReleaseId>(query, params.range);
     }
@@ -326,8 +324,7 @@ namespace lms::db
         session.checkReadTransaction();
         auto query{ createTracksQuery(session, params)
                         .groupBy("t.id")
-                        .having("l.date_time = MAX(l.date_time)")
-                        .orderBy("l.date_time DESC") };
+                        .orderBy("MAX(l_s.last_date_time) DESC") };
 
         return utils::execRangeQuery<TrackId>(query, params.range);
     }
@@ -336,7 +333,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
-        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT COUNT(*) from listen l").join("user u ON u.id = l.user_id").where("l.track_id = ?").bind(trackId).where("l.user_id = ?").bind(userId).where("l.backend = u.scrobbling_backend"));
+        return utils::fetchQuerySingleResult(session.getDboSession()->query<int>("SELECT IFNULL(SUM(l_s.listen_count), 0) from listen_stats l_s").join("user u ON u.id = l_s.user_id").where("l_s.track_id = ?").bind(trackId).where("l_s.user_id = ?").bind(userId).where("l_s.backend = u.scrobbling_backend"));
     }
 
     std::size_t Listen::getCount(Session& session, UserId userId, ReleaseId releaseId)
@@ -346,9 +343,9 @@ namespace lms::db
         return utils::fetchQuerySingleResult(session.getDboSession()->query<int>(
                                                                         "SELECT IFNULL(MIN(count_result), 0)"
                                                                         " FROM ("
-                                                                        " SELECT COUNT(l.track_id) AS count_result"
+                                                                        " SELECT IFNULL(SUM(l_s.listen_count), 0) AS count_result"
                                                                         " FROM track t"
-                                                                        " LEFT JOIN listen l ON t.id = l.track_id AND l.backend = (SELECT scrobbling_backend FROM user WHERE id = ?) AND l.user_id = ?"
+                                                                        " LEFT JOIN listen_stats l_s ON t.id = l_s.track_id AND l_s.backend = (SELECT scrobbling_backend FROM user WHERE id = ?) AND l_s.user_id = ?"
                                                                         " WHERE t.release_id = ?"
                                                                         " GROUP BY t.id)")
                                                  .bind(userId)
@@ -57,6 +57,17 @@ namespace lms::db
         utils::forEachQueryRangeResult(query, params.range, func);
     }
 
+    void RatedArtist::find(Session& session, UserId userId, const std::function<void(ArtistId artistId, Rating rating)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<std::tuple<ArtistId, Rating>>("SELECT r_a.artist_id, r_a.rating FROM rated_artist r_a").where("r_a.user_id = ?").bind(userId) };
+
+        utils::forEachQueryResult(query, [&](const auto& res) {
+            func(std::get<0>(res), std::get<1>(res));
+        });
+    }
+
     void RatedArtist::setLastUpdated(const Wt::WDateTime& lastUpdated)
     {
         _lastUpdated = utils::normalizeDateTime(lastUpdated);
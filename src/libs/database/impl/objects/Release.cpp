@@ -2,6 +2,8 @@
 
 #include "database/objects/Release.hpp"
 
+#include <array>
+
 #include <Wt/Dbo/Impl.h>
 #include <Wt/Dbo/WtSqlTraits.h>
 
@@ -21,6 +23,7 @@
 #include "database/objects/TrackLyrics.hpp"
 #include "database/objects/User.hpp"
 
+#include "SearchIndex.hpp"
 #include "SqlQuery.hpp"
 #include "Utils.hpp"
 #include "traits/EnumSetTraits.hpp"
@@ -37,6 +40,34 @@ namespace lms::db
 {
     namespace
     {
+        // Column used to resume the iteration (empty if sorted by id)
+        std::string_view getKeysetSortColumn(ReleaseSortMethod sortMethod)
+        {
+            switch (sortMethod)
+            {
+            case ReleaseSortMethod::Id:
+                return "";
+            case ReleaseSortMethod::Name:
+                return "name";
+            case ReleaseSortMethod::SortName:
+                return "sort_name";
+            case ReleaseSortMethod::None:
+            case ReleaseSortMethod::ArtistNameThenName:
+            case ReleaseSortMethod::Random:
+            case ReleaseSortMethod::LastWrittenDesc:
+            case ReleaseSortMethod::AddedDesc:
+            case ReleaseSortMethod::DateAsc:
+            case ReleaseSortMethod::DateDesc:
+            case ReleaseSortMethod::OriginalDate:
+            case ReleaseSortMethod::OriginalDateDesc:
+            case ReleaseSortMethod::StarredDateDesc:
+            case ReleaseSortMethod::Relevance:
+                break;
+            }
+
+            throw Exception{ "Keyset pagination not supported for this release sort method" };
+        }
+
         template<typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Release::FindParameters& params)
         {
@@ -107,7 +138,10 @@ namespace lms::db
             if (!params.name.empty())
                 query.where("r.name = ?").bind(params.name);
 
-            for (std::string_view keyword : params.keywords)
+            // sort names are indexed too, but only the names are searched
+            std::vector<std::string_view> likeKeywords;
+            const bool matchesSearchIndex{ searchIndex::joinMatchingRows(session, query, "release", "r", std::array<std::string_view, 1>{ "name" }, params.keywords, likeKeywords) };
+            for (std::string_view keyword : likeKeywords)
                 query.where("r.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeForLikeKeyword(keyword) + "%");
 
             if (params.starringUser.isValid())
@@ -203,6 +237,9 @@ namespace lms::db
             if (params.releaseGroupMBID)
                 query.where("group_mbid = ?").bind(params.releaseGroupMBID->getAsString());
 
+            if (params.after)
+                utils::whereSortedAfter(query, "r", getKeysetSortColumn(params.sortMethod), *params.after);
+
             switch (params.sortMethod)
             {
             case ReleaseSortMethod::None:
@@ -211,10 +248,10 @@ namespace lms::db
                 query.orderBy("r.id");
                 break;
             case ReleaseSortMethod::Name:
-                query.orderBy("r.name COLLATE NOCASE");
+                query.orderBy("r.name COLLATE NOCASE, r.id");
                 break;
             case ReleaseSortMethod::SortName:
-                query.orderBy("r.sort_name COLLATE NOCASE");
+                query.orderBy("r.sort_name COLLATE NOCASE, r.id");
                 break;
             case ReleaseSortMethod::ArtistNameThenName:
                 query.orderBy("a.name COLLATE NOCASE, r.name COLLATE NOCASE");
@@ -244,6 +281,9 @@ namespace lms::db
                 assert(params.starringUser.isValid());
                 query.orderBy("s_r.date_time DESC");
                 break;
+            case ReleaseSortMethod::Relevance:
+                query.orderBy(matchesSearchIndex ? "release_fts.rank, r.id" : "r.id");
+                break;
             }
 
             return query;
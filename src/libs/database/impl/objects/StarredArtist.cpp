@@ -52,6 +52,23 @@ namespace lms::db
         return utils::fetchQuerySingleResult(session.getDboSession()->find<StarredArtist>().where("artist_id = ?").bind(artistId).where("user_id = ?").bind(userId).where("backend = ?").bind(backend));
     }
 
+    void StarredArtist::find(Session& session, UserId userId, const std::function<void(ArtistId artistId, const Wt::WDateTime& dateTime)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<std::tuple<ArtistId, Wt::WDateTime>>("SELECT s_a.artist_id, s_a.date_time FROM starred_artist s_a") };
+        query.join("user u ON u.id = s_a.user_id")
+            .where("s_a.user_id = ?")
+            .bind(userId)
+            .where("s_a.backend = u.feedback_backend")
+            .where("s_a.sync_state <> ?")
+            .bind(SyncState::PendingRemove);
+
+        utils::forEachQueryResult(query, [&](const auto& res) {
+            func(std::get<0>(res), std::get<1>(res));
+        });
+    }
+
     void StarredArtist::setDateTime(const Wt::WDateTime& dateTime)
     {
         _dateTime = utils::normalizeDateTime(dateTime);
@@ -2,6 +2,9 @@
 
 #include "database/objects/Track.hpp"
 
+#include <algorithm>
+#include <array>
+
 #include <Wt/Dbo/Impl.h>
 #include <Wt/Dbo/WtSqlTraits.h>
 
@@ -22,6 +25,7 @@
 #include "database/objects/TrackLyrics.hpp"
 #include "database/objects/User.hpp"
 
+#include "SearchIndex.hpp"
 #include "SqlQuery.hpp"
 #include "Utils.hpp"
 #include "traits/IdTypeTraits.hpp"
@@ -35,6 +39,33 @@ namespace lms::db
 {
     namespace
     {
+        // Column used to resume the iteration (empty if sorted by id)
+        std::string_view getKeysetSortColumn(TrackSortMethod sortMethod)
+        {
+            switch (sortMethod)
+            {
+            case TrackSortMethod::Id:
+                return "";
+            case TrackSortMethod::Name:
+                return "name";
+            case TrackSortMethod::None:
+            case TrackSortMethod::Random:
+            case TrackSortMethod::LastWrittenDesc:
+            case TrackSortMethod::AddedDesc:
+            case TrackSortMethod::StarredDateDesc:
+            case TrackSortMethod::AbsoluteFilePath:
+            case TrackSortMethod::DateDescAndRelease:
+            case TrackSortMethod::OriginalDateDescAndRelease:
+            case TrackSortMethod::Release:
+            case TrackSortMethod::TrackList:
+            case TrackSortMethod::TrackNumber:
+            case TrackSortMethod::Relevance:
+                break;
+            }
+
+            throw Exception{ "Keyset pagination not supported for this track sort method" };
+        }
+
         template<typename ResultType>
         Wt::Dbo::Query<ResultType> createQuery(Session& session, std::string_view itemToSelect, const Track::FindParameters& params)
         {
@@ -43,7 +74,9 @@ namespace lms::db
             auto query{ session.getDboSession()->query<ResultType>("SELECT " + std::string{ itemToSelect } + " FROM track t") };
 
             assert(params.keywords.empty() || params.name.empty());
-            for (std::string_view keyword : params.keywords)
+            std::vector<std::string_view> likeKeywords;
+            const bool matchesSearchIndex{ searchIndex::joinMatchingRows(session, query, "track", "t", std::array<std::string_view, 1>{ "name" }, params.keywords, likeKeywords) };
+            for (std::string_view keyword : likeKeywords)
                 query.where("t.name LIKE ? ESCAPE '" ESCAPE_CHAR_STR "'").bind("%" + utils::escapeForLikeKeyword(keyword) + "%");
 
             if (!params.name.empty())
@@ -178,6 +211,9 @@ namespace lms::db
                 query.where("t_e_i_l.track_embedded_image_id = ?").bind(params.embeddedImageId);
             }
 
+            if (params.after)
+                utils::whereSortedAfter(query, "t", getKeysetSortColumn(params.sortMethod), *params.after);
+
             switch (params.sortMethod)
             {
             case TrackSortMethod::None:
@@ -199,7 +235,7 @@ namespace lms::db
                 query.orderBy("s_t.date_time DESC");
                 break;
             case TrackSortMethod::Name:
-                query.orderBy("t.name COLLATE NOCASE");
+                query.orderBy("t.name COLLATE NOCASE, t.id");
                 break;
             case TrackSortMethod::AbsoluteFilePath:
                 query.orderBy("t.absolute_file_path COLLATE NOCASE");
@@ -220,6 +256,9 @@ namespace lms::db
             case TrackSortMethod::TrackNumber:
                 query.orderBy("t.track_number");
                 break;
+            case TrackSortMethod::Relevance:
+                query.orderBy(matchesSearchIndex ? "track_fts.rank, t.id" : "t.id");
+                break;
             }
             return query;
         }
@@ -238,6 +277,22 @@ namespace lms::db
 
             return createQuery<ResultType>(session, itemToSelect, params);
         }
+
+        // Just loading the objects is enough: the pointers already held by the tracks then refer to them
+        template<typename Object, typename IdType>
+        void loadObjects(Session& session, std::string_view tableName, std::vector<IdType>& ids)
+        {
+            std::sort(std::begin(ids), std::end(ids));
+            ids.erase(std::unique(std::begin(ids), std::end(ids)), std::end(ids));
+            std::erase_if(ids, [](IdType id) { return !id.isValid(); });
+            if (ids.empty())
+                return;
+
+            auto query{ session.getDboSession()->query<Wt::Dbo::ptr<Object>>("SELECT o FROM " + std::string{ tableName } + " o") };
+            utils::whereIn(query, "o.id", std::span<const IdType>{ ids });
+
+            utils::forEachQueryResult(query, [](const Wt::Dbo::ptr<Object>&) {});
+        }
     } // namespace
 
     Track::pointer Track::create(Session& session)
@@ -263,7 +318,7 @@ namespace lms::db
     {
         session.checkReadTransaction();
 
-        auto query{ session.getDboSession()->query<std::tuple<int, Wt::WDateTime>>("SELECT t.scan_version, t.file_last_write FROM track t WHERE t.absolute_file_path = ?") };
+        auto query{ session.getDboSession()->query<std::tuple<int, Wt::WDateTime, long long>>("SELECT t.scan_version, t.file_last_write, t.file_size FROM track t WHERE t.absolute_file_path = ?") };
         query.bind(p);
 
         std::optional<FileInfo> result;
@@ -272,12 +327,34 @@ namespace lms::db
             FileInfo info;
             info.scanVersion = std::get<0>(row);
             info.lastWrittenTime = std::get<1>(row);
+            info.fileSize = static_cast<std::size_t>(std::get<2>(row));
             result = info;
         });
 
         return result;
     }
 
+    void Track::findFileInfo(Session& session, MediaLibraryId library, TrackId& lastRetrievedId, std::size_t count, const std::function<void(const std::filesystem::path& absoluteFilePath, const FileInfo& fileInfo)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<std::tuple<TrackId, std::filesystem::path, int, Wt::WDateTime, long long>>("SELECT t.id, t.absolute_file_path, t.scan_version, t.file_last_write, t.file_size FROM track t") };
+        query.where("t.media_library_id = ?").bind(library);
+        query.where("t.id > ?").bind(lastRetrievedId);
+        query.orderBy("t.id");
+        query.limit(static_cast<int>(count));
+
+        utils::forEachQueryResult(query, [&](const auto& row) {
+            FileInfo info;
+            info.scanVersion = std::get<2>(row);
+            info.lastWrittenTime = std::get<3>(row);
+            info.fileSize = static_cast<std::size_t>(std::get<4>(row));
+
+            func(std::get<1>(row), info);
+            lastRetrievedId = std::get<0>(row);
+        });
+    }
+
     Track::pointer Track::find(Session& session, TrackId id)
     {
         session.checkReadTransaction();
@@ -323,6 +400,21 @@ namespace lms::db
         });
     }
 
+    void Track::find(Session& session, std::span<const TrackId> trackIds, const std::function<void(const Track::pointer&)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (trackIds.empty())
+            return;
+
+        auto query{ session.getDboSession()->query<Wt::Dbo::ptr<Track>>("SELECT t from track t") };
+        utils::whereIn(query, "t.id", trackIds);
+
+        utils::forEachQueryResult(query, [&](const Track::pointer& track) {
+            func(track);
+        });
+    }
+
     IdRange<TrackId> Track::findNextIdRange(Session& session, TrackId lastRetrievedId, std::size_t count)
     {
         auto query{ session.getDboSession()->query<std::tuple<TrackId, TrackId>>("SELECT MIN(sub.id) AS first_id, MAX(sub.id) AS last_id FROM (SELECT t.id FROM track t WHERE t.id > ? ORDER BY t.id LIMIT ?) sub") };
@@ -333,6 +425,34 @@ namespace lms::db
         return IdRange<TrackId>{ .first = std::get<0>(res), .last = std::get<1>(res) };
     }
 
+    void Track::findClusterIds(Session& session, const IdRange<TrackId>& idRange, const std::function<void(TrackId trackId, ClusterId clusterId)>& func)
+    {
+        assert(idRange.isValid());
+        session.checkReadTransaction();
+
+        using ResultType = std::tuple<TrackId, ClusterId>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t_c.track_id, t_c.cluster_id FROM track_cluster t_c").where("t_c.track_id BETWEEN ? AND ?").bind(idRange.first).bind(idRange.last) };
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<TrackId>(result), std::get<ClusterId>(result));
+        });
+    }
+
+    void Track::findReleaseIds(Session& session, const IdRange<TrackId>& idRange, const std::function<void(TrackId trackId, ReleaseId releaseId)>& func)
+    {
+        assert(idRange.isValid());
+        session.checkReadTransaction();
+
+        using ResultType = std::tuple<TrackId, ReleaseId>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t.id, t.release_id FROM track t").where("t.id BETWEEN ? AND ?").bind(idRange.first).bind(idRange.last).where("t.release_id IS NOT NULL") };
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<TrackId>(result), std::get<ReleaseId>(result));
+        });
+    }
+
     bool Track::exists(Session& session, TrackId id)
     {
         session.checkReadTransaction();
@@ -392,6 +512,32 @@ namespace lms::db
             utils::executeCommand(*session.getDboSession(), "UPDATE track SET preferred_media_artwork_id = NULL WHERE id = ?", trackId);
     }
 
+    void Track::loadRelatedObjects(Session& session, std::span<const pointer> tracks)
+    {
+        session.checkReadTransaction();
+
+        std::vector<ReleaseId> releaseIds;
+        std::vector<MediumId> mediumIds;
+        std::vector<DirectoryId> directoryIds;
+        std::vector<MediaLibraryId> mediaLibraryIds;
+        std::vector<ArtworkId> artworkIds;
+        for (const pointer& track : tracks)
+        {
+            releaseIds.push_back(track->_release.id());
+            mediumIds.push_back(track->_medium.id());
+            directoryIds.push_back(track->_directory.id());
+            mediaLibraryIds.push_back(track->_mediaLibrary.id());
+            artworkIds.push_back(track->_preferredArtwork.id());
+            artworkIds.push_back(track->_preferredMediaArtwork.id());
+        }
+
+        loadObjects<Release>(session, "release", releaseIds);
+        loadObjects<Medium>(session, "medium", mediumIds);
+        loadObjects<Directory>(session, "directory", directoryIds);
+        loadObjects<MediaLibrary>(session, "media_library", mediaLibraryIds);
+        loadObjects<Artwork>(session, "artwork", artworkIds);
+    }
+
     std::vector<Cluster::pointer> Track::getClusters() const
     {
         return utils::fetchQueryResults<Cluster::pointer>(_clusters.find());
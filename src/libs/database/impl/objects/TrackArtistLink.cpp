@@ -2,6 +2,8 @@
 
 #include "database/objects/TrackArtistLink.hpp"
 
+#include <cassert>
+
 #include <Wt/Dbo/Impl.h>
 
 #include "core/ILogger.hpp"
@@ -108,12 +110,44 @@ namespace lms::db
         });
     }
 
+    void TrackArtistLink::find(Session& session, std::span<const TrackId> trackIds, const std::function<void(const TrackArtistLink::pointer& link, const ObjectPtr<Artist>& artist)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (trackIds.empty())
+            return;
+
+        using ResultType = std::tuple<Wt::Dbo::ptr<TrackArtistLink>, Wt::Dbo::ptr<Artist>>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t_a_l, a FROM track_artist_link t_a_l").join("artist a ON t_a_l.artist_id = a.id") };
+        utils::whereIn(query, "t_a_l.track_id", trackIds);
+        query.orderBy("t_a_l.id");
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<Wt::Dbo::ptr<TrackArtistLink>>(result), std::get<Wt::Dbo::ptr<Artist>>(result));
+        });
+    }
+
     void TrackArtistLink::find(Session& session, const FindParameters& parameters, const std::function<void(const TrackArtistLink::pointer&)>& func)
     {
         auto query{ createQuery(session, parameters) };
         utils::forEachQueryRangeResult(query, parameters.range, func);
     }
 
+    void TrackArtistLink::findArtistIds(Session& session, const IdRange<TrackId>& trackIdRange, const std::function<void(TrackId trackId, ArtistId artistId, TrackArtistLinkType type)>& func)
+    {
+        assert(trackIdRange.isValid());
+        session.checkReadTransaction();
+
+        using ResultType = std::tuple<TrackId, ArtistId, TrackArtistLinkType>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT t_a_l.track_id, t_a_l.artist_id, t_a_l.type FROM track_artist_link t_a_l").where("t_a_l.track_id BETWEEN ? AND ?").bind(trackIdRange.first).bind(trackIdRange.last) };
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<TrackId>(result), std::get<ArtistId>(result), std::get<TrackArtistLinkType>(result));
+        });
+    }
+
     core::EnumSet<TrackArtistLinkType> TrackArtistLink::findUsedTypes(Session& session, ArtistId artistId)
     {
         session.checkReadTransaction();
@@ -127,6 +161,23 @@ namespace lms::db
         return res;
     }
 
+    void TrackArtistLink::findUsedTypes(Session& session, std::span<const ArtistId> artistIds, const std::function<void(ArtistId artistId, TrackArtistLinkType type)>& func)
+    {
+        session.checkReadTransaction();
+
+        if (artistIds.empty())
+            return;
+
+        using ResultType = std::tuple<ArtistId, TrackArtistLinkType>;
+
+        auto query{ session.getDboSession()->query<ResultType>("SELECT DISTINCT artist_id, type FROM track_artist_link") };
+        utils::whereIn(query, "artist_id", artistIds);
+
+        utils::forEachQueryResult(query, [&](const ResultType& result) {
+            func(std::get<ArtistId>(result), std::get<TrackArtistLinkType>(result));
+        });
+    }
+
     void TrackArtistLink::findArtistNameNoLongerMatch(Session& session, std::optional<Range> range, const std::function<void(const TrackArtistLink::pointer&)>& func)
     {
         session.checkReadTransaction();
@@ -60,6 +60,29 @@ namespace lms::db
         return utils::execRangeQuery<TrackFeaturesId>(query, range);
     }
 
+    void TrackFeatures::findTrackIds(Session& session, const std::function<void(TrackFeaturesId trackFeaturesId, TrackId trackId)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<std::tuple<TrackFeaturesId, TrackId>>("SELECT t_f.id, t_f.track_id FROM track_features t_f") };
+
+        utils::forEachQueryResult(query, [&](const auto& res) {
+            func(std::get<0>(res), std::get<1>(res));
+        });
+    }
+
+    void TrackFeatures::findEncodedFeatures(Session& session, TrackFeaturesId& lastRetrievedId, std::size_t count, const std::function<void(TrackFeaturesId trackFeaturesId, TrackId trackId, const std::string& jsonEncodedFeatures)>& func)
+    {
+        session.checkReadTransaction();
+
+        auto query{ session.getDboSession()->query<std::tuple<TrackFeaturesId, TrackId, std::string>>("SELECT t_f.id, t_f.track_id, t_f.data FROM track_features t_f").orderBy("t_f.id").where("t_f.id > ?").bind(lastRetrievedId).limit(static_cast<int>(count)) };
+
+        utils::forEachQueryResult(query, [&](const auto& res) {
+            func(std::get<0>(res), std::get<1>(res), std::get<2>(res));
+            lastRetrievedId = std::get<0>(res);
+        });
+    }
+
     FeatureValues TrackFeatures::getFeatureValues(const FeatureName& featureNode) const
     {
         FeatureValuesMap featuresValuesMap{ getFeatureValuesMap({ featureNode }) };
@@ -67,12 +90,17 @@ namespace lms::db
     }
 
     FeatureValuesMap TrackFeatures::getFeatureValuesMap(const std::unordered_set<FeatureName>& featureNames) const
+    {
+        return parseFeatureValuesMap(_data, featureNames);
+    }
+
+    FeatureValuesMap TrackFeatures::parseFeatureValuesMap(const std::string& jsonEncodedFeatures, const std::unordered_set<FeatureName>& featureNames)
     {
         FeatureValuesMap res;
 
         try
         {
-            std::istringstream iss{ _data };
+            std::istringstream iss{ jsonEncodedFeatures };
             boost::property_tree::ptree root;
 
             boost::property_tree::read_json(iss, root);
@@ -96,7 +124,7 @@ namespace lms::db
         }
         catch (boost::property_tree::ptree_error& error)
         {
-            LMS_LOG(DB, ERROR, "Track " << _track.id() << ": ptree exception: " << error.what());
+            LMS_LOG(DB, ERROR, "Cannot parse track features: ptree exception: " << error.what());
             res.clear();
         }
 
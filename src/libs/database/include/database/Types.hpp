@@ -6,6 +6,7 @@
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <string>
 
 #include <Wt/WDate.h>
 
@@ -86,6 +87,15 @@ namespace lms::db
         }
     };
 
+    // Keyset pagination: resume point, made of the sort key value and the id of the last retrieved object
+    // The object itself is not needed anymore, it may have been removed in the meantime
+    template<typename IdType>
+    struct KeysetCursor
+    {
+        std::string sortKey; // unused when sorting by id
+        IdType id;
+    };
+
     struct FileStats
     {
         std::size_t trackCount;
@@ -106,6 +116,7 @@ namespace lms::db
     struct FileInfo
     {
         Wt::WDateTime lastWrittenTime;
+        std::size_t fileSize{};
         std::size_t scanVersion{};
     };
 
@@ -119,6 +130,7 @@ namespace lms::db
         LastWrittenDesc,
         AddedDesc,
         StarredDateDesc,
+        Relevance, // keyword search only: best matches first (by id if the full-text index cannot be used)
     };
 
     enum class ClusterSortMethod
@@ -169,6 +181,7 @@ namespace lms::db
         LastWrittenDesc,
         AddedDesc,
         StarredDateDesc,
+        Relevance, // keyword search only: best matches first (by id if the full-text index cannot be used)
     };
 
     enum class ReleaseTypeSortMethod
@@ -214,6 +227,7 @@ namespace lms::db
         Release,   // order by disc/track number
         TrackList, // order by asc order in tracklist
         TrackNumber,
+        Relevance, // keyword search only: best matches first (by id if the full-text index cannot be used)
     };
 
     enum class TrackLyricsSortMethod
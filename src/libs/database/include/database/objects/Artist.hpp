@@ -50,6 +50,7 @@ namespace lms::db
             std::optional<TrackArtistLinkType> linkType; // if set, only artists that have produced at least one track with this link type
             ArtistSortMethod sortMethod{ ArtistSortMethod::None };
             std::optional<Range> range;
+            std::optional<KeysetCursor<ArtistId>> after; // keyset pagination: only artists sorted after this cursor (sort method must be Id, Name or SortName)
             Wt::WDateTime writtenAfter;
             UserId starringUser;                            // only artists starred by this user
             std::optional<FeedbackBackend> feedbackBackend; // and for this feedback backend
@@ -81,6 +82,11 @@ namespace lms::db
                 range = _range;
                 return *this;
             }
+            FindParameters& setAfter(const KeysetCursor<ArtistId>& _after)
+            {
+                after = _after;
+                return *this;
+            }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after)
             {
                 writtenAfter = _after;
@@ -120,6 +126,8 @@ namespace lms::db
         static RangeResults<ArtistId> findOrphanIds(Session& session, std::optional<Range> range = std::nullopt); // No track related
         static bool exists(Session& session, ArtistId id);
         static RangeResults<pointer> findWithMBIDNameVariants(Session& session, ArtistId& lastRetrievedArtist, std::optional<Range> range = std::nullopt);
+        // Number of distinct releases the artists are involved in (any link type), artists without release are not reported
+        static void findReleaseCounts(Session& session, std::span<const ArtistId> artistIds, const std::function<void(ArtistId artistId, std::size_t releaseCount)>& func);
 
         // Updates
         static void updatePreferredArtwork(Session& session, ArtistId artistId, ArtworkId artworkId);
@@ -3,6 +3,8 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
+#include <span>
 #include <variant>
 
 #include <Wt/Dbo/Field.h>
@@ -29,6 +31,8 @@ namespace lms::db
         static pointer find(Session& session, ArtworkId id);
         static pointer find(Session& session, TrackEmbeddedImageId id);
         static pointer find(Session& session, ImageId id);
+        // Same as getLastWrittenTime, for several artworks at once
+        static void findLastWrittenTimes(Session& session, std::span<const ArtworkId> artworkIds, const std::function<void(ArtworkId artworkId, const Wt::WDateTime& lastWrittenTime)>& func);
 
         // getters
         using UnderlyingId = std::variant<std::monostate, TrackEmbeddedImageId, ImageId>;
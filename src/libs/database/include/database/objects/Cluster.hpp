@@ -3,6 +3,7 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -77,11 +78,21 @@ namespace lms::db
         static RangeResults<pointer> find(Session& session, const FindParameters& params);
         static void find(Session& session, const FindParameters& params, std::function<void(const pointer& cluster)> _func);
         static pointer find(Session& session, ClusterId id);
+        // Clusters of the given type for several tracks at once
+        static void find(Session& session, std::span<const TrackId> trackIds, std::string_view clusterTypeName, const std::function<void(TrackId trackId, const pointer& cluster)>& func);
         static RangeResults<ClusterId> findOrphanIds(Session& session, std::optional<Range> range = std::nullopt);
 
         // May be very slow
         static std::size_t computeTrackCount(Session& session, ClusterId id);
         static std::size_t computeReleaseCount(Session& session, ClusterId id);
+        // Set based version of the above, using a single grouped query for all the given clusters
+        static void computeStats(Session& session, std::span<const ClusterId> clusterIds, const std::function<void(const pointer& cluster, std::size_t trackCount, std::size_t releaseCount)>& func);
+
+        // Clusters whose stats may be out of date, automatically flagged when tracks are added, removed or moved
+        static std::size_t getStatsDirtyCount(Session& session);
+        static std::vector<ClusterId> findStatsDirtyIds(Session& session, std::size_t maxCount);
+        static void markAllStatsDirty(Session& session);
+        static void clearStatsDirty(Session& session, std::span<const ClusterId> clusterIds);
 
         // Accessors
         std::string_view getName() const { return _name; }
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <functional>
 #include <optional>
 
 #include <Wt/Dbo/Field.h>
@@ -46,6 +47,7 @@ namespace lms::db
         static pointer find(Session& session, RatedArtistId id);
         static pointer find(Session& session, ArtistId artistId, UserId userId);
         static void find(Session& session, const FindParameters& findParams, std::function<void(const pointer&)> func);
+        static void find(Session& session, UserId userId, const std::function<void(ArtistId artistId, Rating rating)>& func); // all the ratings of the user
 
         // Accessors
         ObjectPtr<Artist> getArtist() const { return _artist; }
@@ -145,6 +145,7 @@ namespace lms::db
             std::string name;                       // must match this name (cannot be set with keywords)
             ReleaseSortMethod sortMethod{ ReleaseSortMethod::None };
             std::optional<Range> range;
+            std::optional<KeysetCursor<ReleaseId>> after; // keyset pagination: only releases sorted after this cursor (sort method must be Id, Name or SortName)
             Wt::WDateTime writtenAfter;
             std::optional<YearRange> dateRange;
             UserId starringUser;                                             // only releases starred by this user
@@ -182,6 +183,11 @@ namespace lms::db
                 range = _range;
                 return *this;
             }
+            FindParameters& setAfter(const KeysetCursor<ReleaseId>& _after)
+            {
+                after = _after;
+                return *this;
+            }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after)
             {
                 writtenAfter = _after;
@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <Wt/Dbo/Field.h>
 #include <Wt/WDateTime.h>
 
@@ -27,6 +29,8 @@ namespace lms::db
         static pointer find(Session& session, StarredArtistId id);
         static pointer find(Session& session, ArtistId artistId, UserId userId); // current backend
         static pointer find(Session& session, ArtistId artistId, UserId userId, FeedbackBackend backend);
+        // All the artists starred by the user, current backend, pending removals excluded
+        static void find(Session& session, UserId userId, const std::function<void(ArtistId artistId, const Wt::WDateTime& dateTime)>& func);
 
         // Accessors
         ObjectPtr<Artist> getArtist() const { return _artist; }
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <optional>
 #include <ostream>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -60,6 +61,7 @@ namespace lms::db
             std::string name;                       // if non empty, must match this name (title)
             TrackSortMethod sortMethod{ TrackSortMethod::None };
             std::optional<Range> range;
+            std::optional<KeysetCursor<TrackId>> after; // keyset pagination: only tracks sorted after this cursor (sort method must be Id or Name)
             Wt::WDateTime writtenAfter;
             UserId starringUser;                                     // only tracks starred by this user
             std::optional<FeedbackBackend> feedbackBackend;          // and for this feedback backend
@@ -101,6 +103,11 @@ namespace lms::db
                 range = _range;
                 return *this;
             }
+            FindParameters& setAfter(const KeysetCursor<TrackId>& _after)
+            {
+                after = _after;
+                return *this;
+            }
             FindParameters& setWrittenAfter(const Wt::WDateTime& _after)
             {
                 writtenAfter = _after;
@@ -177,10 +184,15 @@ namespace lms::db
         static std::size_t getCount(Session& session);
         static pointer findByPath(Session& session, const std::filesystem::path& p);
         static std::optional<FileInfo> findFileInfo(Session& session, const std::filesystem::path& p);
+        static void findFileInfo(Session& session, MediaLibraryId library, TrackId& lastRetrievedId, std::size_t count, const std::function<void(const std::filesystem::path& absoluteFilePath, const FileInfo& fileInfo)>& func);
         static pointer find(Session& session, TrackId id);
         static void find(Session& session, TrackId& lastRetrievedId, std::size_t count, const std::function<void(const Track::pointer&)>& func, MediaLibraryId library = {});
         static void find(Session& session, const IdRange<TrackId>& idRange, const std::function<void(const Track::pointer&)>& func);
+        static void find(Session& session, std::span<const TrackId> trackIds, const std::function<void(const Track::pointer&)>& func);
         static IdRange<TrackId> findNextIdRange(Session& session, TrackId lastRetrievedId, std::size_t count);
+        // Bulk loading: the clusters and the release of each track in the range
+        static void findClusterIds(Session& session, const IdRange<TrackId>& idRange, const std::function<void(TrackId trackId, ClusterId clusterId)>& func);
+        static void findReleaseIds(Session& session, const IdRange<TrackId>& idRange, const std::function<void(TrackId trackId, ReleaseId releaseId)>& func);
         static void findAbsoluteFilePath(Session& session, TrackId& lastRetrievedId, std::size_t count, const std::function<void(TrackId trackId, const std::filesystem::path& absoluteFilePath)>& func);
 
         static bool exists(Session& session, TrackId id);
@@ -195,6 +207,9 @@ namespace lms::db
         static RangeResults<TrackId> findIdsTrackMBIDDuplicates(Session& session, std::optional<Range> range = std::nullopt);
         static RangeResults<TrackId> findIdsWithRecordingMBIDAndMissingFeatures(Session& session, std::optional<Range> range = std::nullopt);
 
+        // Loads the release, medium, directory, media library and artworks of all the given tracks using one query per object type
+        static void loadRelatedObjects(Session& session, std::span<const pointer> tracks);
+
         // Update utility functions
         static void updatePreferredArtwork(Session& session, TrackId trackId, ArtworkId artworkId);
         static void updatePreferredMediaArtwork(Session& session, TrackId trackId, ArtworkId artworkId);
@@ -3,12 +3,14 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 
 #include <Wt/Dbo/Field.h>
 
 #include "core/EnumSet.hpp"
+#include "database/IdRange.hpp"
 #include "database/IdType.hpp"
 #include "database/Object.hpp"
 #include "database/Types.hpp"
@@ -78,17 +80,23 @@ namespace lms::db
         TrackArtistLink(const ObjectPtr<Track>& track, const ObjectPtr<Artist>& artist, TrackArtistLinkType type, std::string_view subType, bool artistMBIDMatched);
 
         static void find(Session& session, TrackId trackId, const std::function<void(const pointer&, const ObjectPtr<Artist>&)>& func);
+        // Links of several tracks at once, ordered by link creation
+        static void find(Session& session, std::span<const TrackId> trackIds, const std::function<void(const pointer&, const ObjectPtr<Artist>&)>& func);
         static void find(Session& session, const FindParameters& parameters, const std::function<void(const pointer&)>& func);
         static pointer find(Session& session, TrackArtistLinkId linkId);
+        // Bulk loading: the artists linked to each track in the range
+        static void findArtistIds(Session& session, const IdRange<TrackId>& trackIdRange, const std::function<void(TrackId trackId, ArtistId artistId, TrackArtistLinkType type)>& func);
         static std::size_t getCount(Session& session);
         static pointer create(Session& session, const ObjectPtr<Track>& track, const ObjectPtr<Artist>& artist, TrackArtistLinkType type, std::string_view subType, bool artistMBIDMatched = false);
         static pointer create(Session& session, const ObjectPtr<Track>& track, const ObjectPtr<Artist>& artist, TrackArtistLinkType type, bool artistMBIDMatched = false);
         static core::EnumSet<TrackArtistLinkType> findUsedTypes(Session& session, ArtistId _artist);
+        static void findUsedTypes(Session& session, std::span<const ArtistId> artistIds, const std::function<void(ArtistId artistId, TrackArtistLinkType type)>& func);
         static void findArtistNameNoLongerMatch(Session& session, std::optional<Range> range, const std::function<void(const pointer&)>& func);
         static void findWithArtistNameAmbiguity(Session& session, std::optional<Range> range, bool allowArtistMBIDFallback, const std::function<void(const pointer&)>& func);
 
         // accessors
         ObjectPtr<Track> getTrack() const { return _track; }
+        TrackId getTrackId() const { return _track.id(); }
         ObjectPtr<Artist> getArtist() const { return _artist; }
         TrackArtistLinkType getType() const { return _type; }
         std::string_view getSubType() const { return _subType; }
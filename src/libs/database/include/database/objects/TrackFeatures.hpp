@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <functional>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -13,10 +14,9 @@
 #include "database/IdType.hpp"
 #include "database/Object.hpp"
 #include "database/Types.hpp"
+#include "database/objects/TrackFeaturesId.hpp"
 #include "database/objects/TrackId.hpp"
 
-LMS_DECLARE_IDTYPE(TrackFeaturesId)
-
 namespace lms::db
 {
     class Session;
@@ -36,6 +36,12 @@ namespace lms::db
         static pointer find(Session& session, TrackFeaturesId id);
         static pointer find(Session& session, TrackId trackId);
         static RangeResults<TrackFeaturesId> find(Session& session, std::optional<Range> range = std::nullopt);
+        static void findTrackIds(Session& session, const std::function<void(TrackFeaturesId trackFeaturesId, TrackId trackId)>& func);
+        // Ordered by id, to be used to iterate over all the features using batches
+        static void findEncodedFeatures(Session& session, TrackFeaturesId& lastRetrievedId, std::size_t count, const std::function<void(TrackFeaturesId trackFeaturesId, TrackId trackId, const std::string& jsonEncodedFeatures)>& func);
+
+        // Does not need any session, returns an empty map on error
+        static FeatureValuesMap parseFeatureValuesMap(const std::string& jsonEncodedFeatures, const std::unordered_set<FeatureName>& featureNames);
 
         FeatureValues getFeatureValues(const FeatureName& feature) const;
         FeatureValuesMap getFeatureValuesMap(const std::unordered_set<FeatureName>& featureNames) const;
@@ -0,0 +1,7 @@
+// 曲目特征 ID 定义
+
+#pragma once
+
+#include "database/IdType.hpp"
+
+LMS_DECLARE_IDTYPE(TrackFeaturesId)
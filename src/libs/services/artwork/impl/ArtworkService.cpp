@@ -25,22 +25,31 @@
 
 namespace lms::artwork
 {
-    std::unique_ptr<IArtworkService> createArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath)
+    std::unique_ptr<IArtworkService> createArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath, const std::filesystem::path& cachePath)
     {
-        return std::make_unique<ArtworkService>(db, defaultReleaseCoverSvgPath, defaultArtistImageSvgPath);
+        return std::make_unique<ArtworkService>(db, defaultReleaseCoverSvgPath, defaultArtistImageSvgPath, cachePath);
     }
 
     ArtworkService::ArtworkService(db::IDb& db,
                                    const std::filesystem::path& defaultReleaseCoverSvgPath,
-                                   const std::filesystem::path& defaultArtistImageSvgPath)
+                                   const std::filesystem::path& defaultArtistImageSvgPath,
+                                   const std::filesystem::path& cachePath)
         : _db{ db }
-        , _cache{ core::Service<core::IConfig>::get()->getULong("cover-max-cache-size", 30) * 1000 * 1000 }
+        , _cache{ ImageCache::Parameters{
+              .maxCacheSize = core::Service<core::IConfig>::get()->getULong("cover-max-cache-size", 30) * 1000 * 1000,
+              .maxOriginalImageSize = core::Service<core::IConfig>::get()->getULong("cover-max-cached-original-size", 100) * 1000,
+              .enableAdmissionFilter = core::Service<core::IConfig>::get()->getBool("cover-cache-admission-filter", false),
+          } }
     {
         setJpegQuality(core::Service<core::IConfig>::get()->getULong("cover-jpeg-quality", 75));
 
         LMS_LOG(COVER, INFO, "Default release cover path = " << defaultReleaseCoverSvgPath);
         LMS_LOG(COVER, INFO, "Max cache size = " << _cache.getMaxCacheSize());
 
+        const std::size_t maxDiskCacheSize{ core::Service<core::IConfig>::get()->getULong("cover-max-disk-cache-size", 500) * 1000 * 1000 };
+        if (maxDiskCacheSize > 0)
+            _diskCache = std::make_unique<DiskImageCache>(cachePath, maxDiskCacheSize);
+
         _defaultReleaseCover = image::readImage(defaultReleaseCoverSvgPath); // may throw
         _defaultArtistImage = image::readImage(defaultArtistImageSvgPath);   // may throw
     }
@@ -177,9 +186,9 @@ namespace lms::artwork
         }
 
         if (const auto* trackEmbeddedImageId = std::get_if<db::TrackEmbeddedImageId>(&underlyingArtworkId))
-            image = getTrackEmbeddedImage(*trackEmbeddedImageId, width);
+            image = getTrackEmbeddedImage(artworkId, *trackEmbeddedImageId, width);
         else if (const auto* imageId = std::get_if<db::ImageId>(&underlyingArtworkId))
-            image = getImage(*imageId, width);
+            image = getImage(artworkId, *imageId, width);
 
         if (image)
             _cache.addImage(cacheEntryDesc, image);
@@ -187,7 +196,25 @@ namespace lms::artwork
         return image;
     }
 
-    std::shared_ptr<image::IEncodedImage> ArtworkService::getImage(db::ImageId imageId, std::optional<image::ImageSize> width)
+    template<typename CreateImageFunc>
+    std::shared_ptr<image::IEncodedImage> ArtworkService::getThroughDiskCache(const DiskImageCache::EntryDesc& entryDesc, CreateImageFunc createImage)
+    {
+        const std::optional<DiskImageCache::Key> key{ DiskImageCache::computeKey(entryDesc) };
+        if (!key)
+            return createImage();
+
+        std::shared_ptr<image::IEncodedImage> image{ _diskCache->getImage(*key) };
+        if (image)
+            return image;
+
+        image = createImage();
+        if (image)
+            _diskCache->addImage(*key, image);
+
+        return image;
+    }
+
+    std::shared_ptr<image::IEncodedImage> ArtworkService::getImage(db::ArtworkId artworkId, db::ImageId imageId, std::optional<image::ImageSize> width)
     {
         std::filesystem::path imageFile;
         std::string mimeType;
@@ -203,23 +230,47 @@ namespace lms::artwork
             mimeType = image->getMimeType();
         }
 
-        return getFromImageFile(imageFile, mimeType, width);
+        auto createImage{ [&]() -> std::shared_ptr<image::IEncodedImage> { return getFromImageFile(imageFile, mimeType, width); } };
+
+        if (!_diskCache || !width)
+            return createImage();
+
+        return getThroughDiskCache(DiskImageCache::EntryDesc{ .artworkId = artworkId, .sourceFile = imageFile, .sourceIndex = 0, .width = *width, .jpegQuality = _jpegQuality }, createImage);
     }
 
-    std::shared_ptr<image::IEncodedImage> ArtworkService::getTrackEmbeddedImage(db::TrackEmbeddedImageId trackEmbeddedImageId, std::optional<image::ImageSize> width)
+    std::shared_ptr<image::IEncodedImage> ArtworkService::getTrackEmbeddedImage(db::ArtworkId artworkId, db::TrackEmbeddedImageId trackEmbeddedImageId, std::optional<image::ImageSize> width)
     {
-        std::shared_ptr<image::IEncodedImage> image;
+        // the same image may be embedded in several tracks
+        struct Source
+        {
+            std::filesystem::path trackPath;
+            std::size_t index;
+        };
+        std::vector<Source> sources;
 
         {
             db::Session& session{ _db.getTLSSession() };
             auto transaction{ session.createReadTransaction() };
 
             db::TrackEmbeddedImageLink::find(session, trackEmbeddedImageId, [&](const db::TrackEmbeddedImageLink::pointer& link) {
-                if (!image)
-                    image = getTrackImage(link->getTrack()->getAbsoluteFilePath(), link->getIndex(), width);
+                sources.push_back(Source{ .trackPath = link->getTrack()->getAbsoluteFilePath(), .index = link->getIndex() });
             });
         }
 
+        std::shared_ptr<image::IEncodedImage> image;
+        for (const Source& source : sources)
+        {
+            auto createImage{ [&]() -> std::shared_ptr<image::IEncodedImage> { return getTrackImage(source.trackPath, source.index, width); } };
+
+            if (!_diskCache || !width)
+                image = createImage();
+            else
+                image = getThroughDiskCache(DiskImageCache::EntryDesc{ .artworkId = artworkId, .sourceFile = source.trackPath, .sourceIndex = source.index, .width = *width, .jpegQuality = _jpegQuality }, createImage);
+
+            if (image)
+                break;
+        }
+
         return image;
     }
 
@@ -228,6 +279,11 @@ namespace lms::artwork
         _cache.flush();
     }
 
+    IArtworkService::CacheStats ArtworkService::getCacheStats() const
+    {
+        return _cache.getStats();
+    }
+
     void ArtworkService::setJpegQuality(unsigned quality)
     {
         _jpegQuality = std::clamp<unsigned>(quality, 1, 100);
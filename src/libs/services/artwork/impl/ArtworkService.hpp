@@ -2,12 +2,14 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <vector>
 
 #include "database/objects/ImageId.hpp"
 #include "database/objects/TrackEmbeddedImageId.hpp"
 #include "services/artwork/IArtworkService.hpp"
 
+#include "DiskImageCache.hpp"
 #include "ImageCache.hpp"
 
 namespace lms::db
@@ -22,7 +24,7 @@ namespace lms::artwork
     class ArtworkService : public IArtworkService
     {
     public:
-        ArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath);
+        ArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath, const std::filesystem::path& cachePath);
         ~ArtworkService() override;
         ArtworkService(const ArtworkService&) = delete;
         ArtworkService& operator=(const ArtworkService&) = delete;
@@ -36,10 +38,16 @@ namespace lms::artwork
         std::shared_ptr<image::IEncodedImage> getDefaultArtistArtwork() override;
 
         void flushCache() override;
+        CacheStats getCacheStats() const override;
         void setJpegQuality(unsigned quality) override;
 
-        std::shared_ptr<image::IEncodedImage> getImage(db::ImageId imageId, std::optional<image::ImageSize> width);
-        std::shared_ptr<image::IEncodedImage> getTrackEmbeddedImage(db::TrackEmbeddedImageId trackEmbeddedImageId, std::optional<image::ImageSize> width);
+        std::shared_ptr<image::IEncodedImage> getImage(db::ArtworkId artworkId, db::ImageId imageId, std::optional<image::ImageSize> width);
+        std::shared_ptr<image::IEncodedImage> getTrackEmbeddedImage(db::ArtworkId artworkId, db::TrackEmbeddedImageId trackEmbeddedImageId, std::optional<image::ImageSize> width);
+
+        // 先查磁盘缓存，未命中时生成缩放后的图片并异步写入磁盘缓存。
+        // Сначала ищет в дисковом кэше, при промахе создаёт уменьшенную картинку и асинхронно сохраняет её в дисковый кэш.
+        template<typename CreateImageFunc>
+        std::shared_ptr<image::IEncodedImage> getThroughDiskCache(const DiskImageCache::EntryDesc& entryDesc, CreateImageFunc createImage);
 
         // 从普通图片文件加载封面，必要时按给定宽度缩放为 JPEG。
         // Загружает обложку из обычного файла и при необходимости масштабирует в JPEG указанной ширины.
@@ -52,6 +60,7 @@ namespace lms::artwork
         db::IDb& _db;
 
         ImageCache _cache;
+        std::unique_ptr<DiskImageCache> _diskCache; // under the memory cache, only for resized images
         std::shared_ptr<image::IEncodedImage> _defaultReleaseCover;
         std::shared_ptr<image::IEncodedImage> _defaultArtistImage;
 
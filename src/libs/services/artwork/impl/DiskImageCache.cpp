@@ -0,0 +1,139 @@
+
+#include "DiskImageCache.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "core/ILogger.hpp"
+#include "image/Exception.hpp"
+#include "image/Image.hpp"
+
+namespace lms::artwork
+{
+    DiskImageCache::DiskImageCache(const std::filesystem::path& directory, std::size_t maxCacheSize)
+        : _cache{ directory, maxCacheSize }
+    {
+        _writerThread = std::thread{ [this] { processWrites(); } };
+
+        const core::DiskLruCache::Stats stats{ _cache.getStats() };
+        LMS_LOG(COVER, INFO, "Disk cache: " << stats.entryCount << " entries, size = " << stats.size << " bytes, max size = " << stats.maxSize << " bytes");
+    }
+
+    DiskImageCache::~DiskImageCache()
+    {
+        {
+            const std::scoped_lock lock{ _mutex };
+            _stopWriting = true;
+        }
+        _writeCondVar.notify_all();
+        _writerThread.join();
+
+        const core::DiskLruCache::Stats stats{ _cache.getStats() };
+        LMS_LOG(COVER, DEBUG, "Disk cache stats: hits = " << stats.hits << ", misses = " << stats.misses << ", nb entries = " << stats.entryCount << ", size = " << stats.size);
+    }
+
+    std::optional<DiskImageCache::Key> DiskImageCache::computeKey(const EntryDesc& entryDesc)
+    {
+        std::error_code ec;
+        const std::filesystem::file_time_type lastWriteTime{ std::filesystem::last_write_time(entryDesc.sourceFile, ec) };
+        if (ec)
+            return std::nullopt;
+
+        const std::uintmax_t fileSize{ std::filesystem::file_size(entryDesc.sourceFile, ec) };
+        if (ec)
+            return std::nullopt;
+
+        std::ostringstream oss;
+        oss << entryDesc.artworkId.getValue() << '\n'
+            << entryDesc.sourceFile.string() << '\n'
+            << lastWriteTime.time_since_epoch().count() << '\n'
+            << fileSize << '\n'
+            << entryDesc.sourceIndex << '\n'
+            << entryDesc.width << '\n'
+            << entryDesc.jpegQuality;
+
+        return core::DiskLruCache::computeKey(oss.str());
+    }
+
+    std::shared_ptr<image::IEncodedImage> DiskImageCache::getImage(const Key& key)
+    {
+        const std::optional<std::filesystem::path> entryPath{ _cache.getEntry(key) };
+        if (!entryPath)
+            return nullptr;
+
+        // may have been evicted in the meantime
+        try
+        {
+            return image::readImage(*entryPath, "image/jpeg");
+        }
+        catch (const image::Exception& e)
+        {
+            LMS_LOG(COVER, DEBUG, "Cannot read disk cache entry '" << key << "': " << e.what());
+        }
+
+        // truncated or corrupted: the image will be written again
+        _cache.removeInvalidEntry(key);
+        return nullptr;
+    }
+
+    void DiskImageCache::addImage(const Key& key, std::shared_ptr<image::IEncodedImage> image)
+    {
+        if (image->getData().empty() || image->getData().size() > _cache.getMaxCacheSize())
+            return;
+
+        {
+            const std::scoped_lock lock{ _mutex };
+
+            if (_pendingWrites.size() >= _maxPendingWriteCount || _cache.hasEntry(key))
+                return;
+
+            std::optional<std::filesystem::path> tmpFilePath{ _cache.beginWrite(key) };
+            if (!tmpFilePath)
+                return;
+
+            _pendingWrites.push_back(PendingWrite{ .key = key, .tmpFilePath = std::move(*tmpFilePath), .image = std::move(image) });
+        }
+        _writeCondVar.notify_one();
+    }
+
+    void DiskImageCache::processWrites()
+    {
+        while (true)
+        {
+            PendingWrite pendingWrite;
+
+            {
+                std::unique_lock lock{ _mutex };
+                _writeCondVar.wait(lock, [this] { return _stopWriting || !_pendingWrites.empty(); });
+
+                if (_pendingWrites.empty())
+                    return;
+
+                pendingWrite = std::move(_pendingWrites.front());
+                _pendingWrites.pop_front();
+            }
+
+            writeEntry(pendingWrite);
+        }
+    }
+
+    void DiskImageCache::writeEntry(const PendingWrite& pendingWrite)
+    {
+        const std::span<const std::byte> data{ pendingWrite.image->getData() };
+
+        bool written{};
+        {
+            std::ofstream ofs{ pendingWrite.tmpFilePath, std::ios::out | std::ios::binary | std::ios::trunc };
+            if (ofs)
+                ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+            written = static_cast<bool>(ofs);
+        }
+
+        if (!written)
+            LMS_LOG(COVER, ERROR, "Cannot write disk cache entry " << pendingWrite.tmpFilePath);
+
+        if (_cache.endWrite(pendingWrite.key, pendingWrite.tmpFilePath, written ? std::optional<std::size_t>{ data.size() } : std::nullopt))
+            LMS_LOG(COVER, DEBUG, "Added disk cache entry '" << pendingWrite.key << "', size = " << data.size());
+    }
+} // namespace lms::artwork
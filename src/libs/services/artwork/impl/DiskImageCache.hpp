@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "core/DiskLruCache.hpp"
+#include "database/objects/ArtworkId.hpp"
+#include "image/IEncodedImage.hpp"
+
+namespace lms::artwork
+{
+    // DiskImageCache: 缩放后封面的磁盘缓存（按 ArtworkId、源文件修改时间/大小、尺寸与 JPEG 质量键入），异步写入，按 LRU 限制磁盘占用，重启后保留。
+    // DiskImageCache: дисковый кэш уменьшенных обложек (по ArtworkId, времени изменения/размеру исходного файла, размеру и качеству JPEG), асинхронная запись, ограничение места на диске по LRU, сохраняется после перезапуска.
+    //
+    // Only JPEG thumbnails are stored: originals are cheap enough to read from their source
+    class DiskImageCache
+    {
+    public:
+        DiskImageCache(const std::filesystem::path& directory, std::size_t maxCacheSize);
+        ~DiskImageCache(); // pending writes are completed
+        DiskImageCache(const DiskImageCache&) = delete;
+        DiskImageCache& operator=(const DiskImageCache&) = delete;
+
+        struct EntryDesc
+        {
+            db::ArtworkId artworkId;
+            std::filesystem::path sourceFile; // image file or audio file the image is embedded in
+            std::size_t sourceIndex{};        // index of the embedded image
+            image::ImageSize width{};
+            unsigned jpegQuality{};
+        };
+
+        using Key = core::DiskLruCache::Key;
+
+        // No key if the source file cannot be accessed
+        static std::optional<Key> computeKey(const EntryDesc& entryDesc);
+
+        std::shared_ptr<image::IEncodedImage> getImage(const Key& key);
+        void addImage(const Key& key, std::shared_ptr<image::IEncodedImage> image); // written in background, may be dropped if too many writes are pending
+
+    private:
+        struct PendingWrite
+        {
+            Key key;
+            std::filesystem::path tmpFilePath;
+            std::shared_ptr<image::IEncodedImage> image;
+        };
+
+        void processWrites();
+        void writeEntry(const PendingWrite& pendingWrite);
+
+        static constexpr std::size_t _maxPendingWriteCount{ 256 };
+
+        core::DiskLruCache _cache;
+
+        std::mutex _mutex;
+        std::condition_variable _writeCondVar;
+        std::deque<PendingWrite> _pendingWrites;
+        bool _stopWriting{};
+        std::thread _writerThread;
+    };
+} // namespace lms::artwork
@@ -1,62 +1,235 @@
-
 #include "ImageCache.hpp"
 
-#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <iterator>
 
 #include "core/ILogger.hpp"
-#include "core/Random.hpp"
 
 namespace lms::artwork
 {
-    ImageCache::ImageCache(std::size_t maxCacheSize)
-        : _maxCacheSize{ maxCacheSize }
+    namespace
+    {
+        // splitmix64 finalizer
+        std::uint64_t mix(std::uint64_t value)
+        {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return value;
+        }
+    } // namespace
+
+    void ImageCache::FrequencySketch::record(std::uint64_t hash)
+    {
+        for (std::size_t row{}; row < _depth; ++row)
+        {
+            std::uint8_t& counter{ _counters[row][mix(hash + row * 0x9e3779b97f4a7c15ULL) % _width] };
+            if (counter < 15)
+                counter++;
+        }
+
+        if (++_recordCount >= _samplingPeriod)
+        {
+            for (auto& counters : _counters)
+            {
+                for (std::uint8_t& counter : counters)
+                    counter /= 2;
+            }
+            _recordCount /= 2;
+        }
+    }
+
+    unsigned ImageCache::FrequencySketch::estimate(std::uint64_t hash) const
+    {
+        unsigned res{ 15 };
+        for (std::size_t row{}; row < _depth; ++row)
+            res = std::min<unsigned>(res, _counters[row][mix(hash + row * 0x9e3779b97f4a7c15ULL) % _width]);
+
+        return res;
+    }
+
+    void ImageCache::FrequencySketch::clear()
+    {
+        _counters = {};
+        _recordCount = 0;
+    }
+
+    std::size_t ImageCache::EntryHasher::operator()(const EntryDesc& entry) const
+    {
+        // well mixed, as low bits select the shard
+        const std::uint64_t idHash{ std::hash<db::ArtworkId>{}(entry.id) };
+        const std::uint64_t sizeHash{ entry.size ? *entry.size + 1 : 0 };
+        return mix(idHash ^ mix(sizeHash));
+    }
+
+    ImageCache::ImageCache(const Parameters& parameters)
+        : _maxCacheSize{ parameters.maxCacheSize }
+        , _shardCount{ std::clamp<std::size_t>(parameters.maxCacheSize / _minShardSize, 1, _maxShardCount) }
+        , _maxShardSize{ parameters.maxCacheSize / _shardCount }
+        , _maxShardProtectedSize{ _maxShardSize * 4 / 5 }
+        , _maxOriginalImageSize{ parameters.maxOriginalImageSize }
+        , _enableAdmissionFilter{ parameters.enableAdmissionFilter }
+        , _shards(_shardCount)
     {
     }
 
     void ImageCache::addImage(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image)
     {
-        if (!entryDesc.size)
+        const std::size_t size{ image->getData().size() };
+        if (!entryDesc.size && size > _maxOriginalImageSize)
+            return;
+
+        if (size > _maxShardSize)
             return;
 
-        const std::unique_lock lock{ _mutex };
+        Shard& shard{ getShard(EntryHasher{}(entryDesc)) };
+        const std::scoped_lock lock{ shard.mutex };
+
+        // the same image may have been computed concurrently
+        if (const auto itEntry{ shard.entries.find(entryDesc) }; itEntry != std::cend(shard.entries))
+            removeEntry(shard, itEntry->second);
 
-        while (_cacheSize + image->getData().size() > _maxCacheSize && !_cache.empty())
+        if (!makeRoom(shard, entryDesc, size))
         {
-            auto itRandom{ core::random::pickRandom(_cache) };
-            _cacheSize -= itRandom->second->getData().size();
-            _cache.erase(itRandom);
+            shard.rejections++;
+            return;
         }
 
-        _cacheSize += image->getData().size();
-        _cache[entryDesc] = image;
+        shard.probationEntries.push_front(Entry{ .desc = entryDesc, .image = std::move(image), .isProtected = false });
+        shard.entries.emplace(entryDesc, std::begin(shard.probationEntries));
+        shard.probationSize += size;
     }
 
-    std::shared_ptr<image::IEncodedImage> ImageCache::getImage(const EntryDesc& entryDesc) const
+    std::shared_ptr<image::IEncodedImage> ImageCache::getImage(const EntryDesc& entryDesc)
     {
-        if (!entryDesc.size)
-            return {};
+        if (!entryDesc.size && _maxOriginalImageSize == 0)
+            return nullptr;
 
-        const std::shared_lock lock{ _mutex };
+        const std::size_t hash{ EntryHasher{}(entryDesc) };
+        Shard& shard{ getShard(hash) };
+        const std::scoped_lock lock{ shard.mutex };
 
-        const auto it{ _cache.find(entryDesc) };
-        if (it == std::cend(_cache))
+        if (_enableAdmissionFilter)
+            shard.frequencySketch.record(hash);
+
+        const auto itEntry{ shard.entries.find(entryDesc) };
+        if (itEntry == std::cend(shard.entries))
         {
-            ++_cacheMisses;
+            shard.misses++;
             return nullptr;
         }
 
-        ++_cacheHits;
-        return it->second;
+        shard.hits++;
+        promote(shard, itEntry->second);
+
+        return itEntry->second->image;
     }
 
     void ImageCache::flush()
     {
-        const std::unique_lock lock{ _mutex };
+        const IArtworkService::CacheStats stats{ getStats() };
+        LMS_LOG(COVER, DEBUG, "Cache stats: hits = " << stats.hits << ", misses = " << stats.misses << ", evictions = " << stats.evictions << ", rejections = " << stats.rejections << ", nb entries = " << stats.entryCount << ", size = " << stats.size);
+
+        for (Shard& shard : _shards)
+        {
+            const std::scoped_lock lock{ shard.mutex };
+
+            shard.entries.clear();
+            shard.probationEntries.clear();
+            shard.protectedEntries.clear();
+            shard.probationSize = 0;
+            shard.protectedSize = 0;
+            shard.frequencySketch.clear();
+        }
+    }
+
+    IArtworkService::CacheStats ImageCache::getStats() const
+    {
+        IArtworkService::CacheStats stats;
+        stats.maxSize = _maxCacheSize;
+
+        for (const Shard& shard : _shards)
+        {
+            const std::scoped_lock lock{ shard.mutex };
+
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.rejections += shard.rejections;
+            stats.entryCount += shard.entries.size();
+            stats.size += shard.probationSize + shard.protectedSize;
+        }
+
+        return stats;
+    }
+
+    void ImageCache::promote(Shard& shard, Entries::iterator itEntry)
+    {
+        if (itEntry->isProtected)
+        {
+            shard.protectedEntries.splice(std::begin(shard.protectedEntries), shard.protectedEntries, itEntry);
+            return;
+        }
+
+        const std::size_t size{ itEntry->getSize() };
+        shard.protectedEntries.splice(std::begin(shard.protectedEntries), shard.probationEntries, itEntry);
+        itEntry->isProtected = true;
+        shard.probationSize -= size;
+        shard.protectedSize += size;
+
+        // demoted entries get another chance in the probation segment
+        while (shard.protectedSize > _maxShardProtectedSize && shard.protectedEntries.size() > 1)
+        {
+            const Entries::iterator itDemotedEntry{ std::prev(std::end(shard.protectedEntries)) };
+            const std::size_t demotedSize{ itDemotedEntry->getSize() };
+
+            shard.probationEntries.splice(std::begin(shard.probationEntries), shard.protectedEntries, itDemotedEntry);
+            itDemotedEntry->isProtected = false;
+            shard.protectedSize -= demotedSize;
+            shard.probationSize += demotedSize;
+        }
+    }
+
+    bool ImageCache::makeRoom(Shard& shard, const EntryDesc& entryDesc, std::size_t size)
+    {
+        bool admissionChecked{};
+        while (shard.probationSize + shard.protectedSize + size > _maxShardSize)
+        {
+            Entries& victims{ !shard.probationEntries.empty() ? shard.probationEntries : shard.protectedEntries };
+            const Entries::iterator itVictim{ std::prev(std::end(victims)) };
+
+            // Only the first victim is challenged
+            if (_enableAdmissionFilter && !admissionChecked)
+            {
+                admissionChecked = true;
+                if (shard.frequencySketch.estimate(EntryHasher{}(entryDesc)) <= shard.frequencySketch.estimate(EntryHasher{}(itVictim->desc)))
+                    return false;
+            }
+
+            removeEntry(shard, itVictim);
+            shard.evictions++;
+        }
 
-        LMS_LOG(COVER, DEBUG, "Cache stats: hits = " << _cacheHits.load() << ", misses = " << _cacheMisses.load() << ", nb entries = " << _cache.size() << ", size = " << _cacheSize);
-        _cacheHits = 0;
-        _cacheMisses = 0;
-        _cacheSize = 0;
-        _cache.clear();
+        return true;
+    }
+
+    void ImageCache::removeEntry(Shard& shard, Entries::iterator itEntry)
+    {
+        const std::size_t size{ itEntry->getSize() };
+        shard.entries.erase(itEntry->desc);
+
+        if (itEntry->isProtected)
+        {
+            shard.protectedSize -= size;
+            shard.protectedEntries.erase(itEntry);
+        }
+        else
+        {
+            shard.probationSize -= size;
+            shard.probationEntries.erase(itEntry);
+        }
     }
-} // namespace lms::artwork
\ No newline at end of file
+} // namespace lms::artwork
@@ -1,29 +1,44 @@
-
 #pragma once
 
-#include <atomic>
-#include <cassert>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
-#include <shared_mutex>
 #include <unordered_map>
+#include <vector>
 
 #include "database/objects/ArtworkId.hpp"
 #include "image/IEncodedImage.hpp"
+#include "services/artwork/IArtworkService.hpp"
 
 namespace lms::artwork
 {
-    // ImageCache: 封面图缓存（按 ArtworkId + 尺寸键入），限制最大内存占用。
-    // ImageCache: кэш картинок по ArtworkId и размеру, ограничивает использование памяти.
+    // ImageCache: 封面图缓存（按 ArtworkId + 尺寸键入），分段 LRU 淘汰、分片加锁，可选 TinyLFU 准入过滤，限制最大内存占用。
+    // ImageCache: кэш картинок по ArtworkId и размеру, сегментированный LRU, шардированные блокировки, опциональный фильтр допуска TinyLFU, ограничивает использование памяти.
+    //
+    // Entries first land in a probation segment, and are promoted to the protected segment when hit again:
+    // one-off lookups cannot evict the images that are repeatedly requested
     class ImageCache
     {
     public:
-        ImageCache(std::size_t maxCacheSize);
+        struct Parameters
+        {
+            std::size_t maxCacheSize{};
+            std::size_t maxOriginalImageSize{}; // unresized images are only cached below this size
+            bool enableAdmissionFilter{};       // new entries must have been requested more often than the ones they evict
+        };
+
+        ImageCache(const Parameters& parameters);
+        ImageCache(const ImageCache&) = delete;
+        ImageCache& operator=(const ImageCache&) = delete;
 
         struct EntryDesc
         {
             db::ArtworkId id;
-            std::optional<std::size_t> size;
+            std::optional<std::size_t> size; // no size for original images
 
             bool operator==(const EntryDesc& other) const = default;
         };
@@ -31,26 +46,76 @@ namespace lms::artwork
         std::size_t getMaxCacheSize() const { return _maxCacheSize; }
 
         void addImage(const EntryDesc& entryDesc, std::shared_ptr<image::IEncodedImage> image);
-        std::shared_ptr<image::IEncodedImage> getImage(const EntryDesc& entryDesc) const;
+        std::shared_ptr<image::IEncodedImage> getImage(const EntryDesc& entryDesc);
         void flush();
 
+        IArtworkService::CacheStats getStats() const;
+
     private:
-        const std::size_t _maxCacheSize;
+        // Count-min sketch of the recent request frequencies, periodically halved so that old hits fade away
+        class FrequencySketch
+        {
+        public:
+            void record(std::uint64_t hash);
+            unsigned estimate(std::uint64_t hash) const;
+            void clear();
+
+        private:
+            static constexpr std::size_t _depth{ 4 };
+            static constexpr std::size_t _width{ 1024 };
+            static constexpr std::size_t _samplingPeriod{ 10 * _width };
 
-        mutable std::shared_mutex _mutex;
+            std::array<std::array<std::uint8_t, _width>, _depth> _counters{};
+            std::size_t _recordCount{};
+        };
 
         struct EntryHasher
         {
-            std::size_t operator()(const EntryDesc& entry) const
-            {
-                assert(entry.size); // 只缓存已缩放的图片 / кэшируем только изменённые по размеру изображения
-                return std::hash<db::ArtworkId>{}(entry.id) ^ std::hash<std::size_t>{}(*entry.size);
-            }
+            std::size_t operator()(const EntryDesc& entry) const;
         };
 
-        std::unordered_map<EntryDesc, std::shared_ptr<image::IEncodedImage>, EntryHasher> _cache;
-        std::size_t _cacheSize{};
-        mutable std::atomic<std::size_t> _cacheMisses;
-        mutable std::atomic<std::size_t> _cacheHits;
+        struct Entry
+        {
+            EntryDesc desc;
+            std::shared_ptr<image::IEncodedImage> image;
+            bool isProtected{};
+
+            std::size_t getSize() const { return image->getData().size(); }
+        };
+        using Entries = std::list<Entry>; // most recently used first
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            Entries probationEntries;
+            Entries protectedEntries;
+            std::unordered_map<EntryDesc, Entries::iterator, EntryHasher> entries;
+            std::size_t probationSize{};
+            std::size_t protectedSize{};
+            FrequencySketch frequencySketch;
+
+            std::size_t hits{};
+            std::size_t misses{};
+            std::size_t evictions{};
+            std::size_t rejections{};
+        };
+
+        Shard& getShard(std::size_t hash) { return _shards[hash % _shardCount]; }
+        void promote(Shard& shard, Entries::iterator itEntry);
+        bool makeRoom(Shard& shard, const EntryDesc& entryDesc, std::size_t size); // false if the entry must not be admitted
+        void removeEntry(Shard& shard, Entries::iterator itEntry);
+
+        // Shards are kept big enough to hold large images: small budgets use fewer shards
+        static constexpr std::size_t _maxShardCount{ 16 };
+        static constexpr std::size_t _minShardSize{ 2 * 1000 * 1000 };
+
+        const std::size_t _maxCacheSize;
+        const std::size_t _shardCount;
+        const std::size_t _maxShardSize;
+        const std::size_t _maxShardProtectedSize;
+        const std::size_t _maxOriginalImageSize;
+        const bool _enableAdmissionFilter;
+
+        std::vector<Shard> _shards;
     };
-} // namespace lms::artwork
\ No newline at end of file
+} // namespace lms::artwork
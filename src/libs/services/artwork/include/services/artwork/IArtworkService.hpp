@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -38,9 +39,23 @@ namespace lms::artwork
 
         virtual void flushCache() = 0;
 
+        // 内存缓存统计（累计值，flush 后不清零）。
+        // Статистика кэша в памяти (накопительная, не сбрасывается при flush).
+        struct CacheStats
+        {
+            std::size_t hits{};
+            std::size_t misses{};
+            std::size_t evictions{};
+            std::size_t rejections{}; // not admitted by the admission filter
+            std::size_t entryCount{};
+            std::size_t size{};
+            std::size_t maxSize{};
+        };
+        virtual CacheStats getCacheStats() const = 0;
+
         virtual void setJpegQuality(unsigned quality) = 0; // 1–100 的 JPEG 输出质量 / качество JPEG в диапазоне 1–100
     };
 
-    std::unique_ptr<IArtworkService> createArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath);
+    std::unique_ptr<IArtworkService> createArtworkService(db::IDb& db, const std::filesystem::path& defaultReleaseCoverSvgPath, const std::filesystem::path& defaultArtistImageSvgPath, const std::filesystem::path& cachePath);
 
 } // namespace lms::artwork
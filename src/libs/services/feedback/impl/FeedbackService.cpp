@@ -72,6 +72,14 @@ namespace lms::feedback
         return getStarredDateTime<Artist, ArtistId, StarredArtist>(userId, artistId);
     }
 
+    void FeedbackService::getStarredArtistDateTimes(UserId userId, const std::function<void(ArtistId artistId, const Wt::WDateTime& dateTime)>& func)
+    {
+        Session& session{ _db.getTLSSession() };
+        auto transaction{ session.createReadTransaction() };
+
+        StarredArtist::find(session, userId, func);
+    }
+
     FeedbackService::ArtistContainer FeedbackService::findStarredArtists(const ArtistFindParameters& params)
     {
         auto backend{ getUserFeedbackBackend(params.user) };
@@ -102,6 +110,14 @@ namespace lms::feedback
         return getRating<Artist, ArtistId, RatedArtist>(userId, artistId);
     }
 
+    void FeedbackService::getArtistRatings(db::UserId userId, const std::function<void(db::ArtistId artistId, db::Rating rating)>& func)
+    {
+        Session& session{ _db.getTLSSession() };
+        auto transaction{ session.createReadTransaction() };
+
+        RatedArtist::find(session, userId, func);
+    }
+
     void FeedbackService::star(UserId userId, ReleaseId releaseId)
     {
         star<Release, ReleaseId, StarredRelease>(userId, releaseId);
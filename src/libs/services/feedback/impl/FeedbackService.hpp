@@ -28,10 +28,12 @@ namespace lms::feedback
         void unstar(db::UserId userId, db::ArtistId artistId) override;
         bool isStarred(db::UserId userId, db::ArtistId artistId) override;
         Wt::WDateTime getStarredDateTime(db::UserId userId, db::ArtistId artistId) override;
+        void getStarredArtistDateTimes(db::UserId userId, const std::function<void(db::ArtistId artistId, const Wt::WDateTime& dateTime)>& func) override;
         ArtistContainer findStarredArtists(const ArtistFindParameters& params) override;
 
         void setRating(db::UserId userId, db::ArtistId artistId, std::optional<db::Rating> rating) override;
         std::optional<db::Rating> getRating(db::UserId userId, db::ArtistId artistId) override;
+        void getArtistRatings(db::UserId userId, const std::function<void(db::ArtistId artistId, db::Rating rating)>& func) override;
 
         void star(db::UserId userId, db::ReleaseId releaseId) override;
         void unstar(db::UserId userId, db::ReleaseId releaseId) override;
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
 
@@ -81,10 +82,12 @@ namespace lms::feedback
         virtual void unstar(db::UserId userId, db::ArtistId artistId) = 0;
         virtual bool isStarred(db::UserId userId, db::ArtistId artistId) = 0;
         virtual Wt::WDateTime getStarredDateTime(db::UserId userId, db::ArtistId artistId) = 0;
+        virtual void getStarredArtistDateTimes(db::UserId userId, const std::function<void(db::ArtistId artistId, const Wt::WDateTime& dateTime)>& func) = 0; // all at once
         virtual ArtistContainer findStarredArtists(const ArtistFindParameters& params) = 0;
 
         virtual void setRating(db::UserId userId, db::ArtistId artistId, std::optional<db::Rating> rating) = 0;
         virtual std::optional<db::Rating> getRating(db::UserId userId, db::ArtistId artistId) = 0;
+        virtual void getArtistRatings(db::UserId userId, const std::function<void(db::ArtistId artistId, db::Rating rating)>& func) = 0; // all at once
 
         // Releases
         virtual void star(db::UserId userId, db::ReleaseId releaseId) = 0;
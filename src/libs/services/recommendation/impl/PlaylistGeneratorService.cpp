@@ -2,6 +2,8 @@
 #include "PlaylistGeneratorService.hpp"
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
 
 #include "core/ILogger.hpp"
 #include "database/IDb.hpp"
@@ -26,54 +28,105 @@ namespace lms::recommendation
         : _db{ db }
         , _recommendationService{ recommendationService }
     {
-        _constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveArtists>(_db));
-        _constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveReleases>(_db));
+        _constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveArtists>());
+        _constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::ConsecutiveReleases>());
         _constraints.push_back(std::make_unique<PlaylistGeneratorConstraint::DuplicateTracks>());
     }
 
     std::vector<TrackId> PlaylistGeneratorService::extendPlaylist(TrackListId tracklistId, std::size_t maxCount) const
     {
+        using namespace PlaylistGeneratorConstraint;
+
         LMS_LOG(RECOMMENDATION, DEBUG, "Requested to extend playlist by " << maxCount << " similar tracks");
 
         // supposed to be ordered from most similar to least similar
-        std::vector<TrackId> similarTracks{ _recommendationService.findSimilarTracks(tracklistId, maxCount * 2) }; // ask for more tracks than we need as it will be easier to respect constraints
+        const std::vector<TrackId> similarTracks{ _recommendationService.findSimilarTracks(tracklistId, maxCount * 2) }; // ask for more tracks than we need as it will be easier to respect constraints
 
         const std::vector<TrackId> startingTracks{ getTracksFromTrackList(tracklistId) };
 
+        // all the metadata used by the constraints, loaded at once
+        // whole playlist constraints only compare track ids: only the end of the starting tracks can be looked at
+        std::size_t maxDistance{};
+        for (const auto& constraint : _constraints)
+            maxDistance = std::max(maxDistance, constraint->getMaxDistance().value_or(0));
+
+        std::vector<TrackId> snapshotTrackIds(std::prev(std::cend(startingTracks), std::min(maxDistance, startingTracks.size())), std::cend(startingTracks));
+        snapshotTrackIds.insert(std::end(snapshotTrackIds), std::cbegin(similarTracks), std::cend(similarTracks));
+        const TrackMetadataSnapshot snapshot{ _db.getTLSSession(), snapshotTrackIds };
+
         std::vector<TrackId> finalResult = startingTracks;
         finalResult.reserve(startingTracks.size() + maxCount);
 
-        std::vector<float> scores;
-        for (std::size_t i{}; i < maxCount; ++i)
+        // Scores against the whole playlist are accumulated as tracks are appended:
+        // for each candidate, only the tracks at the end of the playlist have then to be evaluated
+        struct Candidate
         {
-            if (similarTracks.empty())
-                break;
+            TrackId trackId;
+            float wholePlaylistScore{};
+        };
 
-            scores.resize(similarTracks.size(), {});
+        auto computeWholePlaylistScore{ [&](TrackId candidateId, TrackId trackId, std::size_t distance) {
+            float score{};
+            for (const auto& constraint : _constraints)
+            {
+                if (!constraint->getMaxDistance())
+                    score += constraint->computeScore(snapshot, candidateId, trackId, distance);
+            }
+            return score;
+        } };
 
-            // select the similar track that has the best score
-            for (std::size_t trackIndex{}; trackIndex < similarTracks.size(); ++trackIndex)
+        auto computeScore{ [&](const Candidate& candidate) {
+            float score{ candidate.wholePlaylistScore };
+            for (const auto& constraint : _constraints)
             {
-                using namespace db::Debug;
+                const std::optional<std::size_t> maxDistance{ constraint->getMaxDistance() };
+                if (!maxDistance)
+                    continue;
 
-                finalResult.push_back(similarTracks[trackIndex]);
+                // candidate placed at the end of the playlist
+                for (std::size_t distance{ 1 }; distance <= std::min(*maxDistance, finalResult.size()); ++distance)
+                    score += constraint->computeScore(snapshot, candidate.trackId, finalResult[finalResult.size() - distance], distance);
+            }
+            return score;
+        } };
 
-                scores[trackIndex] = 0;
-                for (const auto& constraint : _constraints)
-                    scores[trackIndex] += constraint->computeScore(finalResult, finalResult.size() - 1);
+        std::vector<Candidate> candidates;
+        candidates.reserve(similarTracks.size());
+        for (const TrackId similarTrackId : similarTracks)
+        {
+            Candidate& candidate{ candidates.emplace_back(Candidate{ .trackId = similarTrackId }) };
+            for (std::size_t i{}; i < finalResult.size(); ++i)
+                candidate.wholePlaylistScore += computeWholePlaylistScore(similarTrackId, finalResult[i], finalResult.size() - i);
+        }
+
+        for (std::size_t i{}; i < maxCount; ++i)
+        {
+            if (candidates.empty())
+                break;
 
-                finalResult.pop_back();
+            // select the similar track that has the best score
+            std::size_t bestScoreIndex{};
+            float bestScore{ std::numeric_limits<float>::max() };
+            for (std::size_t candidateIndex{}; candidateIndex < candidates.size(); ++candidateIndex)
+            {
+                const float score{ computeScore(candidates[candidateIndex]) };
+                if (score < bestScore)
+                {
+                    bestScore = score;
+                    bestScoreIndex = candidateIndex;
+                }
 
                 // early exit if we consider we found a track with no constraint violation (since similarTracks sorted from most to least similar)
-                if (scores[trackIndex] < 0.01)
+                if (score < 0.01)
                     break;
             }
 
-            // get the best score
-            const std::size_t bestScoreIndex{ static_cast<std::size_t>(std::distance(std::cbegin(scores), std::min_element(std::cbegin(scores), std::cend(scores)))) };
+            const TrackId selectedTrackId{ candidates[bestScoreIndex].trackId };
+            candidates.erase(std::begin(candidates) + bestScoreIndex);
+            finalResult.push_back(selectedTrackId);
 
-            finalResult.push_back(similarTracks[bestScoreIndex]);
-            similarTracks.erase(std::begin(similarTracks) + bestScoreIndex);
+            for (Candidate& candidate : candidates)
+                candidate.wholePlaylistScore += computeWholePlaylistScore(candidate.trackId, selectedTrackId, 1);
         }
 
         // for now, just get some more similar tracks
@@ -37,30 +37,33 @@ namespace lms::recommendation
     {
         TrackContainer res;
 
-        if (!_engine)
+        const std::shared_ptr<IEngine> engine{ getEngine() };
+        if (!engine)
             return res;
 
-        return _engine->findSimilarTracksFromTrackList(trackListId, maxCount);
+        return engine->findSimilarTracksFromTrackList(trackListId, maxCount);
     }
 
     TrackContainer RecommendationService::findSimilarTracks(const std::vector<db::TrackId>& trackIds, std::size_t maxCount) const
     {
         TrackContainer res;
 
-        if (!_engine)
+        const std::shared_ptr<IEngine> engine{ getEngine() };
+        if (!engine)
             return res;
 
-        return _engine->findSimilarTracks(trackIds, maxCount);
+        return engine->findSimilarTracks(trackIds, maxCount);
     }
 
     ReleaseContainer RecommendationService::getSimilarReleases(db::ReleaseId releaseId, std::size_t maxCount) const
     {
         ReleaseContainer res;
 
-        if (!_engine)
+        const std::shared_ptr<IEngine> engine{ getEngine() };
+        if (!engine)
             return res;
 
-        return _engine->getSimilarReleases(releaseId, maxCount);
+        return engine->getSimilarReleases(releaseId, maxCount);
         ;
     }
 
@@ -68,10 +71,11 @@ namespace lms::recommendation
     {
         ArtistContainer res;
 
-        if (!_engine)
+        const std::shared_ptr<IEngine> engine{ getEngine() };
+        if (!engine)
             return res;
 
-        return _engine->getSimilarArtists(artistId, linkTypes, maxCount);
+        return engine->getSimilarArtists(artistId, linkTypes, maxCount);
 
         return res;
     }
@@ -80,24 +84,46 @@ namespace lms::recommendation
     {
         using namespace db;
 
+        const std::scoped_lock loadLock{ _loadMutex };
+
         switch (getSimilarityEngineType(_db.getTLSSession()))
         {
         case ScanSettings::SimilarityEngineType::Clusters:
             if (_engineType != EngineType::Clusters)
             {
                 _engineType = EngineType::Clusters;
+
+                const std::scoped_lock lock{ _engineMutex };
                 _engine = createClustersEngine(_db);
             }
             break;
 
         case ScanSettings::SimilarityEngineType::Features:
         case ScanSettings::SimilarityEngineType::None:
-            _engineType.reset();
-            _engine.reset();
+            {
+                _engineType.reset();
+
+                const std::scoped_lock lock{ _engineMutex };
+                _engine.reset();
+            }
             break;
         }
 
-        if (_engine)
-            _engine->load(false);
+        if (const std::shared_ptr<IEngine> engine{ getEngine() })
+            engine->load(false);
+    }
+
+    void RecommendationService::reload()
+    {
+        const std::scoped_lock loadLock{ _loadMutex };
+
+        if (const std::shared_ptr<IEngine> engine{ getEngine() })
+            engine->load(false);
+    }
+
+    std::shared_ptr<IEngine> RecommendationService::getEngine() const
+    {
+        const std::scoped_lock lock{ _engineMutex };
+        return _engine;
     }
 } // namespace lms::recommendation
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <optional>
 
 #include "services/recommendation/IRecommendationService.hpp"
@@ -30,6 +32,7 @@ namespace lms::recommendation
 
     private:
         void load() override;
+        void reload() override;
 
         TrackContainer findSimilarTracks(db::TrackListId tracklistId, std::size_t maxCount) const override;
         TrackContainer findSimilarTracks(const std::vector<db::TrackId>& trackIds, std::size_t maxCount) const override;
@@ -40,9 +43,16 @@ namespace lms::recommendation
         void clearEngines();
         void loadPendingEngine(EngineType engineType, std::unique_ptr<IEngine> engine, bool forceReload, const ProgressCallback& progressCallback);
 
+        std::shared_ptr<IEngine> getEngine() const;
+
         db::IDb& _db;
+
+        std::mutex _loadMutex; // loads are serialized (admin settings change, scan complete)
         std::optional<EngineType> _engineType;
-        std::unique_ptr<IEngine> _engine;
+
+        // queries keep using the engine they got while it is being replaced
+        mutable std::mutex _engineMutex;
+        std::shared_ptr<IEngine> _engine;
     };
 
 } // namespace lms::recommendation
@@ -0,0 +1,289 @@
+
+#include "ClusterIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "core/Random.hpp"
+
+namespace lms::recommendation
+{
+    using namespace db;
+
+    namespace
+    {
+        void writeVarint(std::vector<std::uint8_t>& data, std::uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                data.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            data.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        std::uint64_t readVarint(const std::uint8_t*& data)
+        {
+            std::uint64_t value{};
+            for (unsigned shift{};; shift += 7)
+            {
+                const std::uint8_t byte{ *data++ };
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+
+            return value;
+        }
+
+        // splitmix64 finalizer
+        std::uint64_t mix(std::uint64_t value)
+        {
+            value ^= value >> 30;
+            value *= 0xbf58476d1ce4e5b9ULL;
+            value ^= value >> 27;
+            value *= 0x94d049bb133111ebULL;
+            value ^= value >> 31;
+            return value;
+        }
+
+        template<typename IdType>
+        std::vector<IdType> toIds(const std::vector<typename IdType::ValueType>& values)
+        {
+            std::vector<IdType> res;
+            res.reserve(values.size());
+            std::transform(std::cbegin(values), std::cend(values), std::back_inserter(res), [](typename IdType::ValueType value) { return IdType{ value }; });
+            return res;
+        }
+
+        void addClusterIfNeeded(std::vector<ClusterId>& clusterIds, ClusterId clusterId)
+        {
+            // clusters are processed in order
+            if (clusterIds.empty() || clusterIds.back() != clusterId)
+                clusterIds.push_back(clusterId);
+        }
+    } // namespace
+
+    void ClusterIndex::Builder::addTrackCluster(TrackId trackId, ClusterId clusterId)
+    {
+        _trackClusters.emplace_back(clusterId, trackId);
+    }
+
+    void ClusterIndex::Builder::addTrackRelease(TrackId trackId, ReleaseId releaseId)
+    {
+        _trackReleases.emplace(trackId, releaseId);
+    }
+
+    void ClusterIndex::Builder::addTrackArtist(TrackId trackId, ArtistId artistId, TrackArtistLinkType linkType)
+    {
+        _trackArtists[trackId].emplace_back(artistId, linkType);
+    }
+
+    void ClusterIndex::PostingList::add(IdValue id, std::uint32_t count)
+    {
+        // lowest bit tells if a count follows, so that the common count = 1 case costs nothing
+        const std::uint64_t delta{ static_cast<std::uint64_t>(id - _lastId) };
+        writeVarint(_data, (delta << 1) | (count > 1 ? 1 : 0));
+        if (count > 1)
+            writeVarint(_data, count);
+
+        _lastId = id;
+        _size++;
+    }
+
+    template<typename Func>
+    void ClusterIndex::PostingList::visit(Func&& func) const
+    {
+        const std::uint8_t* data{ _data.data() };
+        const std::uint8_t* const end{ data + _data.size() };
+
+        IdValue id{};
+        while (data != end)
+        {
+            const std::uint64_t value{ readVarint(data) };
+            id += static_cast<IdValue>(value >> 1);
+            const std::uint32_t count{ (value & 1) ? static_cast<std::uint32_t>(readVarint(data)) : 1 };
+
+            func(id, count);
+        }
+    }
+
+    ClusterIndex::ClusterIndex(Builder&& builder, ClusterWeighting weighting)
+    {
+        auto& trackClusters{ builder._trackClusters };
+        std::sort(std::begin(trackClusters), std::end(trackClusters));
+        trackClusters.erase(std::unique(std::begin(trackClusters), std::end(trackClusters)), std::end(trackClusters));
+
+        for (const auto& [clusterId, trackId] : trackClusters)
+            _trackClusters[trackId].push_back(clusterId);
+
+        const float trackCount{ static_cast<float>(_trackClusters.size()) };
+
+        for (auto itBegin{ std::cbegin(trackClusters) }; itBegin != std::cend(trackClusters);)
+        {
+            const ClusterId clusterId{ itBegin->first };
+            const auto itEnd{ std::find_if(itBegin, std::cend(trackClusters), [&](const auto& trackCluster) { return trackCluster.first != clusterId; }) };
+
+            ClusterEntry& entry{ _clusters[clusterId] };
+
+            std::map<IdValue, std::uint32_t> releaseCounts;
+            std::map<std::pair<TrackArtistLinkType, IdValue>, std::uint32_t> artistCounts;
+            for (auto it{ itBegin }; it != itEnd; ++it)
+            {
+                const TrackId trackId{ it->second };
+                entry.tracks.add(trackId.getValue(), 1);
+
+                if (const auto itRelease{ builder._trackReleases.find(trackId) }; itRelease != std::cend(builder._trackReleases))
+                {
+                    releaseCounts[itRelease->second.getValue()]++;
+                    addClusterIfNeeded(_releaseClusters[itRelease->second], clusterId);
+                }
+
+                if (const auto itArtists{ builder._trackArtists.find(trackId) }; itArtists != std::cend(builder._trackArtists))
+                {
+                    for (const auto& [artistId, linkType] : itArtists->second)
+                    {
+                        artistCounts[{ linkType, artistId.getValue() }]++;
+                        addClusterIfNeeded(_artistClusters[artistId], clusterId);
+                    }
+                }
+            }
+
+            for (const auto& [releaseId, count] : releaseCounts)
+                entry.releases.add(releaseId, count);
+
+            for (const auto& [artist, count] : artistCounts)
+            {
+                const auto& [linkType, artistId]{ artist };
+                if (entry.artistsByLinkType.empty() || entry.artistsByLinkType.back().first != linkType)
+                    entry.artistsByLinkType.emplace_back(linkType, PostingList{});
+
+                entry.artistsByLinkType.back().second.add(artistId, count);
+            }
+
+            if (weighting == ClusterWeighting::InverseDocumentFrequency)
+                entry.weight = std::log(1.f + trackCount / static_cast<float>(entry.tracks.size()));
+
+            itBegin = itEnd;
+        }
+    }
+
+    ClusterIndex::~ClusterIndex() = default;
+
+    template<typename VisitPostingLists>
+    void ClusterIndex::accumulateScores(std::span<const ClusterId> clusterIds, VisitPostingLists&& visitPostingLists, Scores& scores) const
+    {
+        for (const ClusterId clusterId : clusterIds)
+        {
+            const auto it{ _clusters.find(clusterId) };
+            if (it == std::cend(_clusters))
+                continue;
+
+            const ClusterEntry& entry{ it->second };
+            visitPostingLists(entry, [&](const PostingList& postingList) {
+                postingList.visit([&](IdValue id, std::uint32_t count) {
+                    scores[id] += entry.weight * static_cast<float>(count);
+                });
+            });
+        }
+    }
+
+    std::vector<ClusterIndex::IdValue> ClusterIndex::selectBestScores(const Scores& scores, std::size_t maxCount)
+    {
+        struct Candidate
+        {
+            float score;
+            std::uint64_t tieBreaker;
+            IdValue id;
+        };
+
+        // random order for equal scores, consistent within this call
+        const std::uint64_t salt{ core::random::getRandGenerator()() };
+        auto isBetter{ [](const Candidate& lhs, const Candidate& rhs) {
+            if (lhs.score != rhs.score)
+                return lhs.score > rhs.score;
+            return lhs.tieBreaker > rhs.tieBreaker;
+        } };
+
+        // bounded heap, the worst kept candidate on top
+        std::vector<Candidate> candidates;
+        candidates.reserve(std::min(maxCount, scores.size()));
+        for (const auto& [id, score] : scores)
+        {
+            const Candidate candidate{ .score = score, .tieBreaker = mix(static_cast<std::uint64_t>(id) ^ salt), .id = id };
+
+            if (candidates.size() < maxCount)
+            {
+                candidates.push_back(candidate);
+                std::push_heap(std::begin(candidates), std::end(candidates), isBetter);
+            }
+            else if (!candidates.empty() && isBetter(candidate, candidates.front()))
+            {
+                std::pop_heap(std::begin(candidates), std::end(candidates), isBetter);
+                candidates.back() = candidate;
+                std::push_heap(std::begin(candidates), std::end(candidates), isBetter);
+            }
+        }
+        std::sort_heap(std::begin(candidates), std::end(candidates), isBetter);
+
+        std::vector<IdValue> res;
+        res.reserve(candidates.size());
+        std::transform(std::cbegin(candidates), std::cend(candidates), std::back_inserter(res), [](const Candidate& candidate) { return candidate.id; });
+        return res;
+    }
+
+    std::vector<TrackId> ClusterIndex::findSimilarTracks(std::span<const TrackId> trackIds, std::size_t maxCount) const
+    {
+        std::vector<ClusterId> clusterIds;
+        for (const TrackId trackId : trackIds)
+        {
+            if (const auto it{ _trackClusters.find(trackId) }; it != std::cend(_trackClusters))
+                clusterIds.insert(std::end(clusterIds), std::cbegin(it->second), std::cend(it->second));
+        }
+        std::sort(std::begin(clusterIds), std::end(clusterIds));
+        clusterIds.erase(std::unique(std::begin(clusterIds), std::end(clusterIds)), std::end(clusterIds));
+
+        Scores scores;
+        accumulateScores(clusterIds, [](const ClusterEntry& entry, auto&& visitPostingList) { visitPostingList(entry.tracks); }, scores);
+
+        for (const TrackId trackId : trackIds)
+            scores.erase(trackId.getValue());
+
+        return toIds<TrackId>(selectBestScores(scores, maxCount));
+    }
+
+    std::vector<ReleaseId> ClusterIndex::findSimilarReleases(ReleaseId releaseId, std::size_t maxCount) const
+    {
+        const auto it{ _releaseClusters.find(releaseId) };
+        if (it == std::cend(_releaseClusters))
+            return {};
+
+        Scores scores;
+        accumulateScores(it->second, [](const ClusterEntry& entry, auto&& visitPostingList) { visitPostingList(entry.releases); }, scores);
+        scores.erase(releaseId.getValue());
+
+        return toIds<ReleaseId>(selectBestScores(scores, maxCount));
+    }
+
+    std::vector<ArtistId> ClusterIndex::findSimilarArtists(ArtistId artistId, core::EnumSet<TrackArtistLinkType> linkTypes, std::size_t maxCount) const
+    {
+        const auto it{ _artistClusters.find(artistId) };
+        if (it == std::cend(_artistClusters))
+            return {};
+
+        Scores scores;
+        accumulateScores(
+            it->second, [&](const ClusterEntry& entry, auto&& visitPostingList) {
+                for (const auto& [linkType, postingList] : entry.artistsByLinkType)
+                {
+                    if (linkTypes.empty() || linkTypes.contains(linkType))
+                        visitPostingList(postingList);
+                }
+            },
+            scores);
+        scores.erase(artistId.getValue());
+
+        return toIds<ArtistId>(selectBestScores(scores, maxCount));
+    }
+} // namespace lms::recommendation
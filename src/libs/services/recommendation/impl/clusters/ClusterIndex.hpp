@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/EnumSet.hpp"
+#include "database/Types.hpp"
+#include "database/objects/ArtistId.hpp"
+#include "database/objects/ClusterId.hpp"
+#include "database/objects/ReleaseId.hpp"
+#include "database/objects/TrackId.hpp"
+
+namespace lms::recommendation
+{
+    enum class ClusterWeighting
+    {
+        None,                     // score = number of shared (track, cluster) pairs, like the database queries
+        InverseDocumentFrequency, // clusters shared by many tracks (huge genres...) count less
+    };
+
+    // ClusterIndex: 常驻内存的聚类倒排索引（聚类 → 压缩的有序曲目/专辑/艺人 ID 列表），用于快速计算相似度并选出得分最高的结果。
+    // ClusterIndex: инвертированный индекс кластеров в памяти (кластер → сжатые упорядоченные списки id треков/релизов/артистов) для быстрого поиска похожих объектов.
+    //
+    // Immutable once built: rebuild it to take changes into account
+    class ClusterIndex
+    {
+    public:
+        class Builder
+        {
+        public:
+            void addTrackCluster(db::TrackId trackId, db::ClusterId clusterId);
+            void addTrackRelease(db::TrackId trackId, db::ReleaseId releaseId);
+            void addTrackArtist(db::TrackId trackId, db::ArtistId artistId, db::TrackArtistLinkType linkType);
+
+        private:
+            friend class ClusterIndex;
+
+            std::vector<std::pair<db::ClusterId, db::TrackId>> _trackClusters;
+            std::unordered_map<db::TrackId, db::ReleaseId> _trackReleases;
+            std::unordered_map<db::TrackId, std::vector<std::pair<db::ArtistId, db::TrackArtistLinkType>>> _trackArtists;
+        };
+
+        ClusterIndex(Builder&& builder, ClusterWeighting weighting);
+        ~ClusterIndex();
+        ClusterIndex(const ClusterIndex&) = delete;
+        ClusterIndex& operator=(const ClusterIndex&) = delete;
+
+        std::size_t getTrackCount() const { return _trackClusters.size(); }
+        std::size_t getClusterCount() const { return _clusters.size(); }
+
+        // Results are sorted by decreasing score, ties are randomly ordered
+        std::vector<db::TrackId> findSimilarTracks(std::span<const db::TrackId> trackIds, std::size_t maxCount) const;
+        std::vector<db::ReleaseId> findSimilarReleases(db::ReleaseId releaseId, std::size_t maxCount) const;
+        std::vector<db::ArtistId> findSimilarArtists(db::ArtistId artistId, core::EnumSet<db::TrackArtistLinkType> linkTypes, std::size_t maxCount) const;
+
+    private:
+        using IdValue = db::IdType::ValueType;
+
+        // Sorted ids, delta + varint encoded, each with an occurrence count
+        class PostingList
+        {
+        public:
+            void add(IdValue id, std::uint32_t count); // ids must be added in increasing order
+
+            std::size_t size() const { return _size; }
+
+            template<typename Func>
+            void visit(Func&& func) const;
+
+        private:
+            std::vector<std::uint8_t> _data;
+            IdValue _lastId{};
+            std::size_t _size{};
+        };
+
+        struct ClusterEntry
+        {
+            float weight{ 1 };
+            PostingList tracks;
+            PostingList releases;                                                           // count = number of tracks of the release in the cluster
+            std::vector<std::pair<db::TrackArtistLinkType, PostingList>> artistsByLinkType; // count = number of links of the artist in the cluster
+        };
+
+        using Scores = std::unordered_map<IdValue, float>;
+        template<typename VisitPostingLists>
+        void accumulateScores(std::span<const db::ClusterId> clusterIds, VisitPostingLists&& visitPostingLists, Scores& scores) const;
+        static std::vector<IdValue> selectBestScores(const Scores& scores, std::size_t maxCount);
+
+        std::unordered_map<db::ClusterId, ClusterEntry> _clusters;
+        std::unordered_map<db::TrackId, std::vector<db::ClusterId>> _trackClusters;     // sorted
+        std::unordered_map<db::ReleaseId, std::vector<db::ClusterId>> _releaseClusters; // sorted
+        std::unordered_map<db::ArtistId, std::vector<db::ClusterId>> _artistClusters;   // sorted, all link types
+    };
+} // namespace lms::recommendation
@@ -1,28 +1,121 @@
 
 #include "ClustersEngine.hpp"
 
+#include <algorithm>
+
+#include "core/IConfig.hpp"
+#include "core/ILogger.hpp"
+#include "core/Service.hpp"
 #include "database/IDb.hpp"
 #include "database/Session.hpp"
 #include "database/objects/Artist.hpp"
 #include "database/objects/Cluster.hpp"
 #include "database/objects/Release.hpp"
 #include "database/objects/Track.hpp"
+#include "database/objects/TrackArtistLink.hpp"
 #include "database/objects/TrackList.hpp"
 
 namespace lms::recommendation
 {
     using namespace db;
 
+    namespace
+    {
+        ClusterWeighting getClusterWeightingFromConfig()
+        {
+            return core::Service<core::IConfig>::get()->getBool("recommendation-clusters-idf-weighting", false) ? ClusterWeighting::InverseDocumentFrequency : ClusterWeighting::None;
+        }
+    } // namespace
+
     std::unique_ptr<IEngine> createClustersEngine(db::IDb& db)
     {
         return std::make_unique<ClusterEngine>(db);
     }
 
+    void ClusterEngine::load(bool /*forceReload*/, const ProgressCallback& progressCallback)
+    {
+        // Cheap enough to be fully rebuilt each time the database may have changed
+        _loadCancelled = false;
+
+        LMS_LOG(RECOMMENDATION, INFO, "Building cluster index...");
+        std::unique_ptr<ClusterIndex> index{ buildIndex(progressCallback) };
+        if (!index)
+        {
+            LMS_LOG(RECOMMENDATION, DEBUG, "Cluster index build cancelled");
+            return;
+        }
+        LMS_LOG(RECOMMENDATION, INFO, "Cluster index built: " << index->getTrackCount() << " tracks, " << index->getClusterCount() << " clusters");
+
+        const std::scoped_lock lock{ _indexMutex };
+        _index = std::move(index);
+    }
+
+    void ClusterEngine::requestCancelLoad()
+    {
+        LMS_LOG(RECOMMENDATION, DEBUG, "Requesting load cancellation");
+        _loadCancelled = true;
+    }
+
+    std::unique_ptr<ClusterIndex> ClusterEngine::buildIndex(const ProgressCallback& progressCallback)
+    {
+        constexpr std::size_t readBatchSize{ 1'000 };
+
+        const ClusterWeighting weighting{ getClusterWeightingFromConfig() };
+        Session& dbSession{ _db.getTLSSession() };
+
+        Progress progress;
+        {
+            auto transaction{ dbSession.createReadTransaction() };
+            progress.totalElems = Track::getCount(dbSession);
+        }
+
+        ClusterIndex::Builder builder;
+        TrackId lastRetrievedTrackId;
+        while (true)
+        {
+            if (_loadCancelled)
+                return {};
+
+            auto transaction{ dbSession.createReadTransaction() };
+
+            const IdRange<TrackId> trackIdRange{ Track::findNextIdRange(dbSession, lastRetrievedTrackId, readBatchSize) };
+            if (!trackIdRange.isValid())
+                break;
+
+            lastRetrievedTrackId = trackIdRange.last;
+
+            Track::findClusterIds(dbSession, trackIdRange, [&](TrackId trackId, ClusterId clusterId) {
+                builder.addTrackCluster(trackId, clusterId);
+            });
+            Track::findReleaseIds(dbSession, trackIdRange, [&](TrackId trackId, ReleaseId releaseId) {
+                builder.addTrackRelease(trackId, releaseId);
+            });
+            TrackArtistLink::findArtistIds(dbSession, trackIdRange, [&](TrackId trackId, ArtistId artistId, TrackArtistLinkType linkType) {
+                builder.addTrackArtist(trackId, artistId, linkType);
+            });
+
+            progress.processedElems = std::min(progress.processedElems + readBatchSize, progress.totalElems);
+            if (progressCallback)
+                progressCallback(progress);
+        }
+
+        return std::make_unique<ClusterIndex>(std::move(builder), weighting);
+    }
+
+    std::shared_ptr<const ClusterIndex> ClusterEngine::getIndex() const
+    {
+        const std::scoped_lock lock{ _indexMutex };
+        return _index;
+    }
+
     TrackContainer ClusterEngine::findSimilarTracks(const std::vector<TrackId>& trackIds, std::size_t maxCount) const
     {
         if (maxCount == 0)
             return {};
 
+        if (const auto index{ getIndex() })
+            return index->findSimilarTracks(trackIds, maxCount);
+
         Session& dbSession{ _db.getTLSSession() };
         auto transaction{ dbSession.createReadTransaction() };
 
@@ -36,6 +129,8 @@ namespace lms::recommendation
         if (maxCount == 0)
             return res;
 
+        const auto index{ getIndex() };
+
         {
             Session& dbSession{ _db.getTLSSession() };
             auto transaction{ dbSession.createReadTransaction() };
@@ -44,6 +139,9 @@ namespace lms::recommendation
             if (!trackList)
                 return res;
 
+            if (index)
+                return index->findSimilarTracks(trackList->getTrackIds(), maxCount);
+
             const auto tracks{ trackList->getSimilarTracks(0, maxCount) };
             res.reserve(tracks.size());
             std::transform(std::cbegin(tracks), std::cend(tracks), std::back_inserter(res), [](const auto& track) { return track->getId(); });
@@ -58,6 +156,9 @@ namespace lms::recommendation
         if (maxCount == 0)
             return res;
 
+        if (const auto index{ getIndex() })
+            return index->findSimilarReleases(releaseId, maxCount);
+
         {
             Session& dbSession{ _db.getTLSSession() };
             auto transaction{ dbSession.createReadTransaction() };
@@ -79,6 +180,9 @@ namespace lms::recommendation
         if (maxCount == 0)
             return {};
 
+        if (const auto index{ getIndex() })
+            return index->findSimilarArtists(artistId, artistLinkTypes, maxCount);
+
         Session& dbSession{ _db.getTLSSession() };
         auto transaction{ dbSession.createReadTransaction() };
 
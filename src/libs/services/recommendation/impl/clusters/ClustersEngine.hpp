@@ -1,6 +1,10 @@
-
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "ClusterIndex.hpp"
 #include "IEngine.hpp"
 
 namespace lms::recommendation
@@ -19,15 +23,23 @@ namespace lms::recommendation
         ClusterEngine& operator=(ClusterEngine&&) = delete;
 
     private:
-        void load(bool /*forceReload*/, const ProgressCallback& /*progressCallback*/) override {}
-        void requestCancelLoad() override {}
+        void load(bool forceReload, const ProgressCallback& progressCallback) override;
+        void requestCancelLoad() override;
 
         TrackContainer findSimilarTracksFromTrackList(db::TrackListId tracklistId, std::size_t maxCount) const override;
         TrackContainer findSimilarTracks(const std::vector<db::TrackId>& trackIds, std::size_t maxCount) const override;
         ReleaseContainer getSimilarReleases(db::ReleaseId releaseId, std::size_t maxCount) const override;
         ArtistContainer getSimilarArtists(db::ArtistId artistId, core::EnumSet<db::TrackArtistLinkType> linkTypes, std::size_t maxCount) const override;
 
+        std::unique_ptr<ClusterIndex> buildIndex(const ProgressCallback& progressCallback);
+        std::shared_ptr<const ClusterIndex> getIndex() const;
+
         db::IDb& _db;
+        std::atomic<bool> _loadCancelled{};
+
+        // queries fall back on the database while no index is loaded
+        mutable std::mutex _indexMutex;
+        std::shared_ptr<const ClusterIndex> _index;
     };
 
 } // namespace lms::recommendation
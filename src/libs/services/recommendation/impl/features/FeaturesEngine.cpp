@@ -2,9 +2,14 @@
 #include "FeaturesEngine.hpp"
 
 #include <numeric>
+#include <thread>
 
+#include "core/IConfig.hpp"
 #include "core/ILogger.hpp"
+#include "core/Parallel.hpp"
 #include "core/Random.hpp"
+#include "core/Service.hpp"
+#include "core/String.hpp"
 #include "database/IDb.hpp"
 #include "database/Session.hpp"
 #include "database/objects/Artist.hpp"
@@ -26,24 +31,25 @@ namespace lms::recommendation
 
     namespace
     {
-        std::optional<som::InputVector> convertFeatureValuesMapToInputVector(const FeatureValuesMap& featureValuesMap, std::size_t nbDimensions)
+        // Max number of ref vectors to precompute for each ref vector when searching for similar objects
+        constexpr std::size_t maxNeighbourCountPerRefVector{ 64 };
+
+        bool convertFeatureValuesMapToInputVector(const FeatureValuesMap& featureValuesMap, som::InputVector& inputVector)
         {
             std::size_t i{};
-            std::optional<som::InputVector> res{ som::InputVector{ nbDimensions } };
             for (const auto& [featureName, values] : featureValuesMap)
             {
                 if (values.size() != getFeatureDef(featureName).nbDimensions)
                 {
                     LMS_LOG(RECOMMENDATION, WARNING, "Dimension mismatch for feature '" << featureName << "'. Expected " << getFeatureDef(featureName).nbDimensions << ", got " << values.size());
-                    res.reset();
-                    break;
+                    return false;
                 }
 
                 for (double val : values)
-                    (*res)[i++] = val;
+                    inputVector[i++] = val;
             }
 
-            return res;
+            return true;
         }
 
         som::InputVector getInputVectorWeights(const FeatureSettingsMap& featureSettingsMap, std::size_t nbDimensions)
@@ -62,6 +68,114 @@ namespace lms::recommendation
 
             return weights;
         }
+
+        std::unordered_set<FeatureName> getFeatureNames(const FeatureSettingsMap& featureSettingsMap)
+        {
+            std::unordered_set<FeatureName> featureNames;
+            std::transform(std::cbegin(featureSettingsMap), std::cend(featureSettingsMap), std::inserter(featureNames, std::begin(featureNames)),
+                           [](const auto& itFeatureSetting) { return itFeatureSetting.first; });
+
+            return featureNames;
+        }
+
+        std::size_t getDimensionCount(const std::unordered_set<FeatureName>& featureNames)
+        {
+            return std::accumulate(std::cbegin(featureNames), std::cend(featureNames), std::size_t{ 0 },
+                                   [](std::size_t sum, const FeatureName& featureName) { return sum + getFeatureDef(featureName).nbDimensions; });
+        }
+
+        struct SampleExtractionParameters
+        {
+            std::size_t nbDimensions{};
+            std::size_t threadCount{ 1 };
+            std::size_t expectedSampleCount{};              // used to preallocate samples
+            TrackFeaturesId lastRetrievedId;                // extraction starts after this id
+            std::function<bool(TrackFeaturesId)> filter;    // if set, only the accepted features are extracted
+        };
+
+        // Track features are read by batches ordered by id, the JSON parsing is done in parallel directly in the samples
+        // Features that cannot be used are reported in failedTrackFeaturesIds
+        // Returns false if cancelled
+        bool extractSamples(Session& session, const std::unordered_set<FeatureName>& featureNames, SampleExtractionParameters params, const bool& cancelled,
+                            std::vector<som::InputVector>& samples, std::vector<TrackId>& samplesTrackIds, std::vector<TrackFeaturesId>& samplesTrackFeaturesIds,
+                            FeaturesEngineCache::FailedTrackFeaturesIds& failedTrackFeaturesIds)
+        {
+            constexpr std::size_t batchSize{ 512 };
+
+            struct EncodedFeatures
+            {
+                TrackFeaturesId trackFeaturesId;
+                TrackId trackId;
+                std::string jsonEncodedFeatures;
+            };
+            std::vector<EncodedFeatures> batch;
+            batch.reserve(batchSize);
+            std::vector<char> validSamples;
+
+            samples.reserve(samples.size() + params.expectedSampleCount);
+            samplesTrackIds.reserve(samplesTrackIds.size() + params.expectedSampleCount);
+            samplesTrackFeaturesIds.reserve(samplesTrackFeaturesIds.size() + params.expectedSampleCount);
+
+            while (true)
+            {
+                if (cancelled)
+                    return false;
+
+                batch.clear();
+
+                std::size_t rowCount{};
+                {
+                    auto transaction{ session.createReadTransaction() };
+
+                    TrackFeatures::findEncodedFeatures(session, params.lastRetrievedId, batchSize, [&](TrackFeaturesId trackFeaturesId, TrackId trackId, const std::string& jsonEncodedFeatures) {
+                        rowCount++;
+                        if (!params.filter || params.filter(trackFeaturesId))
+                            batch.push_back(EncodedFeatures{ trackFeaturesId, trackId, jsonEncodedFeatures });
+                    });
+                }
+
+                if (rowCount == 0)
+                    break;
+
+                const std::size_t offset{ samples.size() };
+                samples.resize(offset + batch.size(), som::InputVector{ params.nbDimensions });
+                validSamples.assign(batch.size(), false);
+
+                core::parallelForRanges(batch.size(), params.threadCount, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t i{ begin }; i < end; ++i)
+                    {
+                        const FeatureValuesMap featureValuesMap{ TrackFeatures::parseFeatureValuesMap(batch[i].jsonEncodedFeatures, featureNames) };
+                        if (featureValuesMap.empty())
+                        {
+                            LMS_LOG(RECOMMENDATION, WARNING, "Cannot parse features for track " << batch[i].trackId.toString());
+                            continue;
+                        }
+
+                        validSamples[i] = convertFeatureValuesMapToInputVector(featureValuesMap, samples[offset + i]);
+                    }
+                });
+
+                // Compact the samples so that they are stored in the same order as their track ids
+                std::size_t sampleCount{ offset };
+                for (std::size_t i{}; i < batch.size(); ++i)
+                {
+                    if (!validSamples[i])
+                    {
+                        failedTrackFeaturesIds.insert(batch[i].trackFeaturesId);
+                        continue;
+                    }
+
+                    if (sampleCount != offset + i)
+                        samples[sampleCount] = std::move(samples[offset + i]);
+                    samplesTrackIds.push_back(batch[i].trackId);
+                    samplesTrackFeaturesIds.push_back(batch[i].trackFeaturesId);
+                    sampleCount++;
+                }
+                samples.resize(sampleCount, som::InputVector{ params.nbDimensions });
+            }
+
+            return true;
+        }
     } // namespace
 
     const FeatureSettingsMap& FeaturesEngine::getDefaultTrainFeatureSettings()
@@ -77,61 +191,60 @@ namespace lms::recommendation
         return defaultTrainFeatureSettings;
     }
 
+    FeaturesEngine::TrainSettings FeaturesEngine::getTrainSettingsFromConfig()
+    {
+        core::IConfig& config{ *core::Service<core::IConfig>::get() };
+
+        TrainSettings trainSettings;
+        trainSettings.featureSettingsMap = getDefaultTrainFeatureSettings();
+
+        const std::string trainingMode{ core::stringUtils::stringToLower(config.getString("features-training-mode", "online")) };
+        if (trainingMode == "batch")
+            trainSettings.trainingMode = TrainingMode::Batch;
+        else if (trainingMode != "online")
+            LMS_LOG(RECOMMENDATION, WARNING, "Unknown features training mode '" << trainingMode << "', using 'online'");
+
+        trainSettings.threadCount = config.getULong("features-training-thread-count", 0);
+        if (trainSettings.threadCount == 0)
+            trainSettings.threadCount = std::max<std::size_t>(std::thread::hardware_concurrency() / 2, 1);
+
+        if (const unsigned long seed{ config.getULong("features-training-seed", 0) })
+            trainSettings.randomSeed = static_cast<core::random::RandGenerator::result_type>(seed);
+
+        trainSettings.incrementalUpdate = config.getBool("features-incremental-update", true);
+        trainSettings.maxQuantizationErrorGrowth = config.getULong("features-max-quantization-error-growth-percent", 50) / 100.;
+
+        return trainSettings;
+    }
+
     void FeaturesEngine::loadFromTraining(const TrainSettings& trainSettings, const ProgressCallback& progressCallback)
     {
         LMS_LOG(RECOMMENDATION, INFO, "Constructing features classifier...");
 
-        std::unordered_set<FeatureName> featureNames;
-        std::transform(std::cbegin(trainSettings.featureSettingsMap), std::cend(trainSettings.featureSettingsMap), std::inserter(featureNames, std::begin(featureNames)),
-                       [](const auto& itFeatureSetting) { return itFeatureSetting.first; });
-
-        const std::size_t nbDimensions{ std::accumulate(std::cbegin(featureNames), std::cend(featureNames), std::size_t{ 0 },
-                                                        [](std::size_t sum, const FeatureName& featureName) { return sum + getFeatureDef(featureName).nbDimensions; }) };
+        const std::unordered_set<FeatureName> featureNames{ getFeatureNames(trainSettings.featureSettingsMap) };
+        const std::size_t nbDimensions{ getDimensionCount(featureNames) };
 
         LMS_LOG(RECOMMENDATION, DEBUG, "Features dimension = " << nbDimensions);
 
         Session& session{ _db.getTLSSession() };
 
-        RangeResults<TrackFeaturesId> trackFeaturesIds;
+        SampleExtractionParameters extractionParams;
+        extractionParams.nbDimensions = nbDimensions;
+        extractionParams.threadCount = trainSettings.threadCount;
         {
             auto transaction{ session.createReadTransaction() };
-
-            LMS_LOG(RECOMMENDATION, DEBUG, "Getting Track features...");
-            trackFeaturesIds = TrackFeatures::find(session);
-            LMS_LOG(RECOMMENDATION, DEBUG, "Getting Track features DONE (found " << trackFeaturesIds.results.size() << " track features)");
+            extractionParams.expectedSampleCount = TrackFeatures::getCount(session);
         }
 
         std::vector<som::InputVector> samples;
         std::vector<TrackId> samplesTrackIds;
+        std::vector<TrackFeaturesId> samplesTrackFeaturesIds;
+        FeaturesEngineCache::FailedTrackFeaturesIds failedTrackFeaturesIds;
 
-        samples.reserve(trackFeaturesIds.results.size());
-        samplesTrackIds.reserve(trackFeaturesIds.results.size());
-
-        LMS_LOG(RECOMMENDATION, DEBUG, "Extracting features...");
-        // TODO handle errors using exceptions
-        for (const TrackFeaturesId trackFeaturesId : trackFeaturesIds.results)
-        {
-            if (_loadCancelled)
-                return;
-
-            auto transaction{ session.createReadTransaction() };
-
-            TrackFeatures::pointer trackFeatures{ TrackFeatures::find(session, trackFeaturesId) };
-            if (!trackFeatures)
-                continue;
-
-            FeatureValuesMap featureValuesMap{ trackFeatures->getFeatureValuesMap(featureNames) };
-            if (featureValuesMap.empty())
-                continue;
-
-            std::optional<som::InputVector> inputVector{ convertFeatureValuesMapToInputVector(featureValuesMap, nbDimensions) };
-            if (!inputVector)
-                continue;
-
-            samples.emplace_back(std::move(*inputVector));
-            samplesTrackIds.emplace_back(trackFeatures->getTrack()->getId());
-        }
-        LMS_LOG(RECOMMENDATION, DEBUG, "Extracting features DONE");
+        LMS_LOG(RECOMMENDATION, DEBUG, "Extracting features (found " << extractionParams.expectedSampleCount << " track features)...");
+        if (!extractSamples(session, featureNames, extractionParams, _loadCancelled, samples, samplesTrackIds, samplesTrackFeaturesIds, failedTrackFeaturesIds))
+            return;
+        LMS_LOG(RECOMMENDATION, DEBUG, "Extracting features DONE, " << failedTrackFeaturesIds.size() << " unusable track features");
 
         if (samples.empty())
         {
@@ -154,7 +267,12 @@ namespace lms::recommendation
         }
         LMS_LOG(RECOMMENDATION, INFO, "Found " << samples.size() << " tracks, constructing a " << size << "*" << size << " network");
 
-        som::Network network{ size, size, nbDimensions };
+        std::optional<core::random::RandGenerator> seededRandGenerator;
+        if (trainSettings.randomSeed)
+            seededRandGenerator = core::random::createSeededGenerator(*trainSettings.randomSeed);
+
+        core::random::RandGenerator& randGenerator{ seededRandGenerator ? *seededRandGenerator : core::random::getRandGenerator() };
+        som::Network network{ size, size, nbDimensions, randGenerator };
 
         som::InputVector weights{ getInputVectorWeights(trainSettings.featureSettingsMap, nbDimensions) };
         network.setDataWeights(weights);
@@ -164,33 +282,169 @@ namespace lms::recommendation
             progressCallback(Progress{ iter.idIteration, iter.iterationCount });
         } };
 
-        LMS_LOG(RECOMMENDATION, DEBUG, "Training network...");
-        network.train(samples, trainSettings.iterationCount,
-                      progressCallback ? somProgressCallback : som::Network::ProgressCallback{},
-                      [this] { return _loadCancelled; });
+        switch (trainSettings.trainingMode)
+        {
+        case TrainingMode::Online:
+            LMS_LOG(RECOMMENDATION, DEBUG, "Training network...");
+            network.train(samples, trainSettings.iterationCount, randGenerator,
+                          progressCallback ? somProgressCallback : som::Network::ProgressCallback{},
+                          [this] { return _loadCancelled; });
+            break;
+
+        case TrainingMode::Batch:
+            LMS_LOG(RECOMMENDATION, DEBUG, "Training network in batch mode using " << trainSettings.threadCount << " threads...");
+            network.trainBatch(samples, trainSettings.iterationCount, trainSettings.threadCount,
+                               progressCallback ? somProgressCallback : som::Network::ProgressCallback{},
+                               [this] { return _loadCancelled; });
+            break;
+        }
         LMS_LOG(RECOMMENDATION, DEBUG, "Training network DONE");
 
         LMS_LOG(RECOMMENDATION, DEBUG, "Classifying tracks...");
         TrackPositions trackPositions;
+        double quantizationErrorSum{};
         for (std::size_t i{}; i < samples.size(); ++i)
         {
             if (_loadCancelled)
                 return;
 
             const som::Position position{ network.getClosestRefVectorPosition(samples[i]) };
+            quantizationErrorSum += network.getRefVectorDistance(position, samples[i]);
 
             trackPositions[samplesTrackIds[i]].push_back(position);
         }
 
-        LMS_LOG(RECOMMENDATION, DEBUG, "Classifying tracks DONE");
+        const double referenceQuantizationError{ quantizationErrorSum / samples.size() };
+        LMS_LOG(RECOMMENDATION, DEBUG, "Classifying tracks DONE, mean quantization error = " << referenceQuantizationError);
+
+        _trainingState.emplace(FeaturesEngineCache::TrainingState{ std::move(dataNormalizer), referenceQuantizationError });
+
+        _trackFeaturesIds.clear();
+        for (std::size_t i{}; i < samplesTrackIds.size(); ++i)
+            _trackFeaturesIds[samplesTrackIds[i]] = samplesTrackFeaturesIds[i];
+        _failedTrackFeaturesIds = std::move(failedTrackFeaturesIds);
 
         load(std::move(network), std::move(trackPositions));
     }
 
+    FeaturesEngine::CacheUpdateResult FeaturesEngine::updateCache(FeaturesEngineCache& cache, const TrainSettings& trainSettings) const
+    {
+        if (!cache._trainingState)
+        {
+            LMS_LOG(RECOMMENDATION, INFO, "Features cache cannot be updated incrementally, a full training is needed");
+            return CacheUpdateResult::NeedsTraining;
+        }
+
+        const som::Network& network{ cache._network };
+        FeaturesEngineCache::TrainingState& trainingState{ *cache._trainingState };
+
+        const std::unordered_set<FeatureName> featureNames{ getFeatureNames(trainSettings.featureSettingsMap) };
+        const std::size_t nbDimensions{ getDimensionCount(featureNames) };
+        if (network.getInputDimCount() != nbDimensions || trainingState.dataNormalizer.getInputDimCount() != nbDimensions)
+        {
+            LMS_LOG(RECOMMENDATION, INFO, "Features settings changed, a full training is needed");
+            return CacheUpdateResult::NeedsTraining;
+        }
+
+        Session& session{ _db.getTLSSession() };
+
+        // Diff on the features ids: replaced features are classified again, failed ones are not retried
+        std::unordered_set<TrackFeaturesId> addedTrackFeaturesIds;
+        std::optional<TrackFeaturesId> firstAddedTrackFeaturesId;
+        std::unordered_set<TrackId> upToDateTrackIds;
+        FeaturesEngineCache::FailedTrackFeaturesIds failedTrackFeaturesIds; // still existing ones
+        {
+            auto transaction{ session.createReadTransaction() };
+
+            TrackFeatures::findTrackIds(session, [&](TrackFeaturesId trackFeaturesId, TrackId trackId) {
+                if (cache._failedTrackFeaturesIds.contains(trackFeaturesId))
+                {
+                    failedTrackFeaturesIds.insert(trackFeaturesId);
+                    return;
+                }
+
+                const auto itTrackFeaturesId{ cache._trackFeaturesIds.find(trackId) };
+                if (itTrackFeaturesId != std::cend(cache._trackFeaturesIds) && itTrackFeaturesId->second == trackFeaturesId && cache._trackPositions.contains(trackId))
+                {
+                    upToDateTrackIds.insert(trackId);
+                    return;
+                }
+
+                addedTrackFeaturesIds.insert(trackFeaturesId);
+                if (!firstAddedTrackFeaturesId || trackFeaturesId < *firstAddedTrackFeaturesId)
+                    firstAddedTrackFeaturesId = trackFeaturesId;
+            });
+        }
+
+        // replaced tracks are dropped too, before being classified again
+        const std::size_t removedTrackCount{ std::erase_if(cache._trackPositions, [&](const auto& trackPositions) { return !upToDateTrackIds.contains(trackPositions.first); }) };
+        std::erase_if(cache._trackFeaturesIds, [&](const auto& trackFeaturesId) { return !upToDateTrackIds.contains(trackFeaturesId.first); });
+        const std::size_t removedFailedTrackFeaturesCount{ cache._failedTrackFeaturesIds.size() - failedTrackFeaturesIds.size() };
+        cache._failedTrackFeaturesIds = std::move(failedTrackFeaturesIds);
+
+        std::vector<som::InputVector> samples;
+        std::vector<TrackId> samplesTrackIds;
+        std::vector<TrackFeaturesId> samplesTrackFeaturesIds;
+        const std::size_t previousFailedTrackFeaturesCount{ cache._failedTrackFeaturesIds.size() };
+        if (firstAddedTrackFeaturesId)
+        {
+            SampleExtractionParameters extractionParams;
+            extractionParams.nbDimensions = nbDimensions;
+            extractionParams.threadCount = trainSettings.threadCount;
+            extractionParams.expectedSampleCount = addedTrackFeaturesIds.size();
+            extractionParams.lastRetrievedId = TrackFeaturesId{ firstAddedTrackFeaturesId->getValue() - 1 }; // added features are usually the last ones
+            extractionParams.filter = [&](TrackFeaturesId trackFeaturesId) { return addedTrackFeaturesIds.contains(trackFeaturesId); };
+
+            if (!extractSamples(session, featureNames, extractionParams, _loadCancelled, samples, samplesTrackIds, samplesTrackFeaturesIds, cache._failedTrackFeaturesIds))
+                return CacheUpdateResult::Cancelled;
+        }
+        const std::size_t addedFailedTrackFeaturesCount{ cache._failedTrackFeaturesIds.size() - previousFailedTrackFeaturesCount };
+
+        LMS_LOG(RECOMMENDATION, DEBUG, "Features cache update: " << samples.size() << " tracks to classify, " << removedTrackCount << " tracks removed or replaced, " << addedFailedTrackFeaturesCount << " new unusable track features");
+        if (samples.empty() && removedTrackCount == 0 && addedFailedTrackFeaturesCount == 0 && removedFailedTrackFeaturesCount == 0)
+            return CacheUpdateResult::UpToDate;
+
+        for (std::size_t i{}; i < samples.size(); ++i)
+        {
+            if (_loadCancelled)
+                return CacheUpdateResult::Cancelled;
+
+            trainingState.dataNormalizer.normalizeData(samples[i]);
+
+            const som::Position position{ network.getClosestRefVectorPosition(samples[i]) };
+            trainingState.addedQuantizationErrorSum += network.getRefVectorDistance(position, samples[i]);
+            trainingState.addedTrackCount += 1;
+
+            cache._trackPositions[samplesTrackIds[i]].push_back(position);
+            cache._trackFeaturesIds[samplesTrackIds[i]] = samplesTrackFeaturesIds[i];
+        }
+
+        // Drift detection: the network is no longer representative if the tracks classified since the training are too far from their ref vectors
+        if (trainingState.addedTrackCount > 0)
+        {
+            const double addedQuantizationError{ trainingState.addedQuantizationErrorSum / trainingState.addedTrackCount };
+            LMS_LOG(RECOMMENDATION, DEBUG, "Mean quantization error of the " << trainingState.addedTrackCount << " tracks added since training = " << addedQuantizationError << ", reference = " << trainingState.referenceQuantizationError);
+
+            if (addedQuantizationError > trainingState.referenceQuantizationError * (1 + trainSettings.maxQuantizationErrorGrowth))
+            {
+                LMS_LOG(RECOMMENDATION, INFO, "Quantization error grew too much since last training, a full training is needed");
+                return CacheUpdateResult::NeedsTraining;
+            }
+        }
+
+        return CacheUpdateResult::Updated;
+    }
+
     void FeaturesEngine::loadFromCache(FeaturesEngineCache&& cache)
     {
         LMS_LOG(RECOMMENDATION, INFO, "Constructing features classifier from cache...");
 
+        _trainingState.reset();
+        if (cache._trainingState)
+            _trainingState.emplace(std::move(*cache._trainingState));
+        _trackFeaturesIds = std::move(cache._trackFeaturesIds);
+        _failedTrackFeaturesIds = std::move(cache._failedTrackFeaturesIds);
+
         load(std::move(cache._network), cache._trackPositions);
     }
 
@@ -298,23 +552,36 @@ namespace lms::recommendation
 
     FeaturesEngineCache FeaturesEngine::toCache() const
     {
-        return FeaturesEngineCache{ *_network, _trackPositions };
+        return FeaturesEngineCache{ *_network, _trackPositions, _trackFeaturesIds, _failedTrackFeaturesIds, _trainingState };
     }
 
     void FeaturesEngine::load(bool forceReload, const ProgressCallback& progressCallback)
     {
+        const TrainSettings trainSettings{ getTrainSettingsFromConfig() };
+
         if (forceReload)
         {
             FeaturesEngineCache::invalidate();
         }
         else if (std::optional<FeaturesEngineCache> cache{ FeaturesEngineCache::read() })
         {
-            loadFromCache(std::move(*cache));
-            return;
-        }
+            const CacheUpdateResult updateResult{ trainSettings.incrementalUpdate ? updateCache(*cache, trainSettings) : CacheUpdateResult::UpToDate };
+            switch (updateResult)
+            {
+            case CacheUpdateResult::Cancelled:
+                return;
 
-        TrainSettings trainSettings;
-        trainSettings.featureSettingsMap = getDefaultTrainFeatureSettings();
+            case CacheUpdateResult::Updated:
+                cache->write();
+                [[fallthrough]];
+            case CacheUpdateResult::UpToDate:
+                loadFromCache(std::move(*cache));
+                return;
+
+            case CacheUpdateResult::NeedsTraining:
+                break;
+            }
+        }
 
         loadFromTraining(trainSettings, progressCallback);
         if (!_loadCancelled && _network)
@@ -337,13 +604,19 @@ namespace lms::recommendation
         const som::Coordinate width{ network.getWidth() };
         const som::Coordinate height{ network.getHeight() };
 
-        _releaseMatrix = ReleaseMatrix{ width, height };
-        _trackMatrix = TrackMatrix{ width, height };
-
         LMS_LOG(RECOMMENDATION, DEBUG, "Constructing maps...");
 
+        _trackPositions.clear();
+        _releasePositions.clear();
+        _artistPositions.clear();
+        _artistMatrix.clear();
+
         Session& session{ _db.getTLSSession() };
 
+        std::vector<TrackMatrix::Entry> trackEntries;
+        std::vector<ReleaseMatrix::Entry> releaseEntries;
+        std::unordered_map<TrackArtistLinkType, std::vector<ArtistMatrix::Entry>> artistEntries;
+
         for (const auto& [trackId, positions] : trackPositions)
         {
             if (_loadCancelled)
@@ -355,34 +628,49 @@ namespace lms::recommendation
             if (!track)
                 continue;
 
+            const Release::pointer release{ track->getRelease() };
+            const auto artistLinks{ track->getArtistLinks() };
+
             for (const som::Position& position : positions)
             {
-                core::utils::push_back_if_not_present(_trackPositions[trackId], position);
-                core::utils::push_back_if_not_present(_trackMatrix[position], trackId);
+                _trackPositions[trackId].push_back(position);
+                trackEntries.push_back({ position, trackId });
 
-                if (Release::pointer release{ track->getRelease() })
+                if (release)
                 {
                     const ReleaseId releaseId{ release->getId() };
-                    core::utils::push_back_if_not_present(_releasePositions[releaseId], position);
-                    core::utils::push_back_if_not_present(_releaseMatrix[position], releaseId);
+                    _releasePositions[releaseId].push_back(position);
+                    releaseEntries.push_back({ position, releaseId });
                 }
-                for (const TrackArtistLink::pointer& artistLink : track->getArtistLinks())
+                for (const TrackArtistLink::pointer& artistLink : artistLinks)
                 {
                     const ArtistId artistId{ artistLink->getArtist()->getId() };
 
-                    core::utils::push_back_if_not_present(_artistPositions[artistId], position);
-                    auto itArtists{ _artistMatrix.find(artistLink->getType()) };
-                    if (itArtists == std::cend(_artistMatrix))
-                    {
-                        [[maybe_unused]] auto [it, inserted] = _artistMatrix.try_emplace(artistLink->getType(), ArtistMatrix{ width, height });
-                        assert(inserted);
-                        itArtists = it;
-                    }
-                    core::utils::push_back_if_not_present(itArtists->second[position], artistId);
+                    _artistPositions[artistId].push_back(position);
+                    artistEntries[artistLink->getType()].push_back({ position, artistId });
                 }
             }
         }
 
+        auto removeDuplicatePositions{ [](auto& objectPositions) {
+            for (auto& [id, positions] : objectPositions)
+            {
+                std::sort(std::begin(positions), std::end(positions));
+                positions.erase(std::unique(std::begin(positions), std::end(positions)), std::end(positions));
+            }
+        } };
+        removeDuplicatePositions(_trackPositions);
+        removeDuplicatePositions(_releasePositions);
+        removeDuplicatePositions(_artistPositions);
+
+        _trackMatrix = TrackMatrix{ width, height, std::move(trackEntries) };
+        _releaseMatrix = ReleaseMatrix{ width, height, std::move(releaseEntries) };
+        for (auto& [linkType, entries] : artistEntries)
+            _artistMatrix.insert_or_assign(linkType, ArtistMatrix{ width, height, std::move(entries) });
+
+        LMS_LOG(RECOMMENDATION, DEBUG, "Constructing neighbour index...");
+        _neighbourIndex = som::NeighbourIndex{ network, _networkRefVectorsDistanceMedian * 0.75, maxNeighbourCountPerRefVector };
+
         _network = std::make_unique<som::Network>(network);
 
         LMS_LOG(RECOMMENDATION, INFO, "Classifier successfully loaded!");
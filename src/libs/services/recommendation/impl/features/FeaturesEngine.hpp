@@ -3,13 +3,17 @@
 
 #include <algorithm>
 #include <functional>
+#include <numeric>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
-#include "core/Utils.hpp"
+#include "core/Random.hpp"
 #include "som/DataNormalizer.hpp"
+#include "som/NeighbourIndex.hpp"
 #include "som/Network.hpp"
 
 #include "FeaturesDefs.hpp"
@@ -50,14 +54,36 @@ namespace lms::recommendation
         void loadFromCache(FeaturesEngineCache&& cache);
 
         // Use training (may be very slow)
+        enum class TrainingMode
+        {
+            Online, // one sample at a time, single threaded
+            Batch,  // all samples per iteration, multi threaded
+        };
+
         struct TrainSettings
         {
             std::size_t iterationCount{ 10 };
             float sampleCountPerNeuron{ 4 };
             FeatureSettingsMap featureSettingsMap;
+            TrainingMode trainingMode{ TrainingMode::Online };
+            std::size_t threadCount{ 1 };                                       // used to extract features and to train in batch mode
+            std::optional<core::random::RandGenerator::result_type> randomSeed; // used to init the network and shuffle the samples, random if not set
+            bool incrementalUpdate{ true };                                     // classify new tracks using the cached network instead of retraining
+            double maxQuantizationErrorGrowth{ 0.5 };                           // retrain if the new tracks are that much worse classified than the training ones
         };
+        static TrainSettings getTrainSettingsFromConfig();
         void loadFromTraining(const TrainSettings& trainSettings, const ProgressCallback& progressCallback);
 
+        // Update the cache without training: new tracks are classified using the cached network, removed tracks are dropped
+        enum class CacheUpdateResult
+        {
+            UpToDate,
+            Updated,
+            NeedsTraining,
+            Cancelled,
+        };
+        CacheUpdateResult updateCache(FeaturesEngineCache& cache, const TrainSettings& trainSettings) const;
+
         template<typename IdType>
         using ObjectPositions = std::unordered_map<IdType, std::vector<som::Position>>;
 
@@ -65,8 +91,27 @@ namespace lms::recommendation
         using ReleasePositions = ObjectPositions<db::ReleaseId>;
         using TrackPositions = ObjectPositions<db::TrackId>;
 
+        // Object ids for each ref vector, stored in a single flat array
         template<typename IdType>
-        using ObjectMatrix = som::Matrix<std::vector<IdType>>;
+        class ObjectMatrix
+        {
+        public:
+            struct Entry
+            {
+                som::Position position;
+                IdType id;
+            };
+
+            ObjectMatrix() = default;
+            ObjectMatrix(som::Coordinate width, som::Coordinate height, std::vector<Entry> entries);
+
+            std::span<const IdType> get(const som::Position& position) const;
+
+        private:
+            som::Coordinate _width{};
+            std::vector<std::size_t> _offsets; // indexed by x + width * y, ids are in [_offsets[i], _offsets[i + 1])
+            std::vector<IdType> _ids;
+        };
         using ArtistMatrix = ObjectMatrix<db::ArtistId>;
         using ReleaseMatrix = ObjectMatrix<db::ReleaseId>;
         using TrackMatrix = ObjectMatrix<db::TrackId>;
@@ -78,9 +123,6 @@ namespace lms::recommendation
         template<typename IdType>
         static std::vector<som::Position> getMatchingRefVectorsPosition(const std::vector<IdType>& ids, const ObjectPositions<IdType>& objectPositions);
 
-        template<typename IdType>
-        static std::vector<IdType> getObjectsIds(const std::vector<som::Position>& positions, const ObjectMatrix<IdType>& objectsMatrix);
-
         template<typename IdType>
         std::vector<IdType> getSimilarObjects(const std::vector<IdType>& ids,
                                               const ObjectMatrix<IdType>& objectMatrix,
@@ -90,7 +132,11 @@ namespace lms::recommendation
         db::IDb& _db;
         bool _loadCancelled{};
         std::unique_ptr<som::Network> _network;
+        std::optional<FeaturesEngineCache::TrainingState> _trainingState;
+        FeaturesEngineCache::TrackFeaturesIds _trackFeaturesIds; // only kept to write the cache
+        FeaturesEngineCache::FailedTrackFeaturesIds _failedTrackFeaturesIds;
         double _networkRefVectorsDistanceMedian{};
+        som::NeighbourIndex _neighbourIndex;
 
         ArtistPositions _artistPositions;
         std::unordered_map<db::TrackArtistLinkType, ArtistMatrix> _artistMatrix;
@@ -102,13 +148,44 @@ namespace lms::recommendation
         TrackMatrix _trackMatrix;
     };
 
+    template<typename IdType>
+    FeaturesEngine::ObjectMatrix<IdType>::ObjectMatrix(som::Coordinate width, som::Coordinate height, std::vector<Entry> entries)
+        : _width{ width }
+    {
+        auto getIndex{ [width](const som::Position& position) { return position.x + static_cast<std::size_t>(width) * position.y; } };
+
+        std::sort(std::begin(entries), std::end(entries), [&](const Entry& a, const Entry& b) {
+            const std::size_t indexA{ getIndex(a.position) };
+            const std::size_t indexB{ getIndex(b.position) };
+            return indexA < indexB || (indexA == indexB && a.id < b.id);
+        });
+        entries.erase(std::unique(std::begin(entries), std::end(entries), [](const Entry& a, const Entry& b) { return a.position == b.position && a.id == b.id; }),
+                      std::end(entries));
+
+        _offsets.resize(static_cast<std::size_t>(width) * height + 1);
+        _ids.reserve(entries.size());
+        for (const Entry& entry : entries)
+        {
+            _offsets[getIndex(entry.position) + 1] += 1;
+            _ids.push_back(entry.id);
+        }
+        std::partial_sum(std::begin(_offsets), std::end(_offsets), std::begin(_offsets));
+    }
+
+    template<typename IdType>
+    std::span<const IdType> FeaturesEngine::ObjectMatrix<IdType>::get(const som::Position& position) const
+    {
+        const std::size_t index{ position.x + static_cast<std::size_t>(_width) * position.y };
+        assert(index + 1 < _offsets.size());
+
+        return std::span<const IdType>{ _ids }.subspan(_offsets[index], _offsets[index + 1] - _offsets[index]);
+    }
+
     template<typename IdType>
     std::vector<som::Position> FeaturesEngine::getMatchingRefVectorsPosition(const std::vector<IdType>& ids, const ObjectPositions<IdType>& objectPositions)
     {
         std::vector<som::Position> res;
-
-        if (ids.empty())
-            return res;
+        std::unordered_set<som::Position> addedPositions;
 
         for (const IdType id : ids)
         {
@@ -117,21 +194,10 @@ namespace lms::recommendation
                 continue;
 
             for (const som::Position& position : it->second)
-                core::utils::push_back_if_not_present(res, position);
-        }
-
-        return res;
-    }
-
-    template<typename IdType>
-    std::vector<IdType> FeaturesEngine::getObjectsIds(const std::vector<som::Position>& positions, const ObjectMatrix<IdType>& objectMatrix)
-    {
-        std::vector<IdType> res;
-
-        for (const som::Position& position : positions)
-        {
-            for (const IdType id : objectMatrix.get(position))
-                core::utils::push_back_if_not_present(res, id);
+            {
+                if (addedPositions.insert(position).second)
+                    res.push_back(position);
+            }
         }
 
         return res;
@@ -145,38 +211,50 @@ namespace lms::recommendation
     {
         std::vector<IdType> res;
 
-        std::vector<som::Position> searchedRefVectorsPosition{ getMatchingRefVectorsPosition(ids, objectPositions) };
+        const std::vector<som::Position> searchedRefVectorsPosition{ getMatchingRefVectorsPosition(ids, objectPositions) };
         if (searchedRefVectorsPosition.empty())
             return res;
 
-        while (1)
-        {
-            std::vector<IdType> closestObjectIds{ getObjectsIds(searchedRefVectorsPosition, objectMatrix) };
+        const std::unordered_set<IdType> inputIds(std::cbegin(ids), std::cend(ids));
+        std::unordered_set<IdType> reportedIds;
+        std::unordered_set<som::Position> visitedPositions;
 
-            // Remove objects that are already in input or already reported
-            closestObjectIds.erase(std::remove_if(std::begin(closestObjectIds), std::end(closestObjectIds),
-                                                  [&](IdType id) {
-                                                      return std::find(std::cbegin(ids), std::cend(ids), id) != std::cend(ids);
-                                                  }),
-                                   std::end(closestObjectIds));
+        auto addObjects{ [&](const som::Position& position) {
+            if (!visitedPositions.insert(position).second)
+                return;
 
-            for (IdType id : closestObjectIds)
+            for (const IdType id : objectMatrix.get(position))
             {
                 if (res.size() == maxCount)
                     break;
 
-                core::utils::push_back_if_not_present(res, id);
+                // Skip objects that are already in input or already reported
+                if (inputIds.contains(id) || !reportedIds.insert(id).second)
+                    continue;
+
+                res.push_back(id);
             }
+        } };
 
-            if (res.size() == maxCount)
-                break;
+        for (const som::Position& position : searchedRefVectorsPosition)
+            addObjects(position);
 
-            // If there is not enough objects, try again with closest neighbour until there is too much distance
-            const std::optional<som::Position> closestRefVectorPosition{ _network->getClosestRefVectorPosition(searchedRefVectorsPosition, _networkRefVectorsDistanceMedian * 0.75) };
-            if (!closestRefVectorPosition)
-                break;
+        // If there is not enough objects, walk the precomputed neighbours of each searched ref vector, closest first
+        for (std::size_t rank{}; res.size() < maxCount; ++rank)
+        {
+            bool hasMoreNeighbours{};
+            for (const som::Position& position : searchedRefVectorsPosition)
+            {
+                const std::span<const som::Position> neighbours{ _neighbourIndex.getNeighbours(position) };
+                if (rank >= neighbours.size())
+                    continue;
 
-            core::utils::push_back_if_not_present(searchedRefVectorsPosition, closestRefVectorPosition.value());
+                hasMoreNeighbours = true;
+                addObjects(neighbours[rank]);
+            }
+
+            if (!hasMoreNeighbours)
+                break;
         }
 
         return res;
@@ -1,6 +1,14 @@
-
 #include "FeaturesEngineCache.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <tuple>
+
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 
@@ -17,58 +25,242 @@ namespace lms::recommendation
             return core::Service<core::IConfig>::get()->getPath("working-dir", "/var/lms") / "cache" / "features";
         }
 
-        std::filesystem::path getCacheNetworkFilePath()
+        std::filesystem::path getCacheFilePath()
+        {
+            return getCacheDirectory() / "features.bin";
+        }
+
+        // Legacy XML files, only read to migrate them to the binary format
+        std::filesystem::path getLegacyCacheNetworkFilePath()
         {
             return getCacheDirectory() / "network";
         }
 
-        std::filesystem::path getCacheTrackPositionsFilePath()
+        std::filesystem::path getLegacyCacheTrackPositionsFilePath()
         {
             return getCacheDirectory() / "track_positions";
         }
 
-        bool networkToCacheFile(const som::Network& network, std::filesystem::path path)
+        // Binary cache file layout (native endianness):
+        // - header
+        // - weights: dim_count values
+        // - normalization factors: dim_count (min, max) pairs, only if hasTrainingState is set
+        // - ref vectors: width * height * dim_count values, row-major
+        // - track positions: track_position_count entries, sorted by track id
+        // - failed track features ids: failed_track_features_count values, sorted
+        // Every block is 8 bytes aligned so that it can be read straight from the mapped file.
+        // The blocks are still copied once: the engine updates the network and the track positions incrementally
+        constexpr std::array<char, 8> binaryCacheMagic{ 'L', 'M', 'S', 'F', 'E', 'A', 'T', 'S' };
+        constexpr std::uint32_t binaryCacheVersion{ 3 };
+
+        struct BinaryCacheHeader
         {
-            try
-            {
-                boost::property_tree::ptree root;
+            std::array<char, 8> magic;
+            std::uint32_t version;
+            std::uint32_t valueSize;
+            std::uint32_t width;
+            std::uint32_t height;
+            std::uint64_t dimCount;
+            std::uint64_t trackPositionCount;
+            std::uint32_t hasTrainingState;
+            std::uint32_t padding;
+            double referenceQuantizationError;
+            double addedQuantizationErrorSum;
+            std::uint64_t addedTrackCount;
+            std::uint64_t failedTrackFeaturesCount;
+        };
+        static_assert(sizeof(BinaryCacheHeader) == 80);
+        static_assert(sizeof(som::DataNormalizer::MinMax) == 2 * sizeof(som::InputVector::value_type));
+
+        struct BinaryTrackPosition
+        {
+            db::IdType::ValueType trackId;
+            db::IdType::ValueType trackFeaturesId;
+            std::uint32_t x;
+            std::uint32_t y;
+        };
+        static_assert(sizeof(BinaryTrackPosition) == 24);
+
+        template<typename T>
+        void writeBlock(std::ofstream& ofs, const T* data, std::size_t count)
+        {
+            ofs.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(count * sizeof(T)));
+        }
+    } // namespace
 
-                root.put("width", network.getWidth());
-                root.put("height", network.getHeight());
-                root.put("dim_count", network.getInputDimCount());
+    std::optional<FeaturesEngineCache> FeaturesEngineCache::readFromBinaryCacheFile(const std::filesystem::path& path)
+    {
+        if (!std::filesystem::exists(path))
+            return std::nullopt;
 
-                for (som::InputVector::value_type weight : network.getDataWeights())
-                    root.add("weights.weight", weight);
+        try
+        {
+            LMS_LOG(RECOMMENDATION, INFO, "Reading features cache...");
 
-                for (som::Coordinate x = 0; x < network.getWidth(); ++x)
-                {
-                    for (som::Coordinate y = 0; y < network.getWidth(); ++y)
-                    {
-                        const auto& refVector = network.getRefVector({ x, y });
+            boost::iostreams::mapped_file_source file{ path.string() };
+            const char* const begin{ file.data() };
+
+            if (file.size() < sizeof(BinaryCacheHeader))
+            {
+                LMS_LOG(RECOMMENDATION, ERROR, "Cannot read features cache: file too small");
+                return std::nullopt;
+            }
+
+            BinaryCacheHeader header;
+            std::memcpy(&header, begin, sizeof(header));
+            if (header.magic != binaryCacheMagic || header.version != binaryCacheVersion || header.valueSize != sizeof(som::InputVector::value_type))
+            {
+                LMS_LOG(RECOMMENDATION, INFO, "Features cache has an unsupported format, discarding it");
+                return std::nullopt;
+            }
+
+            const std::size_t refVectorsValueCount{ static_cast<std::size_t>(header.width) * header.height * header.dimCount };
+            const std::size_t minMaxCount{ header.hasTrainingState ? header.dimCount : 0 };
+            const std::size_t expectedSize{ sizeof(BinaryCacheHeader)
+                                            + (header.dimCount + refVectorsValueCount) * sizeof(som::InputVector::value_type)
+                                            + minMaxCount * sizeof(som::DataNormalizer::MinMax)
+                                            + header.trackPositionCount * sizeof(BinaryTrackPosition)
+                                            + header.failedTrackFeaturesCount * sizeof(db::IdType::ValueType) };
+            if (file.size() != expectedSize)
+            {
+                LMS_LOG(RECOMMENDATION, ERROR, "Cannot read features cache: unexpected file size " << file.size() << ", expected " << expectedSize);
+                return std::nullopt;
+            }
 
-                        boost::property_tree::ptree node;
-                        for (const auto& value : refVector)
-                            node.add("values.value", value);
+            const auto* const weightsData{ reinterpret_cast<const som::InputVector::value_type*>(begin + sizeof(BinaryCacheHeader)) };
+            const auto* const minMaxData{ reinterpret_cast<const som::DataNormalizer::MinMax*>(weightsData + header.dimCount) };
+            const auto* const refVectorsData{ reinterpret_cast<const som::InputVector::value_type*>(minMaxData + minMaxCount) };
+            const auto* const trackPositionsBegin{ reinterpret_cast<const BinaryTrackPosition*>(refVectorsData + refVectorsValueCount) };
+            const auto* const trackPositionsEnd{ trackPositionsBegin + header.trackPositionCount };
+            const auto* const failedTrackFeaturesIdsBegin{ reinterpret_cast<const db::IdType::ValueType*>(trackPositionsEnd) };
+            const auto* const failedTrackFeaturesIdsEnd{ failedTrackFeaturesIdsBegin + header.failedTrackFeaturesCount };
 
-                        node.put("coord_x", x);
-                        node.put("coord_y", y);
+            som::Network network{ header.width, header.height, header.dimCount, std::span{ refVectorsData, refVectorsValueCount } };
+            {
+                som::InputVector weights{ header.dimCount };
+                std::copy(weightsData, weightsData + header.dimCount, weights.begin());
+                network.setDataWeights(weights);
+            }
 
-                        root.add_child("ref_vectors.ref_vector", node);
-                    }
+            TrackPositions trackPositions;
+            TrackFeaturesIds trackFeaturesIds;
+            trackPositions.reserve(header.trackPositionCount);
+            for (const BinaryTrackPosition* trackPosition{ trackPositionsBegin }; trackPosition != trackPositionsEnd; ++trackPosition)
+            {
+                if (trackPosition->x >= header.width || trackPosition->y >= header.height)
+                {
+                    LMS_LOG(RECOMMENDATION, ERROR, "Cannot read features cache: bad track position");
+                    return std::nullopt;
                 }
 
-                boost::property_tree::write_xml(path.string(), root);
+                trackPositions[db::TrackId{ trackPosition->trackId }].push_back(som::Position{ trackPosition->x, trackPosition->y });
+                trackFeaturesIds[db::TrackId{ trackPosition->trackId }] = db::TrackFeaturesId{ trackPosition->trackFeaturesId };
+            }
+
+            FailedTrackFeaturesIds failedTrackFeaturesIds;
+            for (const db::IdType::ValueType* failedTrackFeaturesId{ failedTrackFeaturesIdsBegin }; failedTrackFeaturesId != failedTrackFeaturesIdsEnd; ++failedTrackFeaturesId)
+                failedTrackFeaturesIds.insert(db::TrackFeaturesId{ *failedTrackFeaturesId });
 
-                LMS_LOG(RECOMMENDATION, DEBUG, "Created network cache");
-                return true;
+            std::optional<TrainingState> trainingState;
+            if (header.hasTrainingState)
+            {
+                som::DataNormalizer dataNormalizer{ header.dimCount };
+                for (std::size_t i{}; i < header.dimCount; ++i)
+                    dataNormalizer.setValue(i, minMaxData[i]);
+
+                trainingState.emplace(TrainingState{ std::move(dataNormalizer), header.referenceQuantizationError, header.addedQuantizationErrorSum, header.addedTrackCount });
             }
-            catch (boost::property_tree::ptree_error& error)
+
+            LMS_LOG(RECOMMENDATION, INFO, "Successfully read features cache");
+
+            return FeaturesEngineCache{ std::move(network), std::move(trackPositions), std::move(trackFeaturesIds), std::move(failedTrackFeaturesIds), std::move(trainingState) };
+        }
+        catch (const std::exception& e)
+        {
+            LMS_LOG(RECOMMENDATION, ERROR, "Cannot read features cache: " << e.what());
+            return std::nullopt;
+        }
+    }
+
+    bool FeaturesEngineCache::writeToBinaryCacheFile(const std::filesystem::path& path) const
+    {
+        std::vector<BinaryTrackPosition> trackPositions;
+        for (const auto& [trackId, positions] : _trackPositions)
+        {
+            const auto itTrackFeaturesId{ _trackFeaturesIds.find(trackId) };
+            const db::TrackFeaturesId trackFeaturesId{ itTrackFeaturesId != std::cend(_trackFeaturesIds) ? itTrackFeaturesId->second : db::TrackFeaturesId{} };
+
+            for (const som::Position& position : positions)
+                trackPositions.push_back(BinaryTrackPosition{ trackId.getValue(), trackFeaturesId.getValue(), position.x, position.y });
+        }
+        std::sort(std::begin(trackPositions), std::end(trackPositions), [](const BinaryTrackPosition& a, const BinaryTrackPosition& b) {
+            return std::tie(a.trackId, a.x, a.y) < std::tie(b.trackId, b.x, b.y);
+        });
+
+        BinaryCacheHeader header{};
+        header.magic = binaryCacheMagic;
+        header.version = binaryCacheVersion;
+        header.valueSize = sizeof(som::InputVector::value_type);
+        header.width = _network.getWidth();
+        header.height = _network.getHeight();
+        header.dimCount = _network.getInputDimCount();
+        header.trackPositionCount = trackPositions.size();
+
+        std::vector<db::IdType::ValueType> failedTrackFeaturesIds;
+        failedTrackFeaturesIds.reserve(_failedTrackFeaturesIds.size());
+        for (const db::TrackFeaturesId trackFeaturesId : _failedTrackFeaturesIds)
+            failedTrackFeaturesIds.push_back(trackFeaturesId.getValue());
+        std::sort(std::begin(failedTrackFeaturesIds), std::end(failedTrackFeaturesIds));
+        header.failedTrackFeaturesCount = failedTrackFeaturesIds.size();
+
+        std::vector<som::DataNormalizer::MinMax> minMaxValues;
+        if (_trainingState)
+        {
+            header.hasTrainingState = 1;
+            header.referenceQuantizationError = _trainingState->referenceQuantizationError;
+            header.addedQuantizationErrorSum = _trainingState->addedQuantizationErrorSum;
+            header.addedTrackCount = _trainingState->addedTrackCount;
+
+            for (std::size_t i{}; i < _trainingState->dataNormalizer.getInputDimCount(); ++i)
+                minMaxValues.push_back(_trainingState->dataNormalizer.getValue(i));
+            assert(minMaxValues.size() == _network.getInputDimCount());
+        }
+
+        // write in a temporary file so that a partially written cache is never read
+        std::filesystem::path tmpPath{ path };
+        tmpPath += ".tmp";
+
+        {
+            std::ofstream ofs{ tmpPath, std::ios::binary | std::ios::trunc };
+            writeBlock(ofs, &header, 1);
+            writeBlock(ofs, _network.getDataWeights().data(), _network.getInputDimCount());
+            writeBlock(ofs, minMaxValues.data(), minMaxValues.size());
+            writeBlock(ofs, _network.getRefVectorsData().data(), _network.getRefVectorsData().size());
+            writeBlock(ofs, trackPositions.data(), trackPositions.size());
+            writeBlock(ofs, failedTrackFeaturesIds.data(), failedTrackFeaturesIds.size());
+
+            ofs.flush();
+            if (!ofs)
             {
-                LMS_LOG(RECOMMENDATION, ERROR, "Cannot create network cache: " << error.what());
+                LMS_LOG(RECOMMENDATION, ERROR, "Cannot write features cache in " << tmpPath);
+                std::error_code ec;
+                std::filesystem::remove(tmpPath, ec);
                 return false;
             }
         }
-    } // namespace
+
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec)
+        {
+            LMS_LOG(RECOMMENDATION, ERROR, "Cannot rename features cache file: " << ec.message());
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+
+        LMS_LOG(RECOMMENDATION, DEBUG, "Created features cache");
+        return true;
+    }
 
     std::optional<som::Network> FeaturesEngineCache::createNetworkFromCacheFile(const std::filesystem::path& path)
     {
@@ -122,40 +314,6 @@ namespace lms::recommendation
         }
     }
 
-    bool FeaturesEngineCache::objectPositionToCacheFile(const TrackPositions& trackPositions, const std::filesystem::path& path)
-    {
-        try
-        {
-            boost::property_tree::ptree root;
-
-            for (const auto& [id, positions] : trackPositions)
-            {
-                boost::property_tree::ptree node;
-
-                node.put("id", id.getValue());
-
-                for (const som::Position& position : positions)
-                {
-                    boost::property_tree::ptree positionNode;
-                    positionNode.put("x", position.x);
-                    positionNode.put("y", position.y);
-
-                    node.add_child("position.position", positionNode);
-                }
-
-                root.add_child("objects.object", node);
-            }
-
-            boost::property_tree::write_xml(path.string(), root);
-            return true;
-        }
-        catch (boost::property_tree::ptree_error& error)
-        {
-            LMS_LOG(RECOMMENDATION, ERROR, "Cannot cache object position: " << error.what());
-            return false;
-        }
-    }
-
     std::optional<FeaturesEngineCache::TrackPositions> FeaturesEngineCache::createObjectPositionsFromCacheFile(const std::filesystem::path& path)
     {
         try
@@ -191,39 +349,61 @@ namespace lms::recommendation
         }
     }
 
-    void FeaturesEngineCache::invalidate()
-    {
-        std::filesystem::remove(getCacheNetworkFilePath());
-        std::filesystem::remove(getCacheTrackPositionsFilePath());
-    }
-
-    std::optional<FeaturesEngineCache> FeaturesEngineCache::read()
+    std::optional<FeaturesEngineCache> FeaturesEngineCache::readFromLegacyCacheFiles()
     {
-        auto network{ createNetworkFromCacheFile(getCacheNetworkFilePath()) };
+        auto network{ createNetworkFromCacheFile(getLegacyCacheNetworkFilePath()) };
         if (!network)
             return std::nullopt;
 
-        auto trackPositions{ createObjectPositionsFromCacheFile(getCacheTrackPositionsFilePath()) };
+        auto trackPositions{ createObjectPositionsFromCacheFile(getLegacyCacheTrackPositionsFilePath()) };
         if (!trackPositions)
             return std::nullopt;
 
         return FeaturesEngineCache{ std::move(*network), std::move(*trackPositions) };
     }
 
-    void FeaturesEngineCache::write() const
+    void FeaturesEngineCache::invalidate()
+    {
+        std::filesystem::remove(getCacheFilePath());
+        std::filesystem::remove(getLegacyCacheNetworkFilePath());
+        std::filesystem::remove(getLegacyCacheTrackPositionsFilePath());
+    }
+
+    std::optional<FeaturesEngineCache> FeaturesEngineCache::read()
     {
-        std::filesystem::create_directories(core::Service<core::IConfig>::get()->getPath("working-dir", "/var/lms") / "cache" / "features");
+        if (std::optional<FeaturesEngineCache> cache{ readFromBinaryCacheFile(getCacheFilePath()) })
+            return cache;
 
-        if (!networkToCacheFile(_network, getCacheNetworkFilePath())
-            || !objectPositionToCacheFile(_trackPositions, getCacheTrackPositionsFilePath()))
+        std::optional<FeaturesEngineCache> cache{ readFromLegacyCacheFiles() };
+        if (cache)
         {
-            invalidate();
+            LMS_LOG(RECOMMENDATION, INFO, "Migrating features cache to binary format");
+            cache->write();
         }
+
+        return cache;
+    }
+
+    void FeaturesEngineCache::write() const
+    {
+        std::filesystem::create_directories(getCacheDirectory());
+
+        const bool written{ writeToBinaryCacheFile(getCacheFilePath()) };
+
+        // legacy files are either migrated or outdated now
+        std::filesystem::remove(getLegacyCacheNetworkFilePath());
+        std::filesystem::remove(getLegacyCacheTrackPositionsFilePath());
+
+        if (!written)
+            invalidate();
     }
 
-    FeaturesEngineCache::FeaturesEngineCache(som::Network network, TrackPositions trackPositions)
+    FeaturesEngineCache::FeaturesEngineCache(som::Network network, TrackPositions trackPositions, TrackFeaturesIds trackFeaturesIds, FailedTrackFeaturesIds failedTrackFeaturesIds, std::optional<TrainingState> trainingState)
         : _network{ std::move(network) }
         , _trackPositions{ std::move(trackPositions) }
+        , _trackFeaturesIds{ std::move(trackFeaturesIds) }
+        , _failedTrackFeaturesIds{ std::move(failedTrackFeaturesIds) }
+        , _trainingState{ std::move(trainingState) }
     {
     }
 
@@ -2,9 +2,13 @@
 #pragma once
 
 #include <filesystem>
+#include <optional>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "database/objects/TrackFeaturesId.hpp"
 #include "database/objects/TrackId.hpp"
+#include "som/DataNormalizer.hpp"
 #include "som/Network.hpp"
 
 namespace lms::recommendation
@@ -13,6 +17,20 @@ namespace lms::recommendation
     class FeaturesEngineCache
     {
     public:
+        // What is needed to classify new tracks without retraining the network
+        struct TrainingState
+        {
+            som::DataNormalizer dataNormalizer;
+            double referenceQuantizationError{};  // mean quantization error of the training samples
+            double addedQuantizationErrorSum{};   // sum of the quantization errors of the tracks classified since the training
+            std::size_t addedTrackCount{};        // number of tracks classified since the training
+        };
+
+        // Features the positions of each track were computed from: replaced features are classified again
+        using TrackFeaturesIds = std::unordered_map<db::TrackId, db::TrackFeaturesId>;
+        // Features that cannot be used (parse error, dimension mismatch): not retried until they are replaced
+        using FailedTrackFeaturesIds = std::unordered_set<db::TrackFeaturesId>;
+
         static void invalidate();
 
         static std::optional<FeaturesEngineCache> read();
@@ -21,16 +39,23 @@ namespace lms::recommendation
     private:
         using TrackPositions = std::unordered_map<db::TrackId, std::vector<som::Position>>;
 
-        FeaturesEngineCache(som::Network network, TrackPositions trackPositions);
+        FeaturesEngineCache(som::Network network, TrackPositions trackPositions, TrackFeaturesIds trackFeaturesIds = {}, FailedTrackFeaturesIds failedTrackFeaturesIds = {}, std::optional<TrainingState> trainingState = std::nullopt);
+
+        static std::optional<FeaturesEngineCache> readFromBinaryCacheFile(const std::filesystem::path& path);
+        bool writeToBinaryCacheFile(const std::filesystem::path& path) const;
 
+        // Legacy XML format, only read to migrate existing caches
+        static std::optional<FeaturesEngineCache> readFromLegacyCacheFiles();
         static std::optional<som::Network> createNetworkFromCacheFile(const std::filesystem::path& path);
         static std::optional<TrackPositions> createObjectPositionsFromCacheFile(const std::filesystem::path& path);
-        static bool objectPositionToCacheFile(const TrackPositions& trackPositions, const std::filesystem::path& path);
 
         friend class FeaturesEngine;
 
         som::Network _network;
         TrackPositions _trackPositions;
+        TrackFeaturesIds _trackFeaturesIds;             // not set for caches migrated from the legacy format
+        FailedTrackFeaturesIds _failedTrackFeaturesIds;
+        std::optional<TrainingState> _trainingState; // not set for caches migrated from the legacy format
     };
 
 } // namespace lms::recommendation
@@ -2,11 +2,9 @@
 #include "ConsecutiveArtists.hpp"
 
 #include <algorithm>
+#include <cassert>
 
-#include "database/IDb.hpp"
-#include "database/Session.hpp"
-#include "database/objects/Release.hpp"
-#include "database/objects/Track.hpp"
+#include "services/recommendation/Types.hpp"
 
 namespace lms::recommendation::PlaylistGeneratorConstraint
 {
@@ -24,51 +22,20 @@ namespace lms::recommendation::PlaylistGeneratorConstraint
         }
     } // namespace
 
-    ConsecutiveArtists::ConsecutiveArtists(db::IDb& db)
-        : _db{ db }
+    std::optional<std::size_t> ConsecutiveArtists::getMaxDistance() const
     {
+        return 2;
     }
 
-    float ConsecutiveArtists::computeScore(const std::vector<db::TrackId>& trackIds, std::size_t trackIndex)
+    float ConsecutiveArtists::computeScore(const TrackMetadataSnapshot& snapshot, db::TrackId trackId, db::TrackId otherTrackId, std::size_t distance) const
     {
-        assert(!trackIds.empty());
-        assert(trackIndex <= trackIds.size() - 1);
+        assert(distance > 0);
 
-        const ArtistContainer artists{ getArtists(trackIds[trackIndex]) };
+        const TrackMetadata* metadata{ snapshot.find(trackId) };
+        const TrackMetadata* otherMetadata{ snapshot.find(otherTrackId) };
+        if (!metadata || !otherMetadata)
+            return 0;
 
-        constexpr std::size_t rangeSize{ 3 }; // check up to rangeSize tracks before/after the target track
-        static_assert(rangeSize > 0);
-
-        float score{};
-        for (std::size_t i{ 1 }; i < rangeSize; ++i)
-        {
-            if (trackIndex >= i)
-                score += countCommonArtists(artists, getArtists(trackIds[trackIndex - i])) / static_cast<float>(i);
-
-            if (trackIndex + i < trackIds.size())
-                score += countCommonArtists(artists, getArtists(trackIds[trackIndex + i])) / static_cast<float>(i);
-        }
-
-        return score;
-    }
-
-    ArtistContainer ConsecutiveArtists::getArtists(db::TrackId trackId)
-    {
-        using namespace db;
-
-        ArtistContainer res;
-
-        Session& dbSession{ _db.getTLSSession() };
-        auto transaction{ dbSession.createReadTransaction() };
-
-        const Track::pointer track{ Track::find(dbSession, trackId) };
-        if (!track)
-            return res;
-
-        res = track->getArtistIds({});
-        std::sort(std::begin(res), std::end(res));
-
-        return res;
+        return countCommonArtists(metadata->artistIds, otherMetadata->artistIds) / static_cast<float>(distance);
     }
-
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
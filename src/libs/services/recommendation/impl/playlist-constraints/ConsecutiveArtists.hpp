@@ -3,25 +3,12 @@
 
 #include "IConstraint.hpp"
 
-namespace lms::db
-{
-    class IDb;
-}
-
 namespace lms::recommendation::PlaylistGeneratorConstraint
 {
     class ConsecutiveArtists : public IConstraint
     {
-    public:
-        ConsecutiveArtists(db::IDb& db);
-        ~ConsecutiveArtists() override = default;
-        ConsecutiveArtists(const ConsecutiveArtists&) = delete;
-        ConsecutiveArtists& operator=(const ConsecutiveArtists&) = delete;
-
     private:
-        float computeScore(const TrackContainer& trackIds, std::size_t trackIndex) override;
-        ArtistContainer getArtists(db::TrackId trackId);
-
-        db::IDb& _db;
+        std::optional<std::size_t> getMaxDistance() const override;
+        float computeScore(const TrackMetadataSnapshot& snapshot, db::TrackId trackId, db::TrackId otherTrackId, std::size_t distance) const override;
     };
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
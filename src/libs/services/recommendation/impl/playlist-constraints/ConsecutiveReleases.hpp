@@ -3,28 +3,12 @@
 
 #include "IConstraint.hpp"
 
-#include "database/objects/ReleaseId.hpp"
-
-namespace lms::db
-{
-    class IDb;
-}
-
 namespace lms::recommendation::PlaylistGeneratorConstraint
 {
     class ConsecutiveReleases : public IConstraint
     {
-    public:
-        ConsecutiveReleases(db::IDb& db);
-        ~ConsecutiveReleases() override = default;
-        ConsecutiveReleases(const ConsecutiveReleases&) = delete;
-        ConsecutiveReleases& operator=(const ConsecutiveReleases&) = delete;
-
     private:
-        float computeScore(const std::vector<db::TrackId>& trackIds, std::size_t trackIndex) override;
-
-        db::ReleaseId getReleaseId(db::TrackId trackId);
-
-        db::IDb& _db;
+        std::optional<std::size_t> getMaxDistance() const override;
+        float computeScore(const TrackMetadataSnapshot& snapshot, db::TrackId trackId, db::TrackId otherTrackId, std::size_t distance) const override;
     };
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
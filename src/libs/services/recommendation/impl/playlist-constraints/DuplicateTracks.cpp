@@ -1,13 +1,15 @@
 
 #include "DuplicateTracks.hpp"
 
-#include <algorithm>
-
 namespace lms::recommendation::PlaylistGeneratorConstraint
 {
-    float DuplicateTracks::computeScore(const std::vector<db::TrackId>& trackIds, std::size_t trackIndex)
+    std::optional<std::size_t> DuplicateTracks::getMaxDistance() const
+    {
+        return std::nullopt; // whole playlist
+    }
+
+    float DuplicateTracks::computeScore(const TrackMetadataSnapshot& /*snapshot*/, db::TrackId trackId, db::TrackId otherTrackId, std::size_t /*distance*/) const
     {
-        const auto count{ std::count(std::cbegin(trackIds), std::cend(trackIds), trackIds[trackIndex]) };
-        return count == 1 ? 0 : 1'000;
+        return trackId == otherTrackId ? 1'000 : 0;
     }
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
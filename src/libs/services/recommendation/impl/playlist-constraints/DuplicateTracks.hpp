@@ -8,6 +8,7 @@ namespace lms::recommendation::PlaylistGeneratorConstraint
     class DuplicateTracks : public IConstraint
     {
     private:
-        float computeScore(const std::vector<db::TrackId>& trackIds, std::size_t trackIndex) override;
+        std::optional<std::size_t> getMaxDistance() const override;
+        float computeScore(const TrackMetadataSnapshot& snapshot, db::TrackId trackId, db::TrackId otherTrackId, std::size_t distance) const override;
     };
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
@@ -1,7 +1,12 @@
 
 #pragma once
 
-#include "services/recommendation/Types.hpp"
+#include <cstddef>
+#include <optional>
+
+#include "database/objects/TrackId.hpp"
+
+#include "TrackMetadataSnapshot.hpp"
 
 namespace lms::recommendation::PlaylistGeneratorConstraint
 {
@@ -10,10 +15,15 @@ namespace lms::recommendation::PlaylistGeneratorConstraint
     public:
         virtual ~IConstraint() = default;
 
-        // compute the score of the track at index trackIndex
+        // tracks further apart than this distance do not affect each other
+        // no max distance: the whole playlist is taken into account, and the score must not depend on the distance nor on the snapshot
+        virtual std::optional<std::size_t> getMaxDistance() const = 0;
+
+        // compute the score of the track trackId, placed 'distance' tracks away from otherTrackId (1 = consecutive tracks)
+        // the score of a track in a playlist is the sum of its scores against all the other tracks
         // 0: best
         // 1: worst
         // > 1 : violation
-        virtual float computeScore(const TrackContainer& trackIds, std::size_t trackIndex) = 0;
+        virtual float computeScore(const TrackMetadataSnapshot& snapshot, db::TrackId trackId, db::TrackId otherTrackId, std::size_t distance) const = 0;
     };
 } // namespace lms::recommendation::PlaylistGeneratorConstraint
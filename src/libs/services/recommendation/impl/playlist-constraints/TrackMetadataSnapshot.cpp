@@ -0,0 +1,49 @@
+
+#include "TrackMetadataSnapshot.hpp"
+
+#include <algorithm>
+
+#include "database/Session.hpp"
+#include "database/objects/Artist.hpp"
+#include "database/objects/Track.hpp"
+#include "database/objects/TrackArtistLink.hpp"
+
+namespace lms::recommendation::PlaylistGeneratorConstraint
+{
+    using namespace db;
+
+    TrackMetadataSnapshot::TrackMetadataSnapshot(Session& session, std::span<const TrackId> trackIds)
+    {
+        constexpr std::size_t readBatchSize{ 100 };
+
+        auto transaction{ session.createReadTransaction() };
+
+        for (std::size_t offset{}; offset < trackIds.size(); offset += readBatchSize)
+        {
+            const std::span<const TrackId> batch{ trackIds.subspan(offset, std::min(readBatchSize, trackIds.size() - offset)) };
+
+            Track::find(session, batch, [&](const Track::pointer& track) {
+                TrackMetadata& metadata{ _metadata[track->getId()] };
+                metadata.releaseId = track->getReleaseId();
+                metadata.duration = track->getDuration();
+            });
+
+            TrackArtistLink::find(session, batch, [&](const TrackArtistLink::pointer& link, const ObjectPtr<Artist>& artist) {
+                if (const auto it{ _metadata.find(link->getTrackId()) }; it != std::end(_metadata))
+                    it->second.artistIds.push_back(artist->getId());
+            });
+        }
+
+        for (auto& [trackId, metadata] : _metadata)
+        {
+            std::sort(std::begin(metadata.artistIds), std::end(metadata.artistIds));
+            metadata.artistIds.erase(std::unique(std::begin(metadata.artistIds), std::end(metadata.artistIds)), std::end(metadata.artistIds));
+        }
+    }
+
+    const TrackMetadata* TrackMetadataSnapshot::find(TrackId trackId) const
+    {
+        const auto it{ _metadata.find(trackId) };
+        return it != std::cend(_metadata) ? &it->second : nullptr;
+    }
+} // namespace lms::recommendation::PlaylistGeneratorConstraint
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include <chrono>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "database/objects/ArtistId.hpp"
+#include "database/objects/ReleaseId.hpp"
+#include "database/objects/TrackId.hpp"
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::recommendation::PlaylistGeneratorConstraint
+{
+    struct TrackMetadata
+    {
+        std::vector<db::ArtistId> artistIds; // sorted, no duplicates
+        db::ReleaseId releaseId;
+        std::chrono::milliseconds duration{};
+    };
+
+    // TrackMetadataSnapshot: 一次生成播放列表所需的曲目元数据快照（一次性批量加载），避免约束计算时反复查询数据库。
+    // TrackMetadataSnapshot: снимок метаданных треков (загружается пакетно один раз) для расчёта ограничений без повторных запросов к БД.
+    class TrackMetadataSnapshot
+    {
+    public:
+        TrackMetadataSnapshot(db::Session& session, std::span<const db::TrackId> trackIds);
+
+        // nullptr if the track does not exist (anymore)
+        const TrackMetadata* find(db::TrackId trackId) const;
+
+    private:
+        std::unordered_map<db::TrackId, TrackMetadata> _metadata;
+    };
+} // namespace lms::recommendation::PlaylistGeneratorConstraint
@@ -23,7 +23,8 @@ namespace lms::recommendation
     public:
         virtual ~IRecommendationService() = default;
 
-        virtual void load() = 0;
+        virtual void load() = 0;   // selects the engine from the scan settings and loads it
+        virtual void reload() = 0; // reloads the current engine, for instance after a scan
 
         virtual TrackContainer findSimilarTracks(db::TrackListId tracklistId, std::size_t maxCount) const = 0;
         virtual TrackContainer findSimilarTracks(const std::vector<db::TrackId>& tracksId, std::size_t maxCount) const = 0;
@@ -0,0 +1,133 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+#include "steps/DirectoryWalker.hpp"
+
+namespace lms::scanner
+{
+    namespace
+    {
+        // artist/album/track layout, like most media libraries
+        constexpr std::size_t artistCount{ 100 };
+        constexpr std::size_t albumCountPerArtist{ 5 };
+        constexpr std::size_t trackCountPerAlbum{ 20 };
+        const std::filesystem::path excludeDirFileName{ ".lmsignore" };
+
+        class GeneratedTree
+        {
+        public:
+            GeneratedTree()
+                : _rootDirectory{ std::filesystem::temp_directory_path() / ("lms-bench-walker-" + std::to_string(::getpid())) }
+            {
+                for (std::size_t artist{}; artist < artistCount; ++artist)
+                {
+                    for (std::size_t album{}; album < albumCountPerArtist; ++album)
+                    {
+                        const std::filesystem::path albumDirectory{ _rootDirectory / ("artist " + std::to_string(artist)) / ("album " + std::to_string(album)) };
+                        std::filesystem::create_directories(albumDirectory);
+
+                        for (std::size_t track{}; track < trackCountPerAlbum; ++track)
+                            std::ofstream{ albumDirectory / ("track " + std::to_string(track) + ".mp3") } << "data";
+                        std::ofstream{ albumDirectory / "cover.jpg" } << "data";
+                    }
+                }
+            }
+
+            ~GeneratedTree()
+            {
+                std::error_code ec;
+                std::filesystem::remove_all(_rootDirectory, ec);
+            }
+
+            GeneratedTree(const GeneratedTree&) = delete;
+            GeneratedTree& operator=(const GeneratedTree&) = delete;
+
+            const std::filesystem::path& getRootDirectory() const { return _rootDirectory; }
+
+        private:
+            const std::filesystem::path _rootDirectory;
+        };
+
+        const GeneratedTree& getGeneratedTree()
+        {
+            static const GeneratedTree tree;
+            return tree;
+        }
+
+        // Former exploration: recursive directory_iterator, exclude file probed in each directory, size and time queried for each file
+        bool exploreFilesRecursive(const std::filesystem::path& directory, std::size_t& fileCount)
+        {
+            std::error_code ec;
+            std::filesystem::directory_iterator itPath{ directory, std::filesystem::directory_options::follow_directory_symlink, ec };
+            if (ec)
+                return true;
+
+            if (std::filesystem::exists(directory / excludeDirFileName, ec))
+                return true;
+
+            std::filesystem::directory_iterator itEnd;
+            while (itPath != itEnd)
+            {
+                const std::filesystem::directory_entry& entry{ *itPath };
+
+                if (entry.is_regular_file())
+                {
+                    benchmark::DoNotOptimize(entry.last_write_time());
+                    benchmark::DoNotOptimize(entry.file_size());
+                    fileCount++;
+                }
+                else if (entry.is_directory())
+                {
+                    if (!exploreFilesRecursive(entry.path(), fileCount))
+                        return false;
+                }
+
+                itPath.increment(ec);
+            }
+
+            return true;
+        }
+
+        void BM_ExploreFilesRecursive(benchmark::State& state)
+        {
+            const GeneratedTree& tree{ getGeneratedTree() };
+
+            for (auto _ : state)
+            {
+                std::size_t fileCount{};
+                exploreFilesRecursive(tree.getRootDirectory(), fileCount);
+                benchmark::DoNotOptimize(fileCount);
+            }
+        }
+
+        void BM_WalkDirectoryTree(benchmark::State& state)
+        {
+            const GeneratedTree& tree{ getGeneratedTree() };
+            const std::size_t threadCount{ static_cast<std::size_t>(state.range(0)) };
+
+            for (auto _ : state)
+            {
+                std::atomic<std::size_t> fileCount{};
+                walkDirectoryTree(
+                    tree.getRootDirectory(), excludeDirFileName, threadCount,
+                    [&](std::vector<ExploredFile>&& files) {
+                        fileCount += files.size();
+                        return true;
+                    },
+                    [](const std::filesystem::path&, std::error_code) { return true; });
+                benchmark::DoNotOptimize(fileCount.load());
+            }
+        }
+    } // namespace
+
+    BENCHMARK(BM_ExploreFilesRecursive)->Unit(benchmark::kMillisecond);
+    BENCHMARK(BM_WalkDirectoryTree)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace lms::scanner
+
+BENCHMARK_MAIN();
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <unordered_set>
+
+#include "scanners/Utils.hpp"
+
+namespace lms::scanner
+{
+    // ExploredFiles: 浏览媒体库时找到的、可被扫描的文件集合（仅保存路径哈希），用于在不重新访问文件系统的情况下检测被删除的文件。
+    // ExploredFiles: множество файлов, найденных при обходе медиатек и поддерживаемых сканерами (хранятся только хеши путей), позволяет находить удалённые файлы без повторного обращения к файловой системе.
+    class ExploredFiles
+    {
+    public:
+        void add(const std::filesystem::path& filePath) { _pathHashes.insert(utils::getPathHash(filePath)); }
+        bool contains(const std::filesystem::path& filePath) const { return _pathHashes.contains(utils::getPathHash(filePath)); }
+        std::size_t getFileCount() const { return _pathHashes.size(); }
+
+    private:
+        std::unordered_set<std::uint64_t> _pathHashes;
+    };
+} // namespace lms::scanner
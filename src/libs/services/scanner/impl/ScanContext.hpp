@@ -1,9 +1,13 @@
 
 #pragma once
 
+#include <optional>
+
 #include "services/scanner/ScannerOptions.hpp"
 #include "services/scanner/ScannerStats.hpp"
 
+#include "ExploredFiles.hpp"
+
 namespace lms::scanner
 {
     // ScanContext: 一次扫描过程中在各个步骤之间传递的共享上下文（选项 + 全局统计 + 当前步骤统计）。
@@ -13,5 +17,9 @@ namespace lms::scanner
         ScanOptions scanOptions;
         ScanStats stats;
         ScanStepStats currentStepStats;
+
+        // Files found while exploring the media libraries, used to detect removed files
+        // Not set if the exploration is incomplete or if this detection mode is disabled
+        std::optional<ExploredFiles> exploredFiles;
     };
 } // namespace lms::scanner
\ No newline at end of file
@@ -134,6 +134,18 @@ namespace lms::scanner
             return threadCount;
         }
 
+        core::JobSchedulerType getScannerJobSchedulerType()
+        {
+            const std::string_view type{ core::Service<core::IConfig>::get()->getString("scanner-job-scheduler", "io-context") };
+            if (type == "work-stealing")
+                return core::JobSchedulerType::WorkStealing;
+
+            if (type != "io-context")
+                LMS_LOG(DBUPDATER, WARNING, "Unknown scanner job scheduler '" << type << "', using 'io-context'");
+
+            return core::JobSchedulerType::IOContext;
+        }
+
     } // namespace
 
     // 工厂函数：创建 ScannerService 实例。
@@ -145,7 +157,7 @@ namespace lms::scanner
 
         ScannerService::ScannerService(db::IDb& db, const std::filesystem::path& cachePath)
         : _db{ db }
-        , _jobScheduler{ core::createJobScheduler("Scanner", getScannerThreadCount()) }
+        , _jobScheduler{ core::createJobScheduler("Scanner", getScannerThreadCount(), getScannerJobSchedulerType()) }
         , _cachePath{ cachePath }
     {
         _ioService.setThreadCount(1);
@@ -373,6 +385,10 @@ namespace lms::scanner
         }
 
         refreshTracingLoggerStats();
+        {
+            const core::IJobScheduler::Metrics metrics{ _jobScheduler->getMetrics() };
+            LMS_LOG(DBUPDATER, DEBUG, "Job scheduler: executed jobs = " << metrics.executedJobCount << ", total wait time = " << metrics.totalWaitTime.count() << "us (max = " << metrics.maxWaitTime.count() << "us), total run time = " << metrics.totalRunTime.count() << "us (max = " << metrics.maxRunTime.count() << "us)");
+        }
         LMS_LOG(DBUPDATER, INFO, "Scan " << (_abortScan ? "aborted" : "complete") << ". Changes = " << stats.getChangesCount() << " (added = " << stats.additions << ", removed = " << stats.deletions << ", updated = " << stats.updates << ", failures = " << stats.failures << "), Not changed = " << stats.skips << ", Scanned = " << stats.scans << " (errors = " << stats.errorsCount << "), features fetched = " << stats.featuresFetched << ",  duplicates = " << stats.duplicates.size());
 
         {
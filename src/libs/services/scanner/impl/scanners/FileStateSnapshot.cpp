@@ -0,0 +1,35 @@
+
+#include "FileStateSnapshot.hpp"
+
+#include "Utils.hpp"
+
+namespace lms::scanner
+{
+    FileStateSnapshot::FileStateSnapshot(std::size_t currentScanVersion)
+        : _currentScanVersion{ currentScanVersion }
+    {
+    }
+
+    void FileStateSnapshot::add(const std::filesystem::path& filePath, const FileState& fileState)
+    {
+        const auto [it, inserted]{ _fileStates.emplace(utils::getPathHash(filePath), fileState) };
+        if (!inserted)
+        {
+            // hash collision: the files sharing this hash will always be scanned
+            it->second = FileState{};
+        }
+    }
+
+    bool FileStateSnapshot::needsScan(const FileToScan& file) const
+    {
+        const auto it{ _fileStates.find(utils::getPathHash(file.filePath)) };
+        if (it == std::cend(_fileStates))
+            return true;
+
+        const FileState& fileState{ it->second };
+        return !fileState.lastWriteTime.isValid()
+            || fileState.lastWriteTime != file.lastWriteTime
+            || fileState.fileSize != file.fileSize
+            || fileState.scanVersion != _currentScanVersion;
+    }
+} // namespace lms::scanner
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+
+#include <Wt/WDateTime.h>
+
+#include "FileToScan.hpp"
+
+namespace lms::scanner
+{
+    // FileStateSnapshot: 扫描开始时一次性加载的已知文件状态（路径哈希 → 修改时间、大小、扫描版本），扫描任务只读共享，用于跳过未修改的文件。
+    // FileStateSnapshot: состояние известных файлов (хеш пути → время изменения, размер, версия сканирования), загружается один раз в начале сканирования и только читается задачами, чтобы пропускать неизменённые файлы.
+    class FileStateSnapshot
+    {
+    public:
+        struct FileState
+        {
+            Wt::WDateTime lastWriteTime;
+            std::size_t fileSize{};
+            std::size_t scanVersion{};
+        };
+
+        explicit FileStateSnapshot(std::size_t currentScanVersion);
+
+        void add(const std::filesystem::path& filePath, const FileState& fileState);
+        std::size_t getFileCount() const { return _fileStates.size(); }
+
+        // Unknown files need to be scanned
+        bool needsScan(const FileToScan& file) const;
+
+    private:
+        const std::size_t _currentScanVersion;
+        std::unordered_map<std::uint64_t, FileState> _fileStates; // keyed by path hash, to keep the snapshot small
+    };
+} // namespace lms::scanner
@@ -2,14 +2,17 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <span>
 
+#include "core/IJobScheduler.hpp"
 #include "core/LiteralString.hpp"
 
 #include "FileToScan.hpp"
 
 namespace lms::scanner
 {
+    class FileStateSnapshot;
     class IFileScanOperation;
 
     class IFileScanner
@@ -18,9 +21,13 @@ namespace lms::scanner
         virtual ~IFileScanner() = default;
 
         virtual core::LiteralString getName() const = 0;
+        virtual core::JobPriority getScanPriority() const = 0; // priority of the jobs scanning the supported files
         virtual std::span<const std::filesystem::path> getSupportedFiles() const = 0;
         virtual std::span<const std::filesystem::path> getSupportedExtensions() const = 0;
         virtual bool needsScan(const FileToScan& file) const = 0;
+
+        // Optional bulk alternative to needsScan: returns nullptr if not supported by the scanner
+        virtual std::unique_ptr<FileStateSnapshot> createFileStateSnapshot(const MediaLibraryInfo& mediaLibrary) const = 0;
         virtual std::unique_ptr<IFileScanOperation> createScanOperation(FileToScan&& fileToScan) const = 0;
     };
 } // namespace lms::scanner
\ No newline at end of file
@@ -15,6 +15,7 @@
 #include "services/scanner/ScanErrors.hpp"
 
 #include "FileScanOperationBase.hpp"
+#include "FileStateSnapshot.hpp"
 #include "IFileScanOperation.hpp"
 #include "Utils.hpp"
 
@@ -102,6 +103,12 @@ namespace lms::scanner
         return "Image scanner";
     }
 
+    core::JobPriority ImageFileScanner::getScanPriority() const
+    {
+        // artwork only: the other pending files are scanned first
+        return core::JobPriority::Low;
+    }
+
     std::span<const std::filesystem::path> ImageFileScanner::getSupportedFiles() const
     {
         return {};
@@ -121,6 +128,11 @@ namespace lms::scanner
         return (!image || image->getLastWriteTime() != file.lastWriteTime);
     }
 
+    std::unique_ptr<FileStateSnapshot> ImageFileScanner::createFileStateSnapshot([[maybe_unused]] const MediaLibraryInfo& mediaLibrary) const
+    {
+        return nullptr;
+    }
+
     std::unique_ptr<IFileScanOperation> ImageFileScanner::createScanOperation(FileToScan&& fileToScan) const
     {
         return std::make_unique<ImageFileScanOperation>(std::move(fileToScan), _db, _settings);
@@ -1,9 +1,11 @@
 
 #include "Utils.hpp"
 
+#include <span>
 #include <system_error>
 
 #include "core/Path.hpp"
+#include "core/XxHash3.hpp"
 #include "database/Session.hpp"
 #include "database/objects/Directory.hpp"
 #include "database/objects/MediaLibrary.hpp"
@@ -27,4 +29,9 @@ namespace lms::scanner::utils
 
         return directory;
     }
+
+    std::uint64_t getPathHash(const std::filesystem::path& path)
+    {
+        return core::xxHash3_64(std::as_bytes(std::span{ path.native() }));
+    }
 } // namespace lms::scanner::utils
\ No newline at end of file
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 
 #include "database/Object.hpp"
@@ -15,4 +16,7 @@ namespace lms::db
 namespace lms::scanner::utils
 {
     db::ObjectPtr<db::Directory> getOrCreateDirectory(db::Session& session, const std::filesystem::path& path, const db::ObjectPtr<db::MediaLibrary>& mediaLibrary);
+
+    // Used to index large sets of files in memory, collisions are very unlikely for a few million paths
+    std::uint64_t getPathHash(const std::filesystem::path& path);
 } // namespace lms::scanner::utils
\ No newline at end of file
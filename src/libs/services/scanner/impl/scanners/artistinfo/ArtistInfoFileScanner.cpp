@@ -18,6 +18,7 @@
 #include "ScannerSettings.hpp"
 #include "helpers/ArtistHelpers.hpp"
 #include "scanners/FileScanOperationBase.hpp"
+#include "scanners/FileStateSnapshot.hpp"
 #include "scanners/Utils.hpp"
 #include "scanners/artistinfo/ArtistInfoParser.hpp"
 #include "types/ArtistInfo.hpp"
@@ -147,6 +148,11 @@ namespace lms::scanner
         return "Artist info scanner";
     }
 
+    core::JobPriority ArtistInfoFileScanner::getScanPriority() const
+    {
+        return core::JobPriority::Normal;
+    }
+
     std::span<const std::filesystem::path> ArtistInfoFileScanner::getSupportedFiles() const
     {
         return getSupportedArtistInfoFiles();
@@ -173,6 +179,11 @@ namespace lms::scanner
             || artistInfo->getScanVersion() != _settings.artistInfoScanVersion;
     }
 
+    std::unique_ptr<FileStateSnapshot> ArtistInfoFileScanner::createFileStateSnapshot([[maybe_unused]] const MediaLibraryInfo& mediaLibrary) const
+    {
+        return nullptr;
+    }
+
     std::unique_ptr<IFileScanOperation> ArtistInfoFileScanner::createScanOperation(FileToScan&& fileToScan) const
     {
         return std::make_unique<ArtistInfoFileScanOperation>(std::move(fileToScan), _db, _settings);
@@ -12,6 +12,7 @@
 #include "database/objects/Track.hpp"
 
 #include "ScannerSettings.hpp"
+#include "scanners/FileStateSnapshot.hpp"
 #include "scanners/Utils.hpp"
 #include "scanners/audiofile/AudioFileScanOperation.hpp"
 #include "scanners/audiofile/TrackMetadataParser.hpp"
@@ -71,6 +72,12 @@ namespace lms::scanner
         return "Audio scanner";
     }
 
+    core::JobPriority AudioFileScanner::getScanPriority() const
+    {
+        // tracks show up in the database early in the scan
+        return core::JobPriority::High;
+    }
+
     std::span<const std::filesystem::path> AudioFileScanner::getSupportedFiles() const
     {
         return {};
@@ -89,9 +96,36 @@ namespace lms::scanner
         std::optional<db::FileInfo> fileInfo{ db::Track::findFileInfo(dbSession, file.filePath) };
         return !fileInfo
             || fileInfo->lastWrittenTime != file.lastWriteTime
+            || fileInfo->fileSize != file.fileSize
             || fileInfo->scanVersion != _settings.audioScanVersion;
     }
 
+    std::unique_ptr<FileStateSnapshot> AudioFileScanner::createFileStateSnapshot(const MediaLibraryInfo& mediaLibrary) const
+    {
+        constexpr std::size_t batchSize{ 1'000 };
+
+        auto snapshot{ std::make_unique<FileStateSnapshot>(_settings.audioScanVersion) };
+
+        db::Session& dbSession{ _db.getTLSSession() };
+
+        db::TrackId lastRetrievedId;
+        bool endReached{};
+        while (!endReached)
+        {
+            // small read transactions, not to block the writers for too long
+            auto transaction{ dbSession.createReadTransaction() };
+
+            const db::TrackId previousLastRetrievedId{ lastRetrievedId };
+            db::Track::findFileInfo(dbSession, mediaLibrary.id, lastRetrievedId, batchSize, [&](const std::filesystem::path& filePath, const db::FileInfo& fileInfo) {
+                snapshot->add(filePath, FileStateSnapshot::FileState{ fileInfo.lastWrittenTime, fileInfo.fileSize, fileInfo.scanVersion });
+            });
+
+            endReached = (lastRetrievedId == previousLastRetrievedId);
+        }
+
+        return snapshot;
+    }
+
     std::unique_ptr<IFileScanOperation> AudioFileScanner::createScanOperation(FileToScan&& fileToScan) const
     {
         return std::make_unique<AudioFileScanOperation>(std::move(fileToScan), _db, _settings, _trackMetadataParser, _parserOptions);
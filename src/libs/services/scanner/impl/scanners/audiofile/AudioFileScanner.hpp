@@ -33,9 +33,11 @@ namespace lms::scanner
 
     private:
         core::LiteralString getName() const override;
+        core::JobPriority getScanPriority() const override;
         std::span<const std::filesystem::path> getSupportedFiles() const override;
         std::span<const std::filesystem::path> getSupportedExtensions() const override;
         bool needsScan(const FileToScan& file) const override;
+        std::unique_ptr<FileStateSnapshot> createFileStateSnapshot(const MediaLibraryInfo& mediaLibrary) const override;
         std::unique_ptr<IFileScanOperation> createScanOperation(FileToScan&& fileToScan) const override;
 
         db::IDb& _db;
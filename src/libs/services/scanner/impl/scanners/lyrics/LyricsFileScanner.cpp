@@ -14,6 +14,7 @@
 
 #include "ScannerSettings.hpp"
 #include "scanners/FileScanOperationBase.hpp"
+#include "scanners/FileStateSnapshot.hpp"
 #include "scanners/Utils.hpp"
 #include "scanners/lyrics/LyricsParser.hpp"
 #include "types/Lyrics.hpp"
@@ -110,6 +111,11 @@ namespace lms::scanner
         return "Lyrics scanner";
     }
 
+    core::JobPriority LyricsFileScanner::getScanPriority() const
+    {
+        return core::JobPriority::Normal;
+    }
+
     std::span<const std::filesystem::path> LyricsFileScanner::getSupportedFiles() const
     {
         return {};
@@ -129,6 +135,11 @@ namespace lms::scanner
         return !lyrics || lyrics->getLastWriteTime() != file.lastWriteTime;
     }
 
+    std::unique_ptr<FileStateSnapshot> LyricsFileScanner::createFileStateSnapshot([[maybe_unused]] const MediaLibraryInfo& mediaLibrary) const
+    {
+        return nullptr;
+    }
+
     std::unique_ptr<IFileScanOperation> LyricsFileScanner::createScanOperation(FileToScan&& fileToScan) const
     {
         return std::make_unique<LyricsFileScanOperation>(std::move(fileToScan), _db, _settings);
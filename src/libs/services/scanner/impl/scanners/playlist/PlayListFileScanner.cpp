@@ -13,6 +13,7 @@
 #include "services/scanner/ScanErrors.hpp"
 
 #include "scanners/FileScanOperationBase.hpp"
+#include "scanners/FileStateSnapshot.hpp"
 #include "scanners/Utils.hpp"
 #include "scanners/playlist/PlayListParser.hpp"
 
@@ -107,6 +108,11 @@ namespace lms::scanner
         return "PlayList scanner";
     }
 
+    core::JobPriority PlayListFileScanner::getScanPriority() const
+    {
+        return core::JobPriority::Normal;
+    }
+
     std::span<const std::filesystem::path> PlayListFileScanner::getSupportedFiles() const
     {
         return {};
@@ -126,6 +132,11 @@ namespace lms::scanner
         return !playList || playList->getLastWriteTime() != file.lastWriteTime;
     }
 
+    std::unique_ptr<FileStateSnapshot> PlayListFileScanner::createFileStateSnapshot([[maybe_unused]] const MediaLibraryInfo& mediaLibrary) const
+    {
+        return nullptr;
+    }
+
     std::unique_ptr<IFileScanOperation> PlayListFileScanner::createScanOperation(FileToScan&& fileToScan) const
     {
         return std::make_unique<PlayListFileScanOperation>(std::move(fileToScan), _db, _settings);
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace lms::scanner
+{
+    // BoundedQueue: 线程间传递数据的有界阻塞队列，用于连接流水线的各个阶段。
+    // BoundedQueue: ограниченная блокирующая очередь для передачи данных между стадиями конвейера.
+    template<typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(std::size_t maxSize)
+            : _maxSize{ maxSize } {}
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // Blocks while the queue is full, returns false if the queue has been closed
+        bool push(T value)
+        {
+            {
+                std::unique_lock lock{ _mutex };
+                _notFullCondVar.wait(lock, [this] { return _values.size() < _maxSize || _closed; });
+                if (_closed)
+                    return false;
+
+                _values.push_back(std::move(value));
+            }
+            _notEmptyCondVar.notify_one();
+
+            return true;
+        }
+
+        // Blocks until a value is available, returns false if the queue is closed and empty
+        bool pop(T& value)
+        {
+            {
+                std::unique_lock lock{ _mutex };
+                _notEmptyCondVar.wait(lock, [this] { return !_values.empty() || _closed; });
+                if (_values.empty())
+                    return false;
+
+                value = std::move(_values.front());
+                _values.pop_front();
+            }
+            _notFullCondVar.notify_one();
+
+            return true;
+        }
+
+        // Accumulates values until maxCount values are popped, the queue is closed or the deadline is reached
+        // Values are popped as they come, so that producers are not blocked by a full queue meanwhile
+        // Returns false if the queue is closed and nothing was popped
+        bool popBatch(std::vector<T>& values, std::size_t maxCount, std::chrono::steady_clock::time_point deadline)
+        {
+            std::unique_lock lock{ _mutex };
+            while (true)
+            {
+                bool popped{};
+                while (!_values.empty() && values.size() < maxCount)
+                {
+                    values.push_back(std::move(_values.front()));
+                    _values.pop_front();
+                    popped = true;
+                }
+                if (popped)
+                    _notFullCondVar.notify_all();
+
+                if (values.size() >= maxCount || _closed)
+                    break;
+
+                if (!_notEmptyCondVar.wait_until(lock, deadline, [this] { return !_values.empty() || _closed; }))
+                    break;
+            }
+
+            return !values.empty() || !_closed;
+        }
+
+        // Wakes up all the waiting threads: pending values can still be popped, but nothing can be pushed anymore
+        void close()
+        {
+            {
+                std::scoped_lock lock{ _mutex };
+                _closed = true;
+            }
+            _notFullCondVar.notify_all();
+            _notEmptyCondVar.notify_all();
+        }
+
+    private:
+        const std::size_t _maxSize;
+        std::mutex _mutex;
+        std::condition_variable _notFullCondVar;
+        std::condition_variable _notEmptyCondVar;
+        std::deque<T> _values;
+        bool _closed{};
+    };
+} // namespace lms::scanner
@@ -0,0 +1,228 @@
+
+#include "DirectoryWalker.hpp"
+
+#include <cerrno>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/ILogger.hpp"
+
+namespace lms::scanner
+{
+    namespace
+    {
+        std::error_code getLastErrorCode()
+        {
+            return std::error_code{ errno, std::system_category() };
+        }
+
+        std::chrono::system_clock::time_point toTimePoint(const struct timespec& ts)
+        {
+            return std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds{ ts.tv_sec } + std::chrono::nanoseconds{ ts.tv_nsec }) };
+        }
+
+        struct DirectoryCloser
+        {
+            void operator()(DIR* dir) const { ::closedir(dir); }
+        };
+
+        // Reads all the entries of the directory at once (so that the exclude file is found without any extra syscall)
+        // Only regular files and directories (or symlinks to them) are reported, using a single stat for files
+        // Returns false if the exploration must stop
+        bool exploreDirectory(const std::filesystem::path& directory, const std::filesystem::path& excludeDirFileName, const ExploredFilesCallback& filesCallback, const ExploreErrorCallback& errorCallback, std::vector<std::filesystem::path>& subDirectories)
+        {
+            const int fd{ ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC) };
+            if (fd < 0)
+                return errorCallback(directory, getLastErrorCode());
+
+            std::unique_ptr<DIR, DirectoryCloser> dir{ ::fdopendir(fd) };
+            if (!dir)
+            {
+                const std::error_code ec{ getLastErrorCode() };
+                ::close(fd);
+                return errorCallback(directory, ec);
+            }
+
+            struct Entry
+            {
+                std::string name;
+                unsigned char type;
+            };
+            std::vector<Entry> entries;
+            bool excluded{};
+
+            while (true)
+            {
+                errno = 0;
+                const struct dirent* dirEntry{ ::readdir(dir.get()) };
+                if (!dirEntry)
+                {
+                    if (errno != 0 && !errorCallback(directory, getLastErrorCode()))
+                        return false;
+                    break;
+                }
+
+                const std::string_view name{ dirEntry->d_name };
+                if (name == "." || name == "..")
+                    continue;
+
+                if (!excludeDirFileName.empty() && name == excludeDirFileName.native())
+                    excluded = true;
+
+                entries.push_back(Entry{ std::string{ name }, dirEntry->d_type });
+            }
+
+            if (excluded)
+            {
+                LMS_LOG(DBUPDATER, DEBUG, "Found " << directory / excludeDirFileName << ": skipping directory");
+                return true;
+            }
+
+            std::vector<ExploredFile> files;
+            for (const Entry& entry : entries)
+            {
+                if (entry.type == DT_DIR)
+                {
+                    subDirectories.push_back(directory / entry.name);
+                    continue;
+                }
+
+                // DT_UNKNOWN is reported by some filesystems, DT_LNK has to be followed
+                if (entry.type != DT_REG && entry.type != DT_LNK && entry.type != DT_UNKNOWN)
+                    continue;
+
+                struct stat fileStat;
+                if (::fstatat(::dirfd(dir.get()), entry.name.c_str(), &fileStat, 0) != 0)
+                {
+                    // removed meanwhile or broken symlink
+                    if (errno == ENOENT)
+                        continue;
+
+                    if (!errorCallback(directory / entry.name, getLastErrorCode()))
+                        return false;
+                    continue;
+                }
+
+                if (S_ISDIR(fileStat.st_mode))
+                    subDirectories.push_back(directory / entry.name);
+                else if (S_ISREG(fileStat.st_mode))
+                    files.push_back(ExploredFile{ directory / entry.name, toTimePoint(fileStat.st_mtim), static_cast<std::size_t>(fileStat.st_size) });
+            }
+
+            if (!files.empty())
+                return filesCallback(std::move(files));
+
+            return true;
+        }
+
+        class ParallelWalker
+        {
+        public:
+            ParallelWalker(const std::filesystem::path& excludeDirFileName, const ExploredFilesCallback& filesCallback, const ExploreErrorCallback& errorCallback)
+                : _excludeDirFileName{ excludeDirFileName }
+                , _filesCallback{ filesCallback }
+                , _errorCallback{ errorCallback }
+            {
+            }
+
+            void walk(const std::filesystem::path& rootDirectory, std::size_t threadCount)
+            {
+                _pendingDirectories.push_back(rootDirectory);
+
+                std::vector<std::thread> threads;
+                for (std::size_t i{ 1 }; i < threadCount; ++i)
+                    threads.emplace_back([this] { run(); });
+
+                run();
+
+                for (std::thread& thread : threads)
+                    thread.join();
+
+                if (_exception)
+                    std::rethrow_exception(_exception);
+            }
+
+        private:
+            void run()
+            {
+                std::vector<std::filesystem::path> subDirectories;
+
+                while (true)
+                {
+                    std::filesystem::path directory;
+                    {
+                        std::unique_lock lock{ _mutex };
+                        _condVar.wait(lock, [this] { return _stopped || !_pendingDirectories.empty() || _activeCount == 0; });
+                        if (_stopped || _pendingDirectories.empty())
+                            break;
+
+                        // LIFO: explore depth first to keep the pending list small
+                        directory = std::move(_pendingDirectories.back());
+                        _pendingDirectories.pop_back();
+                        _activeCount++;
+                    }
+
+                    subDirectories.clear();
+                    bool continueExploring{};
+                    try
+                    {
+                        continueExploring = exploreDirectory(directory, _excludeDirFileName, _filesCallback, _errorCallback, subDirectories);
+                    }
+                    catch (...)
+                    {
+                        std::scoped_lock lock{ _mutex };
+                        if (!_exception)
+                            _exception = std::current_exception();
+                    }
+
+                    bool done{};
+                    {
+                        std::scoped_lock lock{ _mutex };
+                        _activeCount--;
+                        if (!continueExploring)
+                            _stopped = true;
+
+                        for (std::filesystem::path& subDirectory : subDirectories)
+                            _pendingDirectories.push_back(std::move(subDirectory));
+
+                        done = _stopped || (_pendingDirectories.empty() && _activeCount == 0);
+                    }
+
+                    if (done)
+                        _condVar.notify_all();
+                    else
+                    {
+                        for (std::size_t i{}; i < subDirectories.size(); ++i)
+                            _condVar.notify_one();
+                    }
+                }
+            }
+
+            const std::filesystem::path& _excludeDirFileName;
+            const ExploredFilesCallback& _filesCallback;
+            const ExploreErrorCallback& _errorCallback;
+
+            std::mutex _mutex;
+            std::condition_variable _condVar;
+            std::vector<std::filesystem::path> _pendingDirectories;
+            std::size_t _activeCount{}; // directories being explored
+            bool _stopped{};
+            std::exception_ptr _exception;
+        };
+    } // namespace
+
+    void walkDirectoryTree(const std::filesystem::path& rootDirectory, const std::filesystem::path& excludeDirFileName, std::size_t threadCount, const ExploredFilesCallback& filesCallback, const ExploreErrorCallback& errorCallback)
+    {
+        ParallelWalker walker{ excludeDirFileName, filesCallback, errorCallback };
+        walker.walk(rootDirectory, std::max<std::size_t>(threadCount, 1));
+    }
+} // namespace lms::scanner
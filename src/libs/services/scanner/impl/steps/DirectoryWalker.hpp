@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <system_error>
+#include <vector>
+
+namespace lms::scanner
+{
+    struct ExploredFile
+    {
+        std::filesystem::path path;
+        std::chrono::system_clock::time_point lastWriteTime;
+        std::size_t fileSize{};
+    };
+
+    // walkDirectoryTree: 使用多个线程并行遍历目录树，每个文件只做一次 stat，支持通过 excludeDirFileName 排除目录。
+    // walkDirectoryTree: параллельно обходит дерево каталогов в нескольких потоках, один stat на файл, поддерживает исключение каталогов по excludeDirFileName.
+    //
+    // Callbacks are called concurrently from the walker threads, returning false stops the exploration
+    // Directory symlinks are followed
+    using ExploredFilesCallback = std::function<bool(std::vector<ExploredFile>&& files)>; // regular files of a single directory
+    using ExploreErrorCallback = std::function<bool(const std::filesystem::path& path, std::error_code ec)>;
+    void walkDirectoryTree(const std::filesystem::path& rootDirectory, const std::filesystem::path& excludeDirFileName, std::size_t threadCount, const ExploredFilesCallback& filesCallback, const ExploreErrorCallback& errorCallback);
+} // namespace lms::scanner
@@ -23,9 +23,9 @@ namespace lms::scanner
         finish();
     }
 
-    void JobQueue::push(std::unique_ptr<core::IJob> job)
+    void JobQueue::push(std::unique_ptr<core::IJob> job, core::JobPriority priority)
     {
-        _scheduler.scheduleJob(std::move(job));
+        _scheduler.scheduleJob(std::move(job), priority);
         drainIfNeeded();
     }
 
@@ -6,10 +6,11 @@
 #include <span>
 #include <vector>
 
+#include "core/IJobScheduler.hpp"
+
 namespace lms::core
 {
     class IJob;
-    class IJobScheduler;
 } // namespace lms::core
 
 namespace lms::scanner
@@ -28,7 +29,7 @@ namespace lms::scanner
 
         // push 可能会阻塞并调用回调以处理已完成任务。
         // push может блокироваться и вызывать ProcessFunction для обработки завершённых задач.
-        void push(std::unique_ptr<core::IJob> job);
+        void push(std::unique_ptr<core::IJob> job, core::JobPriority priority = core::JobPriority::Normal);
         void finish();
 
     private:
@@ -224,6 +224,30 @@ namespace lms::scanner
             _progressCallback(context.currentStepStats);
         };
 
+        if (context.exploredFiles)
+        {
+            // All the files still present and supported have just been found while exploring the media libraries: no need to check them again
+            ObjectIdType lastCheckedId;
+            std::vector<FileToCheck<ObjectIdType>> filesToCheck;
+            while (!_abortScan && fetchNextFilesToCheck<Object>(session, lastCheckedId, getCachePath(), filesToCheck))
+            {
+                for (const FileToCheck<ObjectIdType>& fileToCheck : filesToCheck)
+                {
+                    if (!context.exploredFiles->contains(fileToCheck.file))
+                    {
+                        LMS_LOG(DBUPDATER, DEBUG, "Removing " << fileToCheck.file << ": not found while exploring media libraries");
+                        objectIdsToRemove.push_back(fileToCheck.objectId);
+                    }
+                }
+
+                context.currentStepStats.processedElems += filesToCheck.size();
+                if (!objectIdsToRemove.empty())
+                    context.stats.deletions += removeObjects<Object>(session, objectIdsToRemove, true);
+
+                _progressCallback(context.currentStepStats);
+            }
+        }
+        else
         {
             JobQueue queue{ getJobScheduler(), 50, processJobsDone, 1, 0.85F };
 
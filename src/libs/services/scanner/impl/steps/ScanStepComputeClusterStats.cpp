@@ -1,5 +1,8 @@
 
 #include "ScanStepComputeClusterStats.hpp"
+
+#include <vector>
+
 #include "core/ILogger.hpp"
 #include "database/IDb.hpp"
 #include "database/Session.hpp"
@@ -11,63 +14,64 @@ namespace lms::scanner
 {
     bool ScanStepComputeClusterStats::needProcess(const ScanContext& context) const
     {
-        return context.stats.getChangesCount() > 0;
+        if (context.scanOptions.fullScan)
+            return true;
+
+        // Clusters are flagged in the same transactions as the track changes: the ones left over by an aborted scan are processed too
+        db::Session& dbSession{ _db.getTLSSession() };
+        auto transaction{ dbSession.createReadTransaction() };
+        return db::Cluster::getStatsDirtyCount(dbSession) > 0;
     }
 
     void ScanStepComputeClusterStats::process(ScanContext& context)
     {
         using namespace db;
 
+        constexpr std::size_t batchSize{ 100 };
+
         Session& dbSession{ _db.getTLSSession() };
 
-        const std::size_t clusterCount{ [&] {
-            auto transaction{ dbSession.createReadTransaction() };
-            return Cluster::getCount(dbSession);
-        }() };
+        {
+            auto transaction{ dbSession.createWriteTransaction() };
 
-        context.currentStepStats.totalElems = clusterCount;
+            if (context.scanOptions.fullScan)
+                Cluster::markAllStatsDirty(dbSession);
 
-        foreachSubRange(Range{ 0, clusterCount }, 100, [&](Range range) {
-            const std::vector<ClusterId> clusterIds{ [&] {
-                Cluster::FindParameters params;
-                params.setRange(range);
+            context.currentStepStats.totalElems = Cluster::getStatsDirtyCount(dbSession);
+        }
 
-                {
-                    auto transaction{ dbSession.createReadTransaction() };
-                    return std::move(Cluster::findIds(dbSession, params).results);
-                }
-            }() };
+        std::size_t updatedClusterCount{};
+        while (!_abortScan)
+        {
+            std::size_t processedClusterCount{};
 
-            for (const ClusterId clusterId : clusterIds)
+            // one grouped query per batch, only the clusters whose stats actually changed are written
             {
-                if (_abortScan)
-                    break;
-
-                std::size_t trackCount;
-                std::size_t releaseCount;
-
-                {
-                    auto transaction{ dbSession.createReadTransaction() };
-
-                    trackCount = Cluster::computeTrackCount(dbSession, clusterId);
-                    releaseCount = Cluster::computeReleaseCount(dbSession, clusterId);
-                }
-
-                {
-                    auto transaction{ dbSession.createWriteTransaction() };
-
-                    auto cluster{ Cluster::find(dbSession, clusterId) };
-                    cluster.modify()->setTrackCount(trackCount);
-                    cluster.modify()->setReleaseCount(releaseCount);
-                }
-
-                context.currentStepStats.processedElems++;
-                _progressCallback(context.currentStepStats);
+                auto transaction{ dbSession.createWriteTransaction() };
+
+                const std::vector<ClusterId> clusterIds{ Cluster::findStatsDirtyIds(dbSession, batchSize) };
+                Cluster::computeStats(dbSession, clusterIds, [&](const Cluster::pointer& cluster, std::size_t trackCount, std::size_t releaseCount) {
+                    if (cluster->getTrackCount() == trackCount && cluster->getReleasesCount() == releaseCount)
+                        return;
+
+                    Cluster::pointer clusterToUpdate{ cluster };
+                    clusterToUpdate.modify()->setTrackCount(trackCount);
+                    clusterToUpdate.modify()->setReleaseCount(releaseCount);
+                    updatedClusterCount++;
+                });
+
+                // flags of clusters removed since then are cleared too
+                Cluster::clearStatsDirty(dbSession, clusterIds);
+                processedClusterCount = clusterIds.size();
             }
 
-            return true;
-        });
+            if (processedClusterCount == 0)
+                break;
+
+            context.currentStepStats.processedElems += processedClusterCount;
+            _progressCallback(context.currentStepStats);
+        }
 
-        LMS_LOG(DBUPDATER, DEBUG, "Recomputed stats for " << context.currentStepStats.processedElems << " clusters!");
+        LMS_LOG(DBUPDATER, DEBUG, "Recomputed stats for " << context.currentStepStats.processedElems << " clusters, " << updatedClusterCount << " updated!");
     }
 } // namespace lms::scanner
@@ -1,19 +1,31 @@
 
 #include "ScanStepScanFiles.hpp"
 
-#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
 
 #include "ScannerSettings.hpp"
+#include "core/IConfig.hpp"
 #include "core/IJob.hpp"
 #include "core/IJobScheduler.hpp"
 #include "core/ILogger.hpp"
 #include "core/ITraceLogger.hpp"
+#include "core/Service.hpp"
 #include "database/IDb.hpp"
 #include "database/Session.hpp"
+#include "scanners/FileStateSnapshot.hpp"
 #include "scanners/FileToScan.hpp"
 #include "scanners/IFileScanOperation.hpp"
 #include "scanners/IFileScanner.hpp"
 
+#include "BoundedQueue.hpp"
+#include "DirectoryWalker.hpp"
 #include "FileScanners.hpp"
 #include "JobQueue.hpp"
 #include "ScanContext.hpp"
@@ -22,57 +34,18 @@ namespace lms::scanner
 {
     namespace
     {
-        using ExploreFileCallback = std::function<bool(std::error_code, const std::filesystem::path& path, const std::filesystem::directory_entry*)>;
-        // exploreFilesRecursive: 递归遍历目录树，对每个文件/目录调用回调，支持通过 .lmsignore 排除目录。
-        // exploreFilesRecursive: рекурсивно обходит дерево каталогов, вызывает коллбек для каждого файла/каталога и поддерживает исключение по .lmsignore.
-        bool exploreFilesRecursive(const std::filesystem::path& directory, ExploreFileCallback cb, const std::filesystem::path* excludeDirFileName)
-        {
-            std::error_code ec;
-            std::filesystem::directory_iterator itPath{ directory, std::filesystem::directory_options::follow_directory_symlink, ec };
-
-            if (ec)
-            {
-                cb(ec, directory, nullptr);
-                return true; // try to continue exploring anyway
-            }
-
-            if (excludeDirFileName && !excludeDirFileName->empty())
-            {
-                const std::filesystem::path excludePath{ directory / *excludeDirFileName };
-                if (std::filesystem::exists(excludePath, ec))
-                {
-                    LMS_LOG(DBUPDATER, DEBUG, "Found " << excludePath << ": skipping directory");
-                    return true;
-                }
-            }
-
-            std::filesystem::directory_iterator itEnd;
-            while (itPath != itEnd)
-            {
-                bool continueExploring{ true };
+        using FileStateSnapshots = std::unordered_map<const IFileScanner*, std::unique_ptr<FileStateSnapshot>>;
 
-                const std::filesystem::directory_entry& entry{ *itPath };
-                const std::filesystem::path& path{ entry.path() };
-
-                if (ec)
-                {
-                    continueExploring = cb(ec, path, nullptr);
-                }
-                else
-                {
-                    if (entry.is_regular_file())
-                        continueExploring = cb(ec, path, &entry);
-                    else if (entry.is_directory())
-                        continueExploring = exploreFilesRecursive(path, cb, excludeDirFileName);
-                }
-
-                if (!continueExploring)
-                    return false;
-
-                itPath.increment(ec);
-            }
+        bool isRemovedFilesDetectionFromExplorationEnabled()
+        {
+            // saves a second filesystem pass in ScanStepCheckForRemovedFiles
+            return core::Service<core::IConfig>::get()->getBool("scanner-detect-removed-files-while-exploring", true);
+        }
 
-            return true;
+        std::size_t getWalkerThreadCount()
+        {
+            // exploring is mostly I/O bound, some parallelism helps on network and SSD storages
+            return std::max<std::size_t>(core::Service<core::IConfig>::get()->getULong("scanner-walker-thread-count", 4), 1);
         }
 
         // FileScanJob: 在工作线程中分析一批文件并生成 IFileScanOperation 列表。
@@ -80,8 +53,9 @@ namespace lms::scanner
         class FileScanJob : public core::IJob
         {
         public:
-            FileScanJob(const FileScanners& fileScanners, const MediaLibraryInfo& mediaLibrary, bool fullScan, std::span<const std::filesystem::directory_entry> files)
+            FileScanJob(const FileScanners& fileScanners, const FileStateSnapshots& fileStateSnapshots, const MediaLibraryInfo& mediaLibrary, bool fullScan, std::span<const ExploredFile> files)
                 : _fileScanners{ fileScanners }
+                , _fileStateSnapshots{ fileStateSnapshots }
                 , _mediaLibrary{ mediaLibrary }
                 , _fullScan{ fullScan }
                 , _processCount{}
@@ -93,6 +67,19 @@ namespace lms::scanner
             std::size_t getFileCount() const { return _processCount; };
             std::size_t getSkipCount() const { return _skipCount; }
 
+            // highest priority of the scanners of the files
+            core::JobPriority getPriority() const
+            {
+                std::optional<core::JobPriority> priority;
+                for (const auto& file : _files)
+                {
+                    if (const IFileScanner* scanner{ _fileScanners.select(file.path) })
+                        priority = std::max(priority.value_or(core::JobPriority::Low), scanner->getScanPriority());
+                }
+
+                return priority.value_or(core::JobPriority::Normal);
+            }
+
             std::span<std::unique_ptr<IFileScanOperation>> getScanOperations()
             {
                 return _scanOperations;
@@ -108,20 +95,17 @@ namespace lms::scanner
             {
                 for (const auto& file : _files)
                 {
-                    IFileScanner* scanner{ _fileScanners.select(file.path()) };
+                    IFileScanner* scanner{ _fileScanners.select(file.path) };
                     if (!scanner)
                         continue;
 
                     FileToScan fileToScan;
-                    fileToScan.filePath = file.path();
+                    fileToScan.filePath = file.path;
                     fileToScan.mediaLibrary = _mediaLibrary;
-                    {
-                        const std::chrono::system_clock::time_point lastWriteTime{ std::chrono::time_point_cast<std::chrono::system_clock::duration>(std::chrono::file_clock::to_sys(file.last_write_time())) };
-                        fileToScan.lastWriteTime.setTime_t(std::chrono::system_clock::to_time_t(lastWriteTime)); // sec resolution, as stored in the database
-                    }
-                    fileToScan.fileSize = file.file_size();
+                    fileToScan.lastWriteTime.setTime_t(std::chrono::system_clock::to_time_t(file.lastWriteTime)); // sec resolution, as stored in the database
+                    fileToScan.fileSize = file.fileSize;
 
-                    if (_fullScan || scanner->needsScan(fileToScan))
+                    if (needsScan(*scanner, fileToScan))
                     {
                         auto scanOperation{ scanner->createScanOperation(std::move(fileToScan)) };
 
@@ -138,12 +122,26 @@ namespace lms::scanner
                 }
             }
 
+            bool needsScan(const IFileScanner& scanner, const FileToScan& fileToScan) const
+            {
+                if (_fullScan)
+                    return true;
+
+                // use the snapshot if any, saves a database query per file
+                const auto itSnapshot{ _fileStateSnapshots.find(&scanner) };
+                if (itSnapshot != std::cend(_fileStateSnapshots))
+                    return itSnapshot->second->needsScan(fileToScan);
+
+                return scanner.needsScan(fileToScan);
+            }
+
             const FileScanners& _fileScanners;
+            const FileStateSnapshots& _fileStateSnapshots;
             const MediaLibraryInfo& _mediaLibrary;
             const bool _fullScan;
             std::size_t _processCount;
             std::size_t _skipCount;
-            std::vector<std::filesystem::directory_entry> _files;
+            std::vector<ExploredFile> _files;
             std::vector<std::unique_ptr<IFileScanOperation>> _scanOperations;
         };
     } // namespace
@@ -155,103 +153,235 @@ namespace lms::scanner
 
     void ScanStepScanFiles::process(ScanContext& context)
     {
+        context.exploredFiles.reset();
+        if (isRemovedFilesDetectionFromExplorationEnabled())
+            context.exploredFiles.emplace();
+
         for (const MediaLibraryInfo& mediaLibrary : _settings.mediaLibraries)
             process(context, mediaLibrary);
 
+        if (context.exploredFiles)
+            LMS_LOG(DBUPDATER, DEBUG, "Explored " << context.exploredFiles->getFileCount() << " files");
+
         context.stats.totalFileCount = context.currentStepStats.processedElems;
     }
 
     void ScanStepScanFiles::process(ScanContext& context, const MediaLibraryInfo& mediaLibrary)
     {
+        // Three stage pipeline, stages are connected using bounded queues:
+        // - walker threads explore the media library (several directories in flight) and group the files to scan
+        // - a dispatcher thread feeds the job scheduler, that parses the files in parallel
+        // - this thread writes the scan results in the database, using large transactions
         constexpr std::size_t filesPerScanJob{ 10 };
+        constexpr std::size_t exploredFilesQueueMaxSize{ 64 };
         constexpr std::size_t scanQueueMaxSize{ 50 };
         constexpr std::size_t processFileResultsBatchSize{ 1 };
         constexpr float drainRatio{ 0.85 };
+        constexpr std::size_t scanOperationsQueueMaxSize{ 1'000 };
+        constexpr std::chrono::milliseconds progressRefreshPeriod{ 250 };
+        constexpr std::chrono::milliseconds maxWriteBatchDelay{ 1'000 }; // scan results are written at least that often, even if the batch is not full
 
-        std::deque<std::unique_ptr<IFileScanOperation>> operations;
+        struct ExploreError
+        {
+            std::filesystem::path path;
+            std::error_code ec;
+        };
+        std::mutex exploreErrorsMutex;
+        std::vector<ExploreError> exploreErrors;
+        bool exploreFailed{}; // protected by exploreErrorsMutex
 
-        auto processDoneJobs = [&](std::span<std::unique_ptr<core::IJob>> jobsDone) {
-            for (const auto& jobDone : jobsDone)
-            {
-                auto& fileScanJob{ static_cast<FileScanJob&>(*jobDone) };
-                for (std::unique_ptr<IFileScanOperation>& scanOperation : fileScanJob.getScanOperations())
-                    operations.push_back(std::move(scanOperation));
+        std::mutex exploredFilesMutex;
 
-                context.currentStepStats.processedElems += fileScanJob.getFileCount();
-                context.stats.skips += fileScanJob.getSkipCount();
-            }
+        std::atomic<std::size_t> processedFileCount{};
+        std::atomic<std::size_t> skippedFileCount{};
 
-            if (!_abortScan)
-                processFileScanOperations(context, operations, true /* force batch */);
+        // State of the already known files, loaded once and then shared read only by all the scan jobs
+        FileStateSnapshots fileStateSnapshots;
+        if (!context.scanOptions.fullScan)
+        {
+            LMS_SCOPED_TRACE_OVERVIEW("Scanner", "LoadFileStates");
 
-            _progressCallback(context.currentStepStats);
-        };
+            getFileScanners().visit([&](const IFileScanner& scanner) {
+                if (std::unique_ptr<FileStateSnapshot> snapshot{ scanner.createFileStateSnapshot(mediaLibrary) })
+                {
+                    LMS_LOG(DBUPDATER, DEBUG, scanner.getName() << ": loaded state of " << snapshot->getFileCount() << " files in " << mediaLibrary.rootDirectory);
+                    fileStateSnapshots.emplace(&scanner, std::move(snapshot));
+                }
+            });
+        }
 
-        {
-            JobQueue queue{ getJobScheduler(), scanQueueMaxSize, processDoneJobs, processFileResultsBatchSize, drainRatio };
+        BoundedQueue<std::vector<ExploredFile>> exploredFilesQueue{ exploredFilesQueueMaxSize };
+        BoundedQueue<std::unique_ptr<IFileScanOperation>> scanOperationsQueue{ scanOperationsQueueMaxSize };
 
-            std::vector<std::filesystem::directory_entry> filesToScan;
+        std::exception_ptr walkerException;
+        std::thread walker{ [&] {
+            try
+            {
+                walkDirectoryTree(
+                    mediaLibrary.rootDirectory, excludeDirFileName, getWalkerThreadCount(),
+                    [&](std::vector<ExploredFile>&& files) {
+                        LMS_SCOPED_TRACE_DETAILED("Scanner", "OnExploreFiles");
 
-            exploreFilesRecursive(
-                mediaLibrary.rootDirectory, [&](std::error_code ec, const std::filesystem::path& path, const std::filesystem::directory_entry* fileEntry) {
-                    LMS_SCOPED_TRACE_DETAILED("Scanner", "OnExploreFile");
+                        if (context.exploredFiles)
+                        {
+                            std::scoped_lock lock{ exploredFilesMutex };
+                            for (const ExploredFile& file : files)
+                            {
+                                if (getFileScanners().select(file.path))
+                                    context.exploredFiles->add(file.path);
+                            }
+                        }
 
-                    assert((ec && !fileEntry) || (!ec && fileEntry));
+                        // files of a directory are grouped, so that similar files are likely to be scanned together
+                        for (std::size_t i{}; i < files.size(); i += filesPerScanJob)
+                        {
+                            if (_abortScan)
+                                return false; // stop iterating
 
-                    if (_abortScan)
-                        return false; // stop iterating
+                            const auto itBegin{ std::next(std::begin(files), i) };
+                            const auto itEnd{ std::next(std::begin(files), std::min(i + filesPerScanJob, files.size())) };
+                            if (!exploredFilesQueue.push(std::vector<ExploredFile>{ std::make_move_iterator(itBegin), std::make_move_iterator(itEnd) }))
+                                return false; // closed due to abort
+                        }
 
-                    if (ec)
-                    {
-                        addError<IOScanError>(context, path, ec);
-                        context.stats.skips++;
-                    }
-                    else
+                        return !_abortScan;
+                    },
+                    [&](const std::filesystem::path& path, std::error_code ec) {
+                        std::scoped_lock lock{ exploreErrorsMutex };
+                        exploreErrors.push_back(ExploreError{ path, ec });
+                        exploreFailed = true;
+
+                        return !_abortScan; // try to continue exploring anyway
+                    });
+            }
+            catch (...)
+            {
+                walkerException = std::current_exception();
+            }
+
+            exploredFilesQueue.close();
+        } };
+
+        std::exception_ptr dispatcherException;
+        std::thread dispatcher{ [&] {
+            try
+            {
+                auto processDoneJobs = [&](std::span<std::unique_ptr<core::IJob>> jobsDone) {
+                    for (const auto& jobDone : jobsDone)
                     {
-                        filesToScan.push_back(*fileEntry);
+                        auto& fileScanJob{ static_cast<FileScanJob&>(*jobDone) };
+                        for (std::unique_ptr<IFileScanOperation>& scanOperation : fileScanJob.getScanOperations())
+                            scanOperationsQueue.push(std::move(scanOperation));
 
-                        if (filesToScan.size() >= filesPerScanJob)
-                        {
-                            queue.push(std::make_unique<FileScanJob>(getFileScanners(), mediaLibrary, context.scanOptions.fullScan, filesToScan));
-                            filesToScan.clear();
-                        }
+                        processedFileCount += fileScanJob.getFileCount();
+                        skippedFileCount += fileScanJob.getSkipCount();
                     }
+                };
 
-                    return true;
-                },
-                &excludeDirFileName);
+                JobQueue queue{ getJobScheduler(), scanQueueMaxSize, processDoneJobs, processFileResultsBatchSize, drainRatio };
 
-            if (!filesToScan.empty())
-                queue.push(std::make_unique<FileScanJob>(getFileScanners(), mediaLibrary, context.scanOptions.fullScan, filesToScan));
+                std::vector<ExploredFile> filesToScan;
+                while (!_abortScan && exploredFilesQueue.pop(filesToScan))
+                {
+                    auto job{ std::make_unique<FileScanJob>(getFileScanners(), fileStateSnapshots, mediaLibrary, context.scanOptions.fullScan, filesToScan) };
+                    const core::JobPriority priority{ job->getPriority() };
+                    queue.push(std::move(job), priority);
+                }
+            }
+            catch (...)
+            {
+                dispatcherException = std::current_exception();
+            }
+
+            // unblock the walker if we stopped early
+            exploredFilesQueue.close();
+            scanOperationsQueue.close();
+        } };
+
+        auto refreshProgress{ [&] {
+            {
+                std::scoped_lock lock{ exploreErrorsMutex };
+                for (const ExploreError& exploreError : exploreErrors)
+                {
+                    addError<IOScanError>(context, exploreError.path, exploreError.ec);
+                    context.stats.skips++;
+                }
+                exploreErrors.clear();
+            }
+
+            context.stats.skips += skippedFileCount.exchange(0);
+            context.currentStepStats.processedElems += processedFileCount.exchange(0);
 
             _progressCallback(context.currentStepStats);
+        } };
+
+        try
+        {
+            std::vector<std::unique_ptr<IFileScanOperation>> scanOperations;
+            auto lastProgressRefreshTime{ std::chrono::steady_clock::now() };
+            while (scanOperationsQueue.popBatch(scanOperations, _writeBatchSize, std::chrono::steady_clock::now() + maxWriteBatchDelay))
+            {
+                processFileScanOperations(context, scanOperations);
+                scanOperations.clear();
+
+                const auto now{ std::chrono::steady_clock::now() };
+                if (now - lastProgressRefreshTime >= progressRefreshPeriod)
+                {
+                    refreshProgress();
+                    lastProgressRefreshTime = now;
+                }
+            }
+        }
+        catch (...)
+        {
+            // make the other stages stop before leaving
+            exploredFilesQueue.close();
+            scanOperationsQueue.close();
+            dispatcher.join();
+            walker.join();
+            throw;
         }
 
-        // Process remaining objects
-        processFileScanOperations(context, operations, false /* force batch */);
+        dispatcher.join();
+        walker.join();
+
+        refreshProgress();
+
+        // some files may have been missed, removed files will have to be checked one by one
+        if (exploreFailed || _abortScan)
+            context.exploredFiles.reset();
+
+        if (dispatcherException)
+            std::rethrow_exception(dispatcherException);
+        if (walkerException)
+            std::rethrow_exception(walkerException);
     }
 
-    std::size_t ScanStepScanFiles::processFileScanOperations(ScanContext& context, std::deque<std::unique_ptr<IFileScanOperation>>& scanOperations, bool forceBatch)
+    void ScanStepScanFiles::processFileScanOperations(ScanContext& context, std::span<const std::unique_ptr<IFileScanOperation>> scanOperations)
     {
-        std::size_t count{};
-        constexpr std::size_t writeBatchSize{ 10 };
+        // Adapt the batch size so that each write transaction lasts about targetWriteTransactionDuration:
+        // large enough to amortize the commit cost, small enough not to block other writers for too long
+        constexpr std::size_t minWriteBatchSize{ 10 };
+        constexpr std::size_t maxWriteBatchSize{ 1'000 };
+        constexpr std::chrono::microseconds targetWriteTransactionDuration{ 250'000 };
+
+        if (scanOperations.empty())
+            return;
 
         LMS_SCOPED_TRACE_OVERVIEW("Scanner", "ProcessScanResults");
 
-        while ((forceBatch && scanOperations.size() >= writeBatchSize) || !scanOperations.empty())
+        const auto startTime{ std::chrono::steady_clock::now() };
         {
             db::Session& dbSession{ _db.getTLSSession() };
             auto transaction{ dbSession.createWriteTransaction() };
 
-            for (std::size_t i{}; !scanOperations.empty() && i < writeBatchSize; ++i)
-            {
-                processFileScanOperation(context, *scanOperations.front());
-                scanOperations.pop_front();
-                count++;
-            }
+            for (const std::unique_ptr<IFileScanOperation>& scanOperation : scanOperations)
+                processFileScanOperation(context, *scanOperation);
         }
+        const auto duration{ std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime) };
 
-        return count;
+        const std::chrono::microseconds durationPerOperation{ std::max<std::chrono::microseconds::rep>(duration.count() / static_cast<std::chrono::microseconds::rep>(scanOperations.size()), 1) };
+        _writeBatchSize = std::clamp<std::size_t>(targetWriteTransactionDuration / durationPerOperation, minWriteBatchSize, maxWriteBatchSize);
     }
 
     void ScanStepScanFiles::processFileScanOperation(ScanContext& context, IFileScanOperation& scanOperation)
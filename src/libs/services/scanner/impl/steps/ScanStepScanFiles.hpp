@@ -1,7 +1,8 @@
 
 #pragma once
 
-#include <deque>
+#include <memory>
+#include <span>
 
 #include "ScanStepBase.hpp"
 
@@ -27,7 +28,9 @@ namespace lms::scanner
         void process(ScanContext& context) override;
 
         void process(ScanContext& context, const MediaLibraryInfo& mediaLibrary);
-        std::size_t processFileScanOperations(ScanContext& context, std::deque<std::unique_ptr<IFileScanOperation>>& scanOperations, bool forceBatch);
+        void processFileScanOperations(ScanContext& context, std::span<const std::unique_ptr<IFileScanOperation>> scanOperations);
         void processFileScanOperation(ScanContext& context, IFileScanOperation& operation);
+
+        std::size_t _writeBatchSize{ 10 }; // adapted to the measured write duration
     };
 } // namespace lms::scanner
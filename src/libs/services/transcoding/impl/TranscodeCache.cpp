@@ -0,0 +1,108 @@
+
+#include "TranscodeCache.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <sstream>
+
+#include "core/ILogger.hpp"
+
+namespace lms::transcoding
+{
+    TranscodeCache::TranscodeCache(const std::filesystem::path& directory, std::size_t maxCacheSize)
+        : _cache{ directory, maxCacheSize }
+    {
+        const core::DiskLruCache::Stats stats{ _cache.getStats() };
+        LMS_LOG(TRANSCODING, INFO, "Transcode cache: " << stats.entryCount << " entries, size = " << stats.size << " bytes, max size = " << stats.maxSize << " bytes");
+    }
+
+    TranscodeCache::~TranscodeCache()
+    {
+        const core::DiskLruCache::Stats stats{ _cache.getStats() };
+        LMS_LOG(TRANSCODING, DEBUG, "Transcode cache stats: hits = " << stats.hits << ", misses = " << stats.misses << ", nb entries = " << stats.entryCount << ", size = " << stats.size);
+    }
+
+    std::optional<TranscodeCache::Key> TranscodeCache::computeKey(const audio::TranscodeParameters& parameters)
+    {
+        const audio::TranscodeInputParameters& inputParameters{ parameters.inputParameters };
+        const audio::TranscodeOutputParameters& outputParameters{ parameters.outputParameters };
+
+        if (inputParameters.offset != std::chrono::milliseconds::zero())
+            return std::nullopt;
+
+        std::error_code ec;
+        const std::filesystem::file_time_type lastWriteTime{ std::filesystem::last_write_time(inputParameters.filePath, ec) };
+        if (ec)
+            return std::nullopt;
+
+        std::ostringstream oss;
+        oss << inputParameters.filePath.string() << '\n'
+            << lastWriteTime.time_since_epoch().count() << '\n'
+            << (outputParameters.format ? static_cast<int>(*outputParameters.format) : -1) << '\n'
+            << outputParameters.bitrate.value_or(0) << '\n'
+            << outputParameters.bitsPerSample.value_or(0) << '\n'
+            << outputParameters.channelCount.value_or(0) << '\n'
+            << outputParameters.sampleRate.value_or(0) << '\n'
+            << outputParameters.stripMetadata;
+
+        return core::DiskLruCache::computeKey(oss.str());
+    }
+
+    std::optional<std::filesystem::path> TranscodeCache::getEntry(const Key& key)
+    {
+        return _cache.getEntry(key);
+    }
+
+    std::unique_ptr<TranscodeCache::EntryWriter> TranscodeCache::createEntryWriter(const Key& key)
+    {
+        const std::optional<std::filesystem::path> tmpFilePath{ _cache.beginWrite(key) };
+        if (!tmpFilePath)
+            return {};
+
+        return std::unique_ptr<EntryWriter>{ new EntryWriter{ *this, key, *tmpFilePath } };
+    }
+
+    void TranscodeCache::onEntryWritten(const Key& key, const std::filesystem::path& tmpFilePath, std::optional<std::size_t> size)
+    {
+        if (_cache.endWrite(key, tmpFilePath, size))
+            LMS_LOG(TRANSCODING, DEBUG, "Added transcode cache entry '" << key << "', size = " << *size);
+    }
+
+    TranscodeCache::EntryWriter::EntryWriter(TranscodeCache& cache, const Key& key, const std::filesystem::path& tmpFilePath)
+        : _cache{ cache }
+        , _key{ key }
+        , _tmpFilePath{ tmpFilePath }
+        , _ofs{ tmpFilePath, std::ios::out | std::ios::binary | std::ios::trunc }
+    {
+        if (!_ofs)
+            LMS_LOG(TRANSCODING, ERROR, "Cannot open " << _tmpFilePath << " to cache transcode output");
+    }
+
+    TranscodeCache::EntryWriter::~EntryWriter()
+    {
+        if (!_committed)
+        {
+            _ofs.close();
+            _cache.onEntryWritten(_key, _tmpFilePath, std::nullopt);
+        }
+    }
+
+    void TranscodeCache::EntryWriter::write(std::span<const std::byte> data)
+    {
+        // too big outputs are discarded at commit time
+        if (!_ofs || _size > _cache._cache.getMaxCacheSize())
+            return;
+
+        _ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        _size += data.size();
+    }
+
+    void TranscodeCache::EntryWriter::commit()
+    {
+        assert(!_committed);
+        _committed = true;
+
+        _ofs.close();
+        _cache.onEntryWritten(_key, _tmpFilePath, _ofs ? std::optional<std::size_t>{ _size } : std::nullopt);
+    }
+} // namespace lms::transcoding
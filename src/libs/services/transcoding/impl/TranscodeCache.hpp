@@ -0,0 +1,65 @@
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "audio/TranscodeTypes.hpp"
+#include "core/DiskLruCache.hpp"
+
+namespace lms::transcoding
+{
+    // TranscodeCache: 转码输出的磁盘缓存（按源文件路径、修改时间与输出参数键入），按 LRU 限制磁盘占用，重启后保留。
+    // TranscodeCache: дисковый кэш результатов транскодирования (по пути исходного файла, времени изменения и выходным параметрам), ограничивает место на диске по LRU, сохраняется после перезапуска.
+    //
+    // Outputs are written while they are served to the first client, and are then served as plain files
+    class TranscodeCache
+    {
+    public:
+        TranscodeCache(const std::filesystem::path& directory, std::size_t maxCacheSize);
+        ~TranscodeCache();
+        TranscodeCache(const TranscodeCache&) = delete;
+        TranscodeCache& operator=(const TranscodeCache&) = delete;
+
+        using Key = core::DiskLruCache::Key;
+
+        // Only whole outputs are cached: no key if transcoding does not start at the beginning of the file
+        static std::optional<Key> computeKey(const audio::TranscodeParameters& parameters);
+
+        std::optional<std::filesystem::path> getEntry(const Key& key);
+
+        class EntryWriter
+        {
+        public:
+            ~EntryWriter(); // discards the output if not committed
+            EntryWriter(const EntryWriter&) = delete;
+            EntryWriter& operator=(const EntryWriter&) = delete;
+
+            void write(std::span<const std::byte> data);
+            void commit(); // call only once the whole output has been written
+
+        private:
+            friend class TranscodeCache;
+            EntryWriter(TranscodeCache& cache, const Key& key, const std::filesystem::path& tmpFilePath);
+
+            TranscodeCache& _cache;
+            const Key _key;
+            const std::filesystem::path _tmpFilePath;
+            std::ofstream _ofs;
+            std::size_t _size{};
+            bool _committed{};
+        };
+
+        // No writer if the output is already being written by another request
+        std::unique_ptr<EntryWriter> createEntryWriter(const Key& key);
+
+    private:
+        void onEntryWritten(const Key& key, const std::filesystem::path& tmpFilePath, std::optional<std::size_t> size); // no size if the output must be discarded
+
+        core::DiskLruCache _cache;
+    };
+} // namespace lms::transcoding
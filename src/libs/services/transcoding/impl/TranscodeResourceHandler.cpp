@@ -10,8 +10,9 @@ namespace lms::transcoding
 {
     // TODO set some nice HTTP return code
 
-    ResourceHandler::ResourceHandler(const audio::TranscodeParameters& parameters, std::optional<std::size_t> estimatedContentLength)
+    ResourceHandler::ResourceHandler(const audio::TranscodeParameters& parameters, std::optional<std::size_t> estimatedContentLength, std::unique_ptr<TranscodeCache::EntryWriter> cacheEntryWriter)
         : _estimatedContentLength{ estimatedContentLength }
+        , _cacheEntryWriter{ std::move(cacheEntryWriter) }
     {
         try
         {
@@ -48,6 +49,8 @@ namespace lms::transcoding
             LMS_LOG(TRANSCODING, DEBUG, "Writing " << _bytesReadyCount << " bytes back to client");
 
             response.out().write(reinterpret_cast<const char*>(_buffer.data()), _bytesReadyCount);
+            if (_cacheEntryWriter)
+                _cacheEntryWriter->write(std::span{ _buffer.data(), _bytesReadyCount });
             _totalServedByteCount += _bytesReadyCount;
             _bytesReadyCount = 0;
         }
@@ -67,6 +70,17 @@ namespace lms::transcoding
             return continuation;
         }
 
+        // the whole output has been served: the cached one is complete, unless ffmpeg failed along the way
+        if (_cacheEntryWriter)
+        {
+            if (_transcoder->succeeded())
+                _cacheEntryWriter->commit();
+            else
+                LMS_LOG(TRANSCODING, DEBUG, "Transcoder failed, discarding cached output");
+
+            _cacheEntryWriter.reset();
+        }
+
         // pad with 0 if necessary as duration may not be accurate
         if (_estimatedContentLength && *_estimatedContentLength > _totalServedByteCount)
         {
@@ -8,12 +8,15 @@
 #include "audio/ITranscoder.hpp"
 #include "core/IResourceHandler.hpp"
 
+#include "TranscodeCache.hpp"
+
 namespace lms::transcoding
 {
     class ResourceHandler final : public core::IResourceHandler
     {
     public:
-        ResourceHandler(const audio::TranscodeParameters& parameters, std::optional<std::size_t> estimatedContentLength);
+        // cacheEntryWriter: if set, the output is also written in cache
+        ResourceHandler(const audio::TranscodeParameters& parameters, std::optional<std::size_t> estimatedContentLength, std::unique_ptr<TranscodeCache::EntryWriter> cacheEntryWriter = {});
         ~ResourceHandler() override;
 
         ResourceHandler(const ResourceHandler&) = delete;
@@ -29,5 +32,6 @@ namespace lms::transcoding
         std::size_t _bytesReadyCount{};
         std::size_t _totalServedByteCount{};
         std::unique_ptr<audio::ITranscoder> _transcoder;
+        std::unique_ptr<TranscodeCache::EntryWriter> _cacheEntryWriter;
     };
 } // namespace lms::transcoding
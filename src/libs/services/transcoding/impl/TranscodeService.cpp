@@ -2,7 +2,10 @@
 #include "TranscodeService.hpp"
 
 #include "audio/ITranscoder.hpp"
+#include "core/FileResourceHandlerCreator.hpp"
+#include "core/IConfig.hpp"
 #include "core/ILogger.hpp"
+#include "core/Service.hpp"
 #include "core/UUID.hpp"
 #include "database/IDb.hpp"
 #include "database/Session.hpp"
@@ -20,15 +23,19 @@ namespace lms::transcoding
         }
     } // namespace
 
-    std::unique_ptr<ITranscodeService> createTranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager)
+    std::unique_ptr<ITranscodeService> createTranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager, const std::filesystem::path& cachePath)
     {
-        return std::make_unique<TranscodeService>(db, childProcessManager);
+        return std::make_unique<TranscodeService>(db, childProcessManager, cachePath);
     }
 
-    TranscodeService::TranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager)
+    TranscodeService::TranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager, const std::filesystem::path& cachePath)
         : _db{ db }
         , _childProcessManager(childProcessManager)
     {
+        const std::size_t maxCacheSize{ core::Service<core::IConfig>::get()->getULong("transcode-max-cache-size", 1000) * 1000 * 1000 };
+        if (maxCacheSize > 0)
+            _cache = std::make_unique<TranscodeCache>(cachePath, maxCacheSize);
+
         LMS_LOG(TRANSCODING, INFO, "Service started!");
     }
 
@@ -49,6 +56,21 @@ namespace lms::transcoding
                 LMS_LOG(TRANSCODING, WARNING, "Offset " << parameters.inputParameters.offset << " is greater than audio file duration " << parameters.inputParameters.duration << ": not estimating content length");
         }
 
-        return std::make_unique<transcoding::ResourceHandler>(parameters, estimatedContentLength);
+        std::unique_ptr<TranscodeCache::EntryWriter> cacheEntryWriter;
+        if (_cache)
+        {
+            if (const std::optional<TranscodeCache::Key> cacheKey{ TranscodeCache::computeKey(parameters) })
+            {
+                if (const std::optional<std::filesystem::path> cachedOutputPath{ _cache->getEntry(*cacheKey) })
+                {
+                    LMS_LOG(TRANSCODING, DEBUG, "Serving cached transcode output of " << parameters.inputParameters.filePath);
+                    return core::createFileResourceHandler(*cachedOutputPath, audio::getOutputMimeType(parameters.outputParameters));
+                }
+
+                cacheEntryWriter = _cache->createEntryWriter(*cacheKey);
+            }
+        }
+
+        return std::make_unique<transcoding::ResourceHandler>(parameters, estimatedContentLength, std::move(cacheEntryWriter));
     }
 } // namespace lms::transcoding
@@ -1,14 +1,19 @@
 
 #pragma once
 
+#include <filesystem>
+#include <memory>
+
 #include "services/transcoding/ITranscodeService.hpp"
 
+#include "TranscodeCache.hpp"
+
 namespace lms::transcoding
 {
     class TranscodeService : public ITranscodeService
     {
     public:
-        explicit TranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager);
+        TranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager, const std::filesystem::path& cachePath);
         ~TranscodeService() override;
 
         TranscodeService(const TranscodeService&) = delete;
@@ -19,5 +24,6 @@ namespace lms::transcoding
 
         db::IDb& _db;
         core::IChildProcessManager& _childProcessManager;
+        std::unique_ptr<TranscodeCache> _cache; // may be null if disabled
     };
 } // namespace lms::transcoding
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <filesystem>
 #include <memory>
 
 #include "audio/TranscodeTypes.hpp"
@@ -29,5 +30,6 @@ namespace lms::transcoding
         virtual std::unique_ptr<core::IResourceHandler> createTranscodeResourceHandler(const audio::TranscodeParameters& parameters, bool estimateContentLength = false) = 0;
     };
 
-    std::unique_ptr<ITranscodeService> createTranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager);
+    // cachePath: where the transcoded outputs are cached
+    std::unique_ptr<ITranscodeService> createTranscodeService(db::IDb& db, core::IChildProcessManager& childProcessManager, const std::filesystem::path& cachePath);
 } // namespace lms::transcoding
@@ -25,6 +25,7 @@ namespace lms::som
 
     DataNormalizer::DataNormalizer(std::size_t inputDimCount)
         : _inputDimCount{ inputDimCount }
+        , _minmax(inputDimCount)
     {
     }
 
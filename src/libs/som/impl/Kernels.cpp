@@ -0,0 +1,265 @@
+#include "Kernels.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define LMS_SOM_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+namespace lms::som::kernels
+{
+    namespace
+    {
+        using DistanceKernel = Distance (*)(const value_type*, const value_type*, const value_type*, std::size_t);
+        using FindClosestKernel = std::size_t (*)(const value_type*, std::size_t, const value_type*, const value_type*, std::size_t);
+        using MoveTowardsKernel = void (*)(value_type*, const value_type*, value_type, std::size_t);
+        using AddScaledKernel = void (*)(value_type*, const value_type*, value_type, std::size_t);
+
+        struct Implementation
+        {
+            DistanceKernel distance;
+            FindClosestKernel findClosest;
+            MoveTowardsKernel moveTowards;
+            AddScaledKernel addScaled;
+        };
+
+        inline Distance computeWeightedSquareDistanceScalar(const value_type* a, const value_type* b, const value_type* weights, std::size_t dimCount)
+        {
+            Distance res{};
+            for (std::size_t i{}; i < dimCount; ++i)
+            {
+                const value_type diff{ a[i] - b[i] };
+                res += diff * diff * weights[i];
+            }
+
+            return res;
+        }
+
+        std::size_t findClosestVectorIndexScalar(const value_type* vectors, std::size_t vectorCount, const value_type* data, const value_type* weights, std::size_t dimCount)
+        {
+            std::size_t bestIndex{};
+            Distance bestDistance{};
+            for (std::size_t index{}; index < vectorCount; ++index)
+            {
+                const Distance distance{ computeWeightedSquareDistanceScalar(vectors + index * dimCount, data, weights, dimCount) };
+                if (index == 0 || distance < bestDistance)
+                {
+                    bestIndex = index;
+                    bestDistance = distance;
+                }
+            }
+
+            return bestIndex;
+        }
+
+        void moveTowardsScalar(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            for (std::size_t i{}; i < dimCount; ++i)
+                vector[i] += factor * (input[i] - vector[i]);
+        }
+
+        void addScaledScalar(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            for (std::size_t i{}; i < dimCount; ++i)
+                vector[i] += factor * input[i];
+        }
+
+        constexpr Implementation scalarImplementation{ computeWeightedSquareDistanceScalar, findClosestVectorIndexScalar, moveTowardsScalar, addScaledScalar };
+
+#if defined(LMS_SOM_X86_KERNELS) && defined(__SSE2__)
+        inline Distance computeWeightedSquareDistanceSSE2(const value_type* a, const value_type* b, const value_type* weights, std::size_t dimCount)
+        {
+            __m128d acc0{ _mm_setzero_pd() };
+            __m128d acc1{ _mm_setzero_pd() };
+
+            std::size_t i{};
+            for (; i + 4 <= dimCount; i += 4)
+            {
+                const __m128d diff0{ _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)) };
+                const __m128d diff1{ _mm_sub_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)) };
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_mul_pd(diff0, diff0), _mm_loadu_pd(weights + i)));
+                acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_mul_pd(diff1, diff1), _mm_loadu_pd(weights + i + 2)));
+            }
+            for (; i + 2 <= dimCount; i += 2)
+            {
+                const __m128d diff{ _mm_sub_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)) };
+                acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_mul_pd(diff, diff), _mm_loadu_pd(weights + i)));
+            }
+
+            acc0 = _mm_add_pd(acc0, acc1);
+            Distance res{ _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0))) };
+
+            for (; i < dimCount; ++i)
+            {
+                const value_type diff{ a[i] - b[i] };
+                res += diff * diff * weights[i];
+            }
+
+            return res;
+        }
+
+        std::size_t findClosestVectorIndexSSE2(const value_type* vectors, std::size_t vectorCount, const value_type* data, const value_type* weights, std::size_t dimCount)
+        {
+            std::size_t bestIndex{};
+            Distance bestDistance{};
+            for (std::size_t index{}; index < vectorCount; ++index)
+            {
+                const Distance distance{ computeWeightedSquareDistanceSSE2(vectors + index * dimCount, data, weights, dimCount) };
+                if (index == 0 || distance < bestDistance)
+                {
+                    bestIndex = index;
+                    bestDistance = distance;
+                }
+            }
+
+            return bestIndex;
+        }
+
+        void moveTowardsSSE2(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            const __m128d factors{ _mm_set1_pd(factor) };
+
+            std::size_t i{};
+            for (; i + 2 <= dimCount; i += 2)
+            {
+                const __m128d values{ _mm_loadu_pd(vector + i) };
+                const __m128d delta{ _mm_sub_pd(_mm_loadu_pd(input + i), values) };
+                _mm_storeu_pd(vector + i, _mm_add_pd(values, _mm_mul_pd(factors, delta)));
+            }
+            for (; i < dimCount; ++i)
+                vector[i] += factor * (input[i] - vector[i]);
+        }
+
+        void addScaledSSE2(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            const __m128d factors{ _mm_set1_pd(factor) };
+
+            std::size_t i{};
+            for (; i + 2 <= dimCount; i += 2)
+                _mm_storeu_pd(vector + i, _mm_add_pd(_mm_loadu_pd(vector + i), _mm_mul_pd(factors, _mm_loadu_pd(input + i))));
+            for (; i < dimCount; ++i)
+                vector[i] += factor * input[i];
+        }
+
+        constexpr Implementation sse2Implementation{ computeWeightedSquareDistanceSSE2, findClosestVectorIndexSSE2, moveTowardsSSE2, addScaledSSE2 };
+#endif // LMS_SOM_X86_KERNELS && __SSE2__
+
+#if defined(LMS_SOM_X86_KERNELS)
+        __attribute__((target("avx2"))) inline Distance computeWeightedSquareDistanceAVX2(const value_type* a, const value_type* b, const value_type* weights, std::size_t dimCount)
+        {
+            __m256d acc0{ _mm256_setzero_pd() };
+            __m256d acc1{ _mm256_setzero_pd() };
+
+            std::size_t i{};
+            for (; i + 8 <= dimCount; i += 8)
+            {
+                const __m256d diff0{ _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)) };
+                const __m256d diff1{ _mm256_sub_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)) };
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_mul_pd(diff0, diff0), _mm256_loadu_pd(weights + i)));
+                acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_mul_pd(diff1, diff1), _mm256_loadu_pd(weights + i + 4)));
+            }
+            for (; i + 4 <= dimCount; i += 4)
+            {
+                const __m256d diff{ _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)) };
+                acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_mul_pd(diff, diff), _mm256_loadu_pd(weights + i)));
+            }
+
+            acc0 = _mm256_add_pd(acc0, acc1);
+            __m128d acc{ _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1)) };
+            Distance res{ _mm_cvtsd_f64(_mm_add_sd(acc, _mm_unpackhi_pd(acc, acc))) };
+
+            for (; i < dimCount; ++i)
+            {
+                const value_type diff{ a[i] - b[i] };
+                res += diff * diff * weights[i];
+            }
+
+            return res;
+        }
+
+        __attribute__((target("avx2"))) std::size_t findClosestVectorIndexAVX2(const value_type* vectors, std::size_t vectorCount, const value_type* data, const value_type* weights, std::size_t dimCount)
+        {
+            std::size_t bestIndex{};
+            Distance bestDistance{};
+            for (std::size_t index{}; index < vectorCount; ++index)
+            {
+                const Distance distance{ computeWeightedSquareDistanceAVX2(vectors + index * dimCount, data, weights, dimCount) };
+                if (index == 0 || distance < bestDistance)
+                {
+                    bestIndex = index;
+                    bestDistance = distance;
+                }
+            }
+
+            return bestIndex;
+        }
+
+        __attribute__((target("avx2"))) void moveTowardsAVX2(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            const __m256d factors{ _mm256_set1_pd(factor) };
+
+            std::size_t i{};
+            for (; i + 4 <= dimCount; i += 4)
+            {
+                const __m256d values{ _mm256_loadu_pd(vector + i) };
+                const __m256d delta{ _mm256_sub_pd(_mm256_loadu_pd(input + i), values) };
+                _mm256_storeu_pd(vector + i, _mm256_add_pd(values, _mm256_mul_pd(factors, delta)));
+            }
+            for (; i < dimCount; ++i)
+                vector[i] += factor * (input[i] - vector[i]);
+        }
+
+        __attribute__((target("avx2"))) void addScaledAVX2(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+        {
+            const __m256d factors{ _mm256_set1_pd(factor) };
+
+            std::size_t i{};
+            for (; i + 4 <= dimCount; i += 4)
+                _mm256_storeu_pd(vector + i, _mm256_add_pd(_mm256_loadu_pd(vector + i), _mm256_mul_pd(factors, _mm256_loadu_pd(input + i))));
+            for (; i < dimCount; ++i)
+                vector[i] += factor * input[i];
+        }
+
+        constexpr Implementation avx2Implementation{ computeWeightedSquareDistanceAVX2, findClosestVectorIndexAVX2, moveTowardsAVX2, addScaledAVX2 };
+#endif // LMS_SOM_X86_KERNELS
+
+        const Implementation& selectImplementation()
+        {
+#if defined(LMS_SOM_X86_KERNELS)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+                return avx2Implementation;
+#endif
+#if defined(LMS_SOM_X86_KERNELS) && defined(__SSE2__)
+            return sse2Implementation;
+#else
+            return scalarImplementation;
+#endif
+        }
+
+        const Implementation& getImplementation()
+        {
+            static const Implementation& implementation{ selectImplementation() };
+            return implementation;
+        }
+    } // namespace
+
+    Distance computeWeightedSquareDistance(const value_type* a, const value_type* b, const value_type* weights, std::size_t dimCount)
+    {
+        return getImplementation().distance(a, b, weights, dimCount);
+    }
+
+    std::size_t findClosestVectorIndex(const value_type* vectors, std::size_t vectorCount, const value_type* data, const value_type* weights, std::size_t dimCount)
+    {
+        return getImplementation().findClosest(vectors, vectorCount, data, weights, dimCount);
+    }
+
+    void moveTowards(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+    {
+        getImplementation().moveTowards(vector, input, factor, dimCount);
+    }
+
+    void addScaled(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount)
+    {
+        getImplementation().addScaled(vector, input, factor, dimCount);
+    }
+} // namespace lms::som::kernels
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+#include "som/InputVector.hpp"
+
+namespace lms::som::kernels
+{
+    using value_type = InputVector::value_type;
+    using Distance = InputVector::Distance;
+
+    // All vectors are raw contiguous arrays of dimCount values
+    // The best available implementation (AVX2, SSE2 or scalar) is selected at runtime
+
+    // sum(weights[i] * (a[i] - b[i])^2)
+    Distance computeWeightedSquareDistance(const value_type* a, const value_type* b, const value_type* weights, std::size_t dimCount);
+
+    // vectors holds vectorCount vectors stored one after another
+    // Returns the index of the first vector that has the minimal distance to data
+    std::size_t findClosestVectorIndex(const value_type* vectors, std::size_t vectorCount, const value_type* data, const value_type* weights, std::size_t dimCount);
+
+    // vector += factor * (input - vector)
+    void moveTowards(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount);
+
+    // vector += factor * input
+    void addScaled(value_type* vector, const value_type* input, value_type factor, std::size_t dimCount);
+} // namespace lms::som::kernels
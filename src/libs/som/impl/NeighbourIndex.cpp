@@ -0,0 +1,92 @@
+#include "som/NeighbourIndex.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+namespace lms::som
+{
+    NeighbourIndex::NeighbourIndex(const Network& network, InputVector::Distance maxDistance, std::size_t maxNeighbourCount)
+        : _width{ network.getWidth() }
+        , _height{ network.getHeight() }
+    {
+        const std::size_t refVectorCount{ static_cast<std::size_t>(_width) * _height };
+
+        _offsets.reserve(refVectorCount + 1);
+        _offsets.push_back(0);
+
+        struct Candidate
+        {
+            InputVector::Distance distance;
+            std::size_t index;
+
+            bool operator>(const Candidate& other) const { return std::tie(distance, index) > std::tie(other.distance, other.index); }
+        };
+        std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+
+        // visitedStamps[i] == stamp means i is already in the region grown from the current ref vector
+        std::vector<std::size_t> visitedStamps(refVectorCount, 0);
+        std::size_t stamp{};
+
+        auto getPosition{ [this](std::size_t index) { return Position{ static_cast<Coordinate>(index % _width), static_cast<Coordinate>(index / _width) }; } };
+
+        auto addGridNeighbours{ [&](const Position& position) {
+            auto addCandidate{ [&](const Position& neighbour) {
+                const std::size_t neighbourIndex{ neighbour.x + static_cast<std::size_t>(_width) * neighbour.y };
+                if (visitedStamps[neighbourIndex] != stamp)
+                    candidates.push(Candidate{ network.getRefVectorsDistance(position, neighbour), neighbourIndex });
+            } };
+
+            if (position.y > 0)
+                addCandidate({ position.x, position.y - 1 });
+            if (position.y < _height - 1)
+                addCandidate({ position.x, position.y + 1 });
+            if (position.x > 0)
+                addCandidate({ position.x - 1, position.y });
+            if (position.x < _width - 1)
+                addCandidate({ position.x + 1, position.y });
+        } };
+
+        for (std::size_t index{}; index < refVectorCount; ++index)
+        {
+            stamp += 1;
+            candidates = {};
+
+            visitedStamps[index] = stamp;
+            addGridNeighbours(getPosition(index));
+
+            std::size_t neighbourCount{};
+            while (!candidates.empty() && neighbourCount < maxNeighbourCount)
+            {
+                const Candidate candidate{ candidates.top() };
+                candidates.pop();
+
+                if (candidate.distance > maxDistance)
+                    break;
+
+                if (visitedStamps[candidate.index] == stamp)
+                    continue;
+
+                visitedStamps[candidate.index] = stamp;
+                const Position position{ getPosition(candidate.index) };
+                _neighbours.push_back(position);
+                neighbourCount += 1;
+
+                addGridNeighbours(position);
+            }
+
+            _offsets.push_back(_neighbours.size());
+        }
+    }
+
+    std::span<const Position> NeighbourIndex::getNeighbours(const Position& position) const
+    {
+        assert(position.x < _width);
+        assert(position.y < _height);
+
+        const std::size_t index{ position.x + static_cast<std::size_t>(_width) * position.y };
+        return std::span<const Position>{ _neighbours }.subspan(_offsets[index], _offsets[index + 1] - _offsets[index]);
+    }
+} // namespace lms::som
@@ -4,13 +4,18 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <numeric>
 #include <random>
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 
 #include "core/ILogger.hpp"
+#include "core/Parallel.hpp"
 #include "core/Random.hpp"
 
+#include "Kernels.hpp"
+
 namespace lms::som
 {
     void checkSameDimensions(const InputVector& a, const InputVector& b)
@@ -32,11 +37,6 @@ namespace lms::som
         return initialValue * exp(-((iteration.idIteration + 1) / static_cast<LearningFactor>(iteration.iterationCount)));
     }
 
-    static InputVector::Distance euclidianSquareDistance(const InputVector& a, const InputVector& b, const InputVector& weights)
-    {
-        return a.computeEuclidianSquareDistance(b, weights);
-    }
-
     static InputVector::value_type sigmaFunc(Network::CurrentIteration iteration)
     {
         constexpr InputVector::value_type sigma0{ 1 };
@@ -52,22 +52,94 @@ namespace lms::som
     }
 
     Network::Network(Coordinate width, Coordinate height, std::size_t inputDimCount)
-        : _inputDimCount{ inputDimCount }
+        : Network{ width, height, inputDimCount, core::random::getRandGenerator() }
+    {
+    }
+
+    Network::Network(Coordinate width, Coordinate height, std::size_t inputDimCount, core::random::RandGenerator& randGenerator)
+        : _width{ width }
+        , _height{ height }
+        , _inputDimCount{ inputDimCount }
         , _weights{ inputDimCount, static_cast<InputVector::value_type>(1) }
-        , _refVectors{ width, height, _inputDimCount }
-        , _distanceFunc{ euclidianSquareDistance }
+        , _refVectors(static_cast<std::size_t>(width) * height * inputDimCount)
         , _learningFactorFunc{ defaultLearningFactor }
         , _neighbourhoodFunc{ defaultNeighbourhoodFunc }
     {
         // init each vector with a random normalized value
-        for (Coordinate y{}; y < _refVectors.getHeight(); ++y)
-        {
-            for (Coordinate x{}; x < _refVectors.getWidth(); ++x)
-            {
-                for (InputVector::value_type& val : _refVectors.get({ x, y }))
-                    val = core::random::getRealRandom<InputVector::value_type>(0, 1);
-            }
-        }
+        std::uniform_real_distribution<InputVector::value_type> dist{ 0, 1 };
+        for (InputVector::value_type& val : _refVectors)
+            val = dist(randGenerator);
+    }
+
+    Network::Network(Coordinate width, Coordinate height, std::size_t inputDimCount, std::span<const InputVector::value_type> refVectorsData)
+        : _width{ width }
+        , _height{ height }
+        , _inputDimCount{ inputDimCount }
+        , _weights{ inputDimCount, static_cast<InputVector::value_type>(1) }
+        , _refVectors(std::cbegin(refVectorsData), std::cend(refVectorsData))
+        , _learningFactorFunc{ defaultLearningFactor }
+        , _neighbourhoodFunc{ defaultNeighbourhoodFunc }
+    {
+        if (_refVectors.size() != getRefVectorCount() * _inputDimCount)
+            throw Exception("Bad ref vectors value count");
+    }
+
+    std::size_t Network::getRefVectorIndex(const Position& position) const
+    {
+        assert(position.x < _width);
+        assert(position.y < _height);
+        return position.x + static_cast<std::size_t>(_width) * position.y;
+    }
+
+    Position Network::getRefVectorPosition(std::size_t index) const
+    {
+        return Position{ static_cast<Coordinate>(index % _width), static_cast<Coordinate>(index / _width) };
+    }
+
+    InputVector::Distance Network::computeDistance(const InputVector::value_type* a, const InputVector::value_type* b) const
+    {
+        if (!_distanceFunc)
+            return kernels::computeWeightedSquareDistance(a, b, _weights.data(), _inputDimCount);
+
+        // slow path: custom distance functions work on InputVectors
+        InputVector vectorA{ _inputDimCount };
+        std::copy(a, a + _inputDimCount, vectorA.begin());
+        InputVector vectorB{ _inputDimCount };
+        std::copy(b, b + _inputDimCount, vectorB.begin());
+
+        return _distanceFunc(vectorA, vectorB, _weights);
+    }
+
+    void Network::setDistanceFunc(DistanceFunc distanceFunc)
+    {
+        _distanceFunc = std::move(distanceFunc);
+    }
+
+    Network::DistanceFunc Network::getDistanceFunc() const
+    {
+        if (_distanceFunc)
+            return _distanceFunc;
+
+        return [](const InputVector& a, const InputVector& b, const InputVector& weights) {
+            checkSameDimensions(a, b);
+            checkSameDimensions(a, weights);
+            return kernels::computeWeightedSquareDistance(a.data(), b.data(), weights.data(), a.getNbDimensions());
+        };
+    }
+
+    void Network::setLearningFactorFunc(LearningFactorFunc learningFactorFunc)
+    {
+        _learningFactorFunc = std::move(learningFactorFunc);
+    }
+
+    void Network::setNeighbourhoodFunc(NeighbourhoodFunc neighbourhoodFunc)
+    {
+        _neighbourhoodFunc = std::move(neighbourhoodFunc);
+    }
+
+    void Network::setNeighbourhoodCutoff(InputVector::value_type cutoff)
+    {
+        _neighbourhoodCutoff = cutoff;
     }
 
     void Network::setDataWeights(const InputVector& weights)
@@ -81,25 +153,40 @@ namespace lms::som
     {
         checkSameDimensions(data, _inputDimCount);
 
-        _refVectors[position] = data;
+        std::copy(data.begin(), data.end(), getRefVectorData(getRefVectorIndex(position)));
+    }
+
+    void Network::setRefVectorsData(std::span<const InputVector::value_type> values)
+    {
+        if (values.size() != _refVectors.size())
+            throw Exception("Bad ref vectors value count");
+
+        std::copy(std::cbegin(values), std::cend(values), std::begin(_refVectors));
     }
 
     InputVector::Distance Network::getRefVectorsDistance(const Position& position1, const Position& position2) const
     {
-        return _distanceFunc(_refVectors.get(position1), _refVectors.get(position2), _weights);
+        return computeDistance(getRefVectorData(getRefVectorIndex(position1)), getRefVectorData(getRefVectorIndex(position2)));
+    }
+
+    InputVector::Distance Network::getRefVectorDistance(const Position& position, const InputVector& data) const
+    {
+        checkSameDimensions(data, _inputDimCount);
+
+        return computeDistance(getRefVectorData(getRefVectorIndex(position)), data.data());
     }
 
     InputVector::Distance Network::computeRefVectorsDistanceMean() const
     {
         std::vector<InputVector::Distance> values;
-        values.reserve(2 * _refVectors.getHeight() * _refVectors.getWidth() - _refVectors.getWidth() - _refVectors.getHeight());
-        for (Coordinate y{}; y < _refVectors.getHeight(); ++y)
+        values.reserve(2 * _height * _width - _width - _height);
+        for (Coordinate y{}; y < _height; ++y)
         {
-            for (Coordinate x{}; x < _refVectors.getWidth(); ++x)
+            for (Coordinate x{}; x < _width; ++x)
             {
-                if (x != _refVectors.getWidth() - 1)
+                if (x != _width - 1)
                     values.emplace_back(getRefVectorsDistance({ x, y }, { x + 1, y }));
-                if (y != _refVectors.getHeight() - 1)
+                if (y != _height - 1)
                     values.emplace_back(getRefVectorsDistance({ x, y }, { x, y + 1 }));
             }
         }
@@ -110,14 +197,14 @@ namespace lms::som
     double Network::computeRefVectorsDistanceMedian() const
     {
         std::vector<InputVector::Distance> values;
-        values.reserve(2 * _refVectors.getHeight() * _refVectors.getWidth() - _refVectors.getWidth() - _refVectors.getHeight());
-        for (Coordinate y{}; y < _refVectors.getHeight(); ++y)
+        values.reserve(2 * _height * _width - _width - _height);
+        for (Coordinate y{}; y < _height; ++y)
         {
-            for (Coordinate x{}; x < _refVectors.getWidth(); ++x)
+            for (Coordinate x{}; x < _width; ++x)
             {
-                if (x != _refVectors.getWidth() - 1)
+                if (x != _width - 1)
                     values.emplace_back(getRefVectorsDistance({ x, y }, { x + 1, y }));
-                if (y != _refVectors.getHeight() - 1)
+                if (y != _height - 1)
                     values.emplace_back(getRefVectorsDistance({ x, y }, { x, y + 1 }));
             }
         }
@@ -129,14 +216,14 @@ namespace lms::som
 
     void Network::dump(std::ostream& os) const
     {
-        os << "Width: " << _refVectors.getWidth() << ", Height: " << _refVectors.getHeight() << std::endl;
+        os << "Width: " << _width << ", Height: " << _height << std::endl;
         ;
 
-        for (Coordinate y{}; y < _refVectors.getHeight(); ++y)
+        for (Coordinate y{}; y < _height; ++y)
         {
-            for (Coordinate x{}; x < _refVectors.getWidth(); ++x)
+            for (Coordinate x{}; x < _width; ++x)
             {
-                os << _refVectors.get({ x, y }) << " ";
+                os << getRefVector({ x, y }) << " ";
             }
 
             os << std::endl;
@@ -144,21 +231,41 @@ namespace lms::som
         os << std::endl;
     }
 
+    std::size_t Network::getClosestRefVectorIndex(const InputVector& data) const
+    {
+        checkSameDimensions(data, _inputDimCount);
+
+        if (!_distanceFunc)
+            return kernels::findClosestVectorIndex(_refVectors.data(), getRefVectorCount(), data.data(), _weights.data(), _inputDimCount);
+
+        std::size_t bestIndex{};
+        InputVector::Distance bestDistance{};
+        for (std::size_t index{}; index < getRefVectorCount(); ++index)
+        {
+            const InputVector::Distance distance{ computeDistance(getRefVectorData(index), data.data()) };
+            if (index == 0 || distance < bestDistance)
+            {
+                bestIndex = index;
+                bestDistance = distance;
+            }
+        }
+
+        return bestIndex;
+    }
+
     Position Network::getClosestRefVectorPosition(const InputVector& data) const
     {
-        return _refVectors.getPositionMinElement([&](const auto& a, const auto& b) {
-            return (_distanceFunc(a, data, _weights) < _distanceFunc(b, data, _weights));
-        });
+        return getRefVectorPosition(getClosestRefVectorIndex(data));
     }
 
     std::optional<Position> Network::getClosestRefVectorPosition(const InputVector& data, InputVector::Distance maxDistance) const
     {
-        std::optional<Position> position{ getClosestRefVectorPosition(data) };
+        const std::size_t index{ getClosestRefVectorIndex(data) };
 
-        if (_distanceFunc(data, _refVectors.get(*position), _weights) > maxDistance)
-            position.reset();
+        if (computeDistance(data.data(), getRefVectorData(index)) > maxDistance)
+            return std::nullopt;
 
-        return position;
+        return getRefVectorPosition(index);
     }
 
     std::optional<Position> Network::getClosestRefVectorPosition(const std::vector<Position>& refVectorsPosition, InputVector::Distance maxDistance) const
@@ -168,11 +275,11 @@ namespace lms::som
         {
             if (refVectorPosition.y > 0)
                 neighboursPosition.insert({ refVectorPosition.x, refVectorPosition.y - 1 });
-            if (refVectorPosition.y < _refVectors.getHeight() - 1)
+            if (refVectorPosition.y < _height - 1)
                 neighboursPosition.insert({ refVectorPosition.x, refVectorPosition.y + 1 });
             if (refVectorPosition.x > 0)
                 neighboursPosition.insert({ refVectorPosition.x - 1, refVectorPosition.y });
-            if (refVectorPosition.x < _refVectors.getWidth() - 1)
+            if (refVectorPosition.x < _width - 1)
                 neighboursPosition.insert({ refVectorPosition.x + 1, refVectorPosition.y });
         }
 
@@ -221,28 +328,58 @@ namespace lms::som
         return std::sqrt((c1.x - c2.x) * (c1.x - c2.x) + (c1.y - c2.y) * (c1.y - c2.y));
     }
 
-    void Network::updateRefVectors(const Position& closestRefVectorPosition, const InputVector& input, LearningFactor learningFactor, const CurrentIteration& iteration)
+    void Network::computeNeighbourhood(const CurrentIteration& iteration, InputVector::value_type scale, Neighbourhood& neighbourhood) const
     {
-        for (Coordinate y{}; y < _refVectors.getHeight(); ++y)
+        neighbourhood.factors.resize(getRefVectorCount());
+        neighbourhood.radius = 0;
+
+        for (Coordinate dy{}; dy < _height; ++dy)
         {
-            for (Coordinate x{}; x < _refVectors.getWidth(); ++x)
+            for (Coordinate dx{}; dx < _width; ++dx)
             {
-                InputVector& refVector{ _refVectors.get({ x, y }) };
+                InputVector::value_type factor{ scale * _neighbourhoodFunc(computePositionNorm({ 0, 0 }, { dx, dy }), iteration) };
+                if (std::abs(factor) < _neighbourhoodCutoff)
+                    factor = 0;
+                else
+                    neighbourhood.radius = std::max(neighbourhood.radius, std::max(dx, dy));
 
-                const Norm norm{ computePositionNorm({ x, y }, closestRefVectorPosition) };
+                neighbourhood.factors[dx + static_cast<std::size_t>(_width) * dy] = factor;
+            }
+        }
+    }
 
-                InputVector delta{ input - refVector };
-                delta *= (learningFactor * _neighbourhoodFunc(norm, iteration));
+    void Network::updateRefVectors(const Position& closestRefVectorPosition, const InputVector& input, const Neighbourhood& neighbourhood)
+    {
+        const Coordinate beginX{ closestRefVectorPosition.x > neighbourhood.radius ? closestRefVectorPosition.x - neighbourhood.radius : 0 };
+        const Coordinate endX{ std::min(_width, closestRefVectorPosition.x + neighbourhood.radius + 1) };
+        const Coordinate beginY{ closestRefVectorPosition.y > neighbourhood.radius ? closestRefVectorPosition.y - neighbourhood.radius : 0 };
+        const Coordinate endY{ std::min(_height, closestRefVectorPosition.y + neighbourhood.radius + 1) };
 
-                refVector += delta;
+        for (Coordinate y{ beginY }; y < endY; ++y)
+        {
+            const Coordinate dy{ y > closestRefVectorPosition.y ? y - closestRefVectorPosition.y : closestRefVectorPosition.y - y };
+
+            for (Coordinate x{ beginX }; x < endX; ++x)
+            {
+                const Coordinate dx{ x > closestRefVectorPosition.x ? x - closestRefVectorPosition.x : closestRefVectorPosition.x - x };
+
+                const InputVector::value_type factor{ neighbourhood.factors[dx + static_cast<std::size_t>(_width) * dy] };
+                if (factor != 0)
+                    kernels::moveTowards(getRefVectorData(getRefVectorIndex({ x, y })), input.data(), factor, _inputDimCount);
             }
         }
     }
 
     void Network::train(const std::vector<InputVector>& inputData, std::size_t nbIterations, ProgressCallback progressCallback, RequestStopCallback requestStopCallback)
+    {
+        train(inputData, nbIterations, core::random::getRandGenerator(), std::move(progressCallback), std::move(requestStopCallback));
+    }
+
+    void Network::train(const std::vector<InputVector>& inputData, std::size_t nbIterations, core::random::RandGenerator& randGenerator, ProgressCallback progressCallback, RequestStopCallback requestStopCallback)
     {
         bool stopRequested{ false };
         std::vector<const InputVector*> inputDataShuffled;
+        Neighbourhood neighbourhood;
 
         inputDataShuffled.reserve(inputData.size());
         for (const auto& input : inputData)
@@ -255,9 +392,9 @@ namespace lms::som
             if (progressCallback)
                 progressCallback(curIter);
 
-            core::random::shuffleContainer(inputDataShuffled);
+            std::shuffle(std::begin(inputDataShuffled), std::end(inputDataShuffled), randGenerator);
 
-            const LearningFactor learningFactor{ _learningFactorFunc(curIter) };
+            computeNeighbourhood(curIter, _learningFactorFunc(curIter), neighbourhood);
 
             for (const InputVector* input : inputDataShuffled)
             {
@@ -267,7 +404,7 @@ namespace lms::som
                 if (stopRequested)
                     return;
 
-                updateRefVectors(getClosestRefVectorPosition(*input), *input, learningFactor, curIter);
+                updateRefVectors(getClosestRefVectorPosition(*input), *input, neighbourhood);
             }
 
             if (stopRequested)
@@ -275,8 +412,109 @@ namespace lms::som
         }
     }
 
-    const InputVector& Network::getRefVector(const Position& position) const
+    void Network::trainBatch(const std::vector<InputVector>& inputData, std::size_t nbIterations, std::size_t threadCount, ProgressCallback progressCallback, RequestStopCallback requestStopCallback)
     {
-        return _refVectors[position];
+        for (const InputVector& input : inputData)
+            checkSameDimensions(input, _inputDimCount);
+
+        const std::size_t refVectorCount{ getRefVectorCount() };
+
+        std::vector<std::size_t> closestRefVectorIndexes(inputData.size());
+        std::vector<InputVector::value_type> sampleSums(_refVectors.size()); // for each ref vector, sum of the samples it matches
+        std::vector<std::size_t> sampleCounts(refVectorCount);
+        Neighbourhood neighbourhood;
+        std::vector<InputVector::value_type> newRefVectors(_refVectors.size());
+
+        for (std::size_t i{}; i < nbIterations; ++i)
+        {
+            CurrentIteration curIter{ i, nbIterations };
+
+            if (progressCallback)
+                progressCallback(curIter);
+
+            if (requestStopCallback && requestStopCallback())
+                return;
+
+            core::parallelForRanges(inputData.size(), threadCount, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t sampleIndex{ begin }; sampleIndex < end; ++sampleIndex)
+                    closestRefVectorIndexes[sampleIndex] = getClosestRefVectorIndex(inputData[sampleIndex]);
+            });
+
+            if (requestStopCallback && requestStopCallback())
+                return;
+
+            // Accumulate in sample order to get the same rounding whatever the thread count is
+            std::fill(std::begin(sampleSums), std::end(sampleSums), 0);
+            std::fill(std::begin(sampleCounts), std::end(sampleCounts), 0);
+            for (std::size_t sampleIndex{}; sampleIndex < inputData.size(); ++sampleIndex)
+            {
+                const std::size_t refVectorIndex{ closestRefVectorIndexes[sampleIndex] };
+                kernels::addScaled(sampleSums.data() + refVectorIndex * _inputDimCount, inputData[sampleIndex].data(), 1, _inputDimCount);
+                sampleCounts[refVectorIndex] += 1;
+            }
+
+            computeNeighbourhood(curIter, 1, neighbourhood);
+
+            core::parallelForRanges(refVectorCount, threadCount, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t refVectorIndex{ begin }; refVectorIndex < end; ++refVectorIndex)
+                {
+                    const Position position{ getRefVectorPosition(refVectorIndex) };
+                    InputVector::value_type* newRefVector{ newRefVectors.data() + refVectorIndex * _inputDimCount };
+
+                    std::fill(newRefVector, newRefVector + _inputDimCount, 0);
+                    InputVector::value_type totalFactor{};
+
+                    // only the ref vectors within the neighbourhood radius can contribute
+                    const Coordinate beginX{ position.x > neighbourhood.radius ? position.x - neighbourhood.radius : 0 };
+                    const Coordinate endX{ std::min(_width, position.x + neighbourhood.radius + 1) };
+                    const Coordinate beginY{ position.y > neighbourhood.radius ? position.y - neighbourhood.radius : 0 };
+                    const Coordinate endY{ std::min(_height, position.y + neighbourhood.radius + 1) };
+
+                    for (Coordinate y{ beginY }; y < endY; ++y)
+                    {
+                        const Coordinate dy{ y > position.y ? y - position.y : position.y - y };
+
+                        for (Coordinate x{ beginX }; x < endX; ++x)
+                        {
+                            const std::size_t matchingRefVectorIndex{ getRefVectorIndex({ x, y }) };
+                            if (sampleCounts[matchingRefVectorIndex] == 0)
+                                continue;
+
+                            const Coordinate dx{ x > position.x ? x - position.x : position.x - x };
+                            const InputVector::value_type factor{ neighbourhood.factors[dx + static_cast<std::size_t>(_width) * dy] };
+                            if (factor <= 0)
+                                continue;
+
+                            kernels::addScaled(newRefVector, sampleSums.data() + matchingRefVectorIndex * _inputDimCount, factor, _inputDimCount);
+                            totalFactor += factor * sampleCounts[matchingRefVectorIndex];
+                        }
+                    }
+
+                    if (totalFactor > 0)
+                    {
+                        for (std::size_t dimId{}; dimId < _inputDimCount; ++dimId)
+                            newRefVector[dimId] /= totalFactor;
+                    }
+                    else
+                    {
+                        // no sample in the neighbourhood, keep the ref vector as is
+                        const InputVector::value_type* refVector{ getRefVectorData(refVectorIndex) };
+                        std::copy(refVector, refVector + _inputDimCount, newRefVector);
+                    }
+                }
+            });
+
+            _refVectors.swap(newRefVectors);
+        }
+    }
+
+    InputVector Network::getRefVector(const Position& position) const
+    {
+        const InputVector::value_type* refVectorData{ getRefVectorData(getRefVectorIndex(position)) };
+
+        InputVector res{ _inputDimCount };
+        std::copy(refVectorData, refVectorData + _inputDimCount, res.begin());
+
+        return res;
     }
 } // namespace lms::som
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <cmath>
+#include <ostream>
 #include <vector>
 
 #include "core/Exception.hpp"
@@ -114,6 +115,16 @@ namespace lms::som
             return res;
         }
 
+        value_type* data()
+        {
+            return _values.data();
+        }
+
+        const value_type* data() const
+        {
+            return _values.data();
+        }
+
         std::vector<value_type>::iterator begin()
         {
             return _values.begin();
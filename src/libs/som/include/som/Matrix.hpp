@@ -83,7 +83,7 @@ namespace lms::som
             const auto it{ std::min_element(_values.begin(), _values.end(), std::move(func)) };
             const auto index{ static_cast<Coordinate>(std::distance(_values.begin(), it)) };
 
-            return Position{ index % _height, index / _height };
+            return Position{ index % _width, index / _width };
         }
 
     private:
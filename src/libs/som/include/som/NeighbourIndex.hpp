@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "Network.hpp"
+
+namespace lms::som
+{
+    // For each ref vector, precomputed list of the ref vectors reached when growing a region from it:
+    // at each step, the closest (by ref vector distance) grid neighbour of the region is added, until
+    // the distance exceeds maxDistance or maxNeighbourCount is reached
+    class NeighbourIndex
+    {
+    public:
+        NeighbourIndex() = default;
+        NeighbourIndex(const Network& network, InputVector::Distance maxDistance, std::size_t maxNeighbourCount);
+
+        // Ordered by insertion in the region, does not contain position itself
+        std::span<const Position> getNeighbours(const Position& position) const;
+
+    private:
+        Coordinate _width{};
+        Coordinate _height{};
+        std::vector<std::size_t> _offsets; // indexed by x + width * y, neighbours are in [_offsets[i], _offsets[i + 1])
+        std::vector<Position> _neighbours;
+    };
+} // namespace lms::som
@@ -4,8 +4,11 @@
 #include <functional>
 #include <optional>
 #include <ostream>
+#include <span>
 #include <vector>
 
+#include "core/Random.hpp"
+
 #include "InputVector.hpp"
 #include "Matrix.hpp"
 
@@ -23,9 +26,13 @@ namespace lms::som
     public:
         // Init a network with random values
         Network(Coordinate width, Coordinate height, std::size_t inputDimCount);
+        // Init a network with random values taken from the given generator (use a seeded one to get reproducible trainings)
+        Network(Coordinate width, Coordinate height, std::size_t inputDimCount, core::random::RandGenerator& randGenerator);
+        // Init a network using existing ref vectors (same layout as getRefVectorsData), for instance read from a cache
+        Network(Coordinate width, Coordinate height, std::size_t inputDimCount, std::span<const InputVector::value_type> refVectorsData);
 
-        Coordinate getWidth() const { return _refVectors.getWidth(); }
-        Coordinate getHeight() const { return _refVectors.getHeight(); }
+        Coordinate getWidth() const { return _width; }
+        Coordinate getHeight() const { return _height; }
         std::size_t getInputDimCount() const { return _inputDimCount; }
         const InputVector& getDataWeights() const { return _weights; }
 
@@ -35,6 +42,10 @@ namespace lms::som
         // use this to manually construct a network without training
         void setRefVector(const Position& position, const InputVector& data);
 
+        // Raw access to all the ref vectors at once (row-major, getInputDimCount() values per ref vector)
+        std::span<const InputVector::value_type> getRefVectorsData() const { return _refVectors; }
+        void setRefVectorsData(std::span<const InputVector::value_type> values);
+
         // <!> data must be normalized
         struct CurrentIteration
         {
@@ -44,14 +55,23 @@ namespace lms::som
         using ProgressCallback = std::function<void(const CurrentIteration&)>;
         using RequestStopCallback = std::function<bool()>;
         void train(const std::vector<InputVector>& dataSamples, std::size_t nbIterations, ProgressCallback = ProgressCallback{}, RequestStopCallback = RequestStopCallback{});
+        // Samples are shuffled using the given generator (use a seeded one to get reproducible trainings)
+        void train(const std::vector<InputVector>& dataSamples, std::size_t nbIterations, core::random::RandGenerator& randGenerator, ProgressCallback = ProgressCallback{}, RequestStopCallback = RequestStopCallback{});
 
-        const InputVector& getRefVector(const Position& position) const;
+        // Batch training: for each iteration, all the samples are matched against the current ref vectors,
+        // then each ref vector is replaced by the neighbourhood weighted mean of the samples (learning factor is not used)
+        // Result does not depend on threadCount
+        void trainBatch(const std::vector<InputVector>& dataSamples, std::size_t nbIterations, std::size_t threadCount, ProgressCallback = ProgressCallback{}, RequestStopCallback = RequestStopCallback{});
+
+        InputVector getRefVector(const Position& position) const;
         Position getClosestRefVectorPosition(const InputVector& data) const;
         std::optional<Position> getClosestRefVectorPosition(const InputVector& data, InputVector::Distance maxDistance) const;
 
         std::optional<Position> getClosestRefVectorPosition(const std::vector<Position>& refVectorsPosition, InputVector::Distance maxDistance) const;
 
         InputVector::Distance getRefVectorsDistance(const Position& position1, const Position& position2) const;
+        // Distance between data and the ref vector at position (quantization error if position is the closest one)
+        InputVector::Distance getRefVectorDistance(const Position& position, const InputVector& data) const;
 
         InputVector::Distance computeRefVectorsDistanceMean() const;
         InputVector::Distance computeRefVectorsDistanceMedian() const;
@@ -62,9 +82,10 @@ namespace lms::som
         // i is the current iteration
         // refVector(i+1) = refVector(i) + LearningFactor(i) * NeighbourhoodFunc(i) * (MatchingRefVector - refVector)
 
+        // Default is the vectorized weighted square euclidian distance, setting a custom one disables the fast path
         using DistanceFunc = std::function<InputVector::Distance(const InputVector& /* a */, const InputVector& /* b */, const InputVector& /* weights */)>;
         void setDistanceFunc(DistanceFunc distanceFunc);
-        DistanceFunc getDistanceFunc() { return _distanceFunc; }
+        DistanceFunc getDistanceFunc() const;
 
         using LearningFactorFunc = std::function<LearningFactor(const CurrentIteration&)>;
         void setLearningFactorFunc(LearningFactorFunc learningFactorFunc);
@@ -72,15 +93,38 @@ namespace lms::som
         using NeighbourhoodFunc = std::function<InputVector::value_type(Norm /* norm(Position - CoordMatchingRefVector) */, const CurrentIteration&)>;
         void setNeighbourhoodFunc(NeighbourhoodFunc neighbourhoodFunc);
 
+        // Neighbourhood factors below this value are considered as null, so that only the ref vectors
+        // around the matching one are updated. 0 means all the ref vectors are always updated
+        void setNeighbourhoodCutoff(InputVector::value_type cutoff);
+
     private:
-        void updateRefVectors(const Position& closestRefVectorPosition, const InputVector& input, LearningFactor learningFactor, const CurrentIteration& iteration);
+        // Neighbourhood factors for the current iteration
+        struct Neighbourhood
+        {
+            std::vector<InputVector::value_type> factors; // indexed by |dx| + width * |dy|
+            Coordinate radius{};                          // factors are null if |dx| or |dy| is above radius
+        };
+        void computeNeighbourhood(const CurrentIteration& iteration, InputVector::value_type scale, Neighbourhood& neighbourhood) const;
+        void updateRefVectors(const Position& closestRefVectorPosition, const InputVector& input, const Neighbourhood& neighbourhood);
+
+        std::size_t getRefVectorIndex(const Position& position) const;
+        Position getRefVectorPosition(std::size_t index) const;
+        InputVector::value_type* getRefVectorData(std::size_t index) { return _refVectors.data() + index * _inputDimCount; }
+        const InputVector::value_type* getRefVectorData(std::size_t index) const { return _refVectors.data() + index * _inputDimCount; }
+        std::size_t getRefVectorCount() const { return static_cast<std::size_t>(_width) * _height; }
+
+        InputVector::Distance computeDistance(const InputVector::value_type* a, const InputVector::value_type* b) const;
+        std::size_t getClosestRefVectorIndex(const InputVector& data) const;
 
+        Coordinate _width{};
+        Coordinate _height{};
         std::size_t _inputDimCount{};
         InputVector _weights; // weight for each dimension
-        Matrix<InputVector> _refVectors;
+        std::vector<InputVector::value_type> _refVectors; // contiguous row-major storage: _inputDimCount values per ref vector, index is x + width * y
 
         DistanceFunc _distanceFunc;
         LearningFactorFunc _learningFactorFunc;
         NeighbourhoodFunc _neighbourhoodFunc;
+        InputVector::value_type _neighbourhoodCutoff{ 1e-4 };
     };
 } // namespace lms::som
@@ -0,0 +1,178 @@
+#include <sstream>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "ProtocolVersion.hpp"
+#include "ResponseWriter.hpp"
+#include "SubsonicResponse.hpp"
+#include "TLSMonotonicMemoryResource.hpp"
+
+namespace lms::api::subsonic
+{
+    namespace
+    {
+        // Roughly what a song of getRandomSongs/search3 looks like
+        constexpr std::size_t songCount{ 10'000 };
+        constexpr ProtocolVersion protocolVersion{ defaultServerProtocolVersion };
+
+        void addSongNode(Response::Node& songListNode, std::size_t index)
+        {
+            const std::string id{ "tr-" + std::to_string(index) };
+
+            Response::Node& songNode{ songListNode.createArrayChild("song") };
+            songNode.setAttribute("id", id);
+            songNode.setAttribute("isDir", false);
+            songNode.setAttribute("title", "Some track title");
+            songNode.setAttribute("album", "Some album title");
+            songNode.setAttribute("artist", "Some artist name");
+            songNode.setAttribute("track", index % 20);
+            songNode.setAttribute("discNumber", 1);
+            songNode.setAttribute("year", 1999);
+            songNode.setAttribute("genre", "Rock");
+            songNode.setAttribute("coverArt", id);
+            songNode.setAttribute("size", 12'345'678);
+            songNode.setAttribute("contentType", "audio/flac");
+            songNode.setAttribute("suffix", "flac");
+            songNode.setAttribute("duration", 245);
+            songNode.setAttribute("bitRate", 1'024);
+            songNode.setAttribute("path", "Some artist name/Some album title/01 - Some track title.flac");
+            songNode.setAttribute("albumId", "al-42");
+            songNode.setAttribute("artistId", "ar-7");
+            songNode.setAttribute("type", "music");
+            songNode.setAttribute("created", "2024-01-01T00:00:00.000Z");
+            songNode.setAttribute("playCount", 3);
+            songNode.setAttribute("bitDepth", 16);
+            songNode.setAttribute("samplingRate", 44'100);
+            songNode.setAttribute("channelCount", 2);
+            songNode.setAttribute("mediaType", "song");
+            songNode.setAttribute("comment", "");
+            songNode.setAttribute("sortName", "");
+            songNode.setAttribute("musicBrainzId", "1fbd2c41-8ab6-4bd5-a4f1-d9f5c8f7f3a1");
+            songNode.setAttribute("displayArtist", "Some artist name");
+            songNode.setAttribute("displayAlbumArtist", "Some artist name");
+            songNode.setAttribute("explicitStatus", "");
+
+            Response::Node& artistNode{ songNode.createArrayChild("artists") };
+            artistNode.setAttribute("id", "ar-7");
+            artistNode.setAttribute("name", "Some artist name");
+
+            songNode.addArrayValue("moods", "Happy");
+
+            Response::Node& genreNode{ songNode.createArrayChild("genres") };
+            genreNode.setAttribute("name", "Rock");
+
+            Response::Node& replayGainNode{ songNode.createChild("replayGain") };
+            replayGainNode.setAttribute("trackGain", -7.5f);
+            replayGainNode.setAttribute("trackPeak", 0.98f);
+        }
+
+        void writeSong(ResponseWriter& writer, std::size_t index)
+        {
+            const std::string id{ "tr-" + std::to_string(index) };
+
+            writer.beginArrayNode();
+            writer.writeAttribute("id", id);
+            writer.writeAttribute("isDir", false);
+            writer.writeAttribute("title", "Some track title");
+            writer.writeAttribute("album", "Some album title");
+            writer.writeAttribute("artist", "Some artist name");
+            writer.writeAttribute("track", index % 20);
+            writer.writeAttribute("discNumber", 1);
+            writer.writeAttribute("year", 1999);
+            writer.writeAttribute("genre", "Rock");
+            writer.writeAttribute("coverArt", id);
+            writer.writeAttribute("size", 12'345'678);
+            writer.writeAttribute("contentType", "audio/flac");
+            writer.writeAttribute("suffix", "flac");
+            writer.writeAttribute("duration", 245);
+            writer.writeAttribute("bitRate", 1'024);
+            writer.writeAttribute("path", "Some artist name/Some album title/01 - Some track title.flac");
+            writer.writeAttribute("albumId", "al-42");
+            writer.writeAttribute("artistId", "ar-7");
+            writer.writeAttribute("type", "music");
+            writer.writeAttribute("created", "2024-01-01T00:00:00.000Z");
+            writer.writeAttribute("playCount", 3);
+            writer.writeAttribute("bitDepth", 16);
+            writer.writeAttribute("samplingRate", 44'100);
+            writer.writeAttribute("channelCount", 2);
+            writer.writeAttribute("mediaType", "song");
+            writer.writeAttribute("comment", "");
+            writer.writeAttribute("sortName", "");
+            writer.writeAttribute("musicBrainzId", "1fbd2c41-8ab6-4bd5-a4f1-d9f5c8f7f3a1");
+            writer.writeAttribute("displayArtist", "Some artist name");
+            writer.writeAttribute("displayAlbumArtist", "Some artist name");
+            writer.writeAttribute("explicitStatus", "");
+
+            writer.beginArray("artists");
+            writer.beginArrayNode();
+            writer.writeAttribute("id", "ar-7");
+            writer.writeAttribute("name", "Some artist name");
+            writer.endNode();
+            writer.endArray();
+
+            writer.beginArray("moods");
+            writer.writeArrayValue("Happy");
+            writer.endArray();
+
+            writer.beginArray("genres");
+            writer.beginArrayNode();
+            writer.writeAttribute("name", "Rock");
+            writer.endNode();
+            writer.endArray();
+
+            writer.beginNode("replayGain");
+            writer.writeAttribute("trackGain", -7.5f);
+            writer.writeAttribute("trackPeak", 0.98f);
+            writer.endNode();
+
+            writer.endNode();
+        }
+
+        void BM_NodeResponse(benchmark::State& state, ResponseFormat format)
+        {
+            for (auto _ : state)
+            {
+                std::ostringstream oss;
+                {
+                    Response response{ Response::createOkResponse(protocolVersion) };
+                    Response::Node& songListNode{ response.createNode("randomSongs") };
+                    for (std::size_t i{}; i < songCount; ++i)
+                        addSongNode(songListNode, i);
+
+                    response.write(oss, format);
+                }
+                benchmark::DoNotOptimize(oss);
+
+                // same as what is done once each request is handled
+                TLSMonotonicMemoryResource::getInstance().reset();
+            }
+        }
+
+        void BM_PushResponse(benchmark::State& state, ResponseFormat format)
+        {
+            for (auto _ : state)
+            {
+                std::ostringstream oss;
+                Response::writeOkResponse(oss, format, protocolVersion, [](ResponseWriter& writer) {
+                    writer.beginNode("randomSongs");
+                    writer.beginArray("song");
+                    for (std::size_t i{}; i < songCount; ++i)
+                        writeSong(writer, i);
+                    writer.endArray();
+                    writer.endNode();
+                });
+                benchmark::DoNotOptimize(oss);
+
+                TLSMonotonicMemoryResource::getInstance().reset();
+            }
+        }
+    } // namespace
+
+    BENCHMARK_CAPTURE(BM_NodeResponse, json, ResponseFormat::json)->Unit(benchmark::kMillisecond);
+    BENCHMARK_CAPTURE(BM_PushResponse, json, ResponseFormat::json)->Unit(benchmark::kMillisecond);
+    BENCHMARK_CAPTURE(BM_NodeResponse, xml, ResponseFormat::xml)->Unit(benchmark::kMillisecond);
+    BENCHMARK_CAPTURE(BM_PushResponse, xml, ResponseFormat::xml)->Unit(benchmark::kMillisecond);
+} // namespace lms::api::subsonic
+
+BENCHMARK_MAIN();
@@ -0,0 +1,160 @@
+#include "ArtistIndex.hpp"
+
+#include <cctype>
+#include <unordered_map>
+#include <utility>
+
+#include "core/ILogger.hpp"
+#include "core/ITraceLogger.hpp"
+#include "database/Session.hpp"
+#include "database/objects/Artist.hpp"
+#include "database/objects/Artwork.hpp"
+#include "database/objects/TrackArtistLink.hpp"
+
+namespace lms::api::subsonic
+{
+    namespace
+    {
+        char getBucketName(std::string_view sortName)
+        {
+            if (sortName.empty() || !std::isalpha(static_cast<unsigned char>(sortName[0])))
+                return '#';
+
+            return static_cast<char>(std::toupper(static_cast<unsigned char>(sortName[0])));
+        }
+
+        std::shared_ptr<const ArtistIndex::Buckets> buildBuckets(db::Session& session, db::MediaLibraryId library, db::SubsonicArtistListMode mode)
+        {
+            LMS_SCOPED_TRACE_OVERVIEW("Subsonic", "BuildArtistIndex");
+
+            db::Artist::FindParameters params;
+            params.setSortMethod(db::ArtistSortMethod::SortName);
+            switch (mode)
+            {
+            case db::SubsonicArtistListMode::AllArtists:
+                break;
+            case db::SubsonicArtistListMode::ReleaseArtists:
+                params.setLinkType(db::TrackArtistLinkType::ReleaseArtist);
+                break;
+            case db::SubsonicArtistListMode::TrackArtists:
+                params.setLinkType(db::TrackArtistLinkType::Artist);
+                break;
+            }
+            params.filters.setMediaLibrary(library);
+
+            std::map<char, std::vector<ArtistIndex::Artist>> artistsByBucketName;
+            std::size_t artistCount{};
+
+            // Use short lived transactions in order not to block the whole application
+            // Each batch resumes right after the last retrieved artist (keyset pagination)
+            constexpr std::size_t batchSize{ 500 };
+            params.setRange(db::Range{ 0, batchSize });
+            bool hasMoreArtists{ true };
+            while (hasMoreArtists)
+            {
+                auto transaction{ session.createReadTransaction() };
+
+                const auto artists{ db::Artist::find(session, params) };
+
+                std::vector<db::ArtistId> artistIds;
+                std::vector<db::ArtworkId> artworkIds;
+                std::vector<ArtistIndex::Artist> indexedArtists;
+                indexedArtists.reserve(artists.results.size());
+                for (const db::Artist::pointer& artist : artists.results)
+                {
+                    artistIds.push_back(artist->getId());
+                    if (const db::ArtworkId artworkId{ artist->getPreferredArtworkId() }; artworkId.isValid())
+                        artworkIds.push_back(artworkId);
+
+                    indexedArtists.push_back(ArtistIndex::Artist{
+                        .id = artist->getId(),
+                        .name = artist->getName(),
+                        .sortName = artist->getSortName(),
+                        .mbid = artist->getMBID(),
+                        .artworkId = artist->getPreferredArtworkId(),
+                    });
+                }
+
+                std::unordered_map<db::ArtistId, std::size_t> albumCounts;
+                db::Artist::findReleaseCounts(session, artistIds, [&](db::ArtistId artistId, std::size_t releaseCount) {
+                    albumCounts.emplace(artistId, releaseCount);
+                });
+
+                std::unordered_map<db::ArtistId, core::EnumSet<db::TrackArtistLinkType>> roles;
+                db::TrackArtistLink::findUsedTypes(session, artistIds, [&](db::ArtistId artistId, db::TrackArtistLinkType type) {
+                    roles[artistId].insert(type);
+                });
+
+                std::unordered_map<db::ArtworkId, std::time_t> artworkLastWrittenTimes;
+                db::Artwork::findLastWrittenTimes(session, artworkIds, [&](db::ArtworkId artworkId, const Wt::WDateTime& lastWrittenTime) {
+                    artworkLastWrittenTimes.emplace(artworkId, lastWrittenTime.toTime_t());
+                });
+
+                for (ArtistIndex::Artist& artist : indexedArtists)
+                {
+                    if (const auto it{ albumCounts.find(artist.id) }; it != std::cend(albumCounts))
+                        artist.albumCount = it->second;
+                    if (const auto it{ roles.find(artist.id) }; it != std::cend(roles))
+                        artist.roles = it->second;
+                    if (const auto it{ artworkLastWrittenTimes.find(artist.artworkId) }; it != std::cend(artworkLastWrittenTimes))
+                        artist.artworkLastWrittenTime = it->second;
+
+                    const char bucketName{ getBucketName(artist.sortName) };
+                    artistsByBucketName[bucketName].push_back(std::move(artist));
+                }
+
+                hasMoreArtists = artists.moreResults;
+                artistCount += artists.results.size();
+                if (!artists.results.empty())
+                    params.setAfter(db::KeysetCursor<db::ArtistId>{ .sortKey = artists.results.back()->getSortName(), .id = artists.results.back()->getId() });
+            }
+
+            auto buckets{ std::make_shared<ArtistIndex::Buckets>() };
+            buckets->reserve(artistsByBucketName.size());
+            for (auto& [bucketName, artists] : artistsByBucketName)
+                buckets->push_back(ArtistIndex::Bucket{ bucketName, std::move(artists) });
+
+            LMS_LOG(API_SUBSONIC, DEBUG, "Built artist index: " << artistCount << " artists in " << buckets->size() << " buckets");
+
+            return buckets;
+        }
+    } // namespace
+
+    std::shared_ptr<const ArtistIndex::Buckets> ArtistIndex::getBuckets(db::Session& session, db::MediaLibraryId library, db::SubsonicArtistListMode mode)
+    {
+        std::shared_ptr<Entry> entry;
+        {
+            const std::scoped_lock lock{ _mutex };
+
+            std::shared_ptr<Entry>& mapEntry{ _entries[Key{ library, mode }] };
+            if (!mapEntry)
+                mapEntry = std::make_shared<Entry>();
+            entry = mapEntry;
+        }
+
+        // Building under the entry lock: concurrent clients requesting the same index just wait for it, other indexes are not blocked
+        const std::scoped_lock lock{ entry->mutex };
+        if (!entry->buckets)
+            entry->buckets = buildBuckets(session, library, mode);
+
+        return entry->buckets;
+    }
+
+    void ArtistIndex::rebuild(db::Session& session)
+    {
+        std::vector<std::pair<Key, std::shared_ptr<Entry>>> entries;
+        {
+            const std::scoped_lock lock{ _mutex };
+            entries.assign(std::cbegin(_entries), std::cend(_entries));
+        }
+
+        for (const auto& [key, entry] : entries)
+        {
+            std::shared_ptr<const Buckets> buckets{ buildBuckets(session, key.library, key.mode) };
+
+            // may wait for a first build that started before the scan completed: ours must win
+            const std::scoped_lock lock{ entry->mutex };
+            entry->buckets = std::move(buckets);
+        }
+    }
+} // namespace lms::api::subsonic
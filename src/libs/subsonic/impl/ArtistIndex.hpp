@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/EnumSet.hpp"
+#include "core/UUID.hpp"
+#include "database/Types.hpp"
+#include "database/objects/ArtistId.hpp"
+#include "database/objects/ArtworkId.hpp"
+#include "database/objects/MediaLibraryId.hpp"
+
+namespace lms::db
+{
+    class Session;
+}
+
+namespace lms::api::subsonic
+{
+    // ArtistIndex: 按媒体库和艺术家列表模式预先计算的艺术家索引（排序名、首字母分组、专辑数、封面），扫描完成后重建。
+    // ArtistIndex: предвычисленный индекс артистов по медиатеке и режиму списка (имя сортировки, группа по первой букве, число альбомов, обложка), перестраивается после каждого сканирования.
+    //
+    // Only holds user independent data
+    // Each index is built on its first request, and rebuilt in the background by the scanner once a scan has completed
+    class ArtistIndex
+    {
+    public:
+        struct Artist
+        {
+            db::ArtistId id;
+            std::string name;
+            std::string sortName;
+            std::optional<core::UUID> mbid;
+            std::size_t albumCount{};
+            db::ArtworkId artworkId;
+            std::time_t artworkLastWrittenTime{};
+            core::EnumSet<db::TrackArtistLinkType> roles;
+        };
+
+        struct Bucket
+        {
+            char name;
+            std::vector<Artist> artists; // ordered by sort name
+        };
+
+        using Buckets = std::vector<Bucket>; // ordered by name
+
+        std::shared_ptr<const Buckets> getBuckets(db::Session& session, db::MediaLibraryId library, db::SubsonicArtistListMode mode);
+
+        // Rebuilds the indexes already requested, the previous ones are served in the meantime
+        void rebuild(db::Session& session);
+
+    private:
+        struct Key
+        {
+            db::MediaLibraryId library;
+            db::SubsonicArtistListMode mode;
+
+            auto operator<=>(const Key&) const = default;
+        };
+
+        struct Entry
+        {
+            std::mutex mutex; // held during the first build only
+            std::shared_ptr<const Buckets> buckets;
+        };
+
+        std::mutex _mutex;
+        std::map<Key, std::shared_ptr<Entry>> _entries;
+    };
+} // namespace lms::api::subsonic
@@ -25,11 +25,12 @@ namespace lms::api::subsonic
         }
     } // namespace
 
-    RequestContext::RequestContext(const Wt::Http::Request& request, db::Session& dbSession, db::ObjectPtr<db::User> user, const SubsonicResourceConfig& config)
+    RequestContext::RequestContext(const Wt::Http::Request& request, db::Session& dbSession, db::ObjectPtr<db::User> user, const SubsonicResourceConfig& config, ArtistIndex& artistIndex)
         : _request{ request }
         , _dbSession{ dbSession }
         , _user{ user }
         , _config{ config }
+        , _artistIndex{ artistIndex }
         , _clientName{ getMandatoryParameterAs<std::string>(_request.getParameterMap(), "c") }
         , _clientProtocolVersion{ getMandatoryParameterAs<ProtocolVersion>(_request.getParameterMap(), "v") }
         , _responseFormat{ getParameterAs<std::string>(request.getParameterMap(), "f").value_or("xml") == "json" ? ResponseFormat::json : ResponseFormat::xml }
@@ -21,10 +21,12 @@ namespace lms::db
 
 namespace lms::api::subsonic
 {
+    class ArtistIndex;
+
     class RequestContext
     {
     public:
-        RequestContext(const Wt::Http::Request& request, db::Session& dbSession, db::ObjectPtr<db::User> user, const SubsonicResourceConfig& config);
+        RequestContext(const Wt::Http::Request& request, db::Session& dbSession, db::ObjectPtr<db::User> user, const SubsonicResourceConfig& config, ArtistIndex& artistIndex);
         ~RequestContext();
         RequestContext(const RequestContext&) = delete;
         RequestContext& operator=(const RequestContext&) = delete;
@@ -36,6 +38,7 @@ namespace lms::api::subsonic
 
         db::Session& getDbSession();
         db::ObjectPtr<db::User> getUser() const;
+        ArtistIndex& getArtistIndex() { return _artistIndex; }
 
         std::string getClientIpAddr() const;
         std::string_view getClientName() const;
@@ -49,6 +52,7 @@ namespace lms::api::subsonic
         db::Session& _dbSession;
         db::ObjectPtr<db::User> _user;
         const SubsonicResourceConfig& _config;
+        ArtistIndex& _artistIndex;
 
         const std::string _clientName;
         const ProtocolVersion _clientProtocolVersion;
@@ -0,0 +1,216 @@
+#include "ResponseCache.hpp"
+
+#include <array>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+
+#include "core/ILogger.hpp"
+
+#include "ScanGeneration.hpp"
+
+namespace lms::api::subsonic
+{
+    namespace
+    {
+        bool isAuthenticationParameter(std::string_view name)
+        {
+            return name == "u" || name == "p" || name == "t" || name == "s" || name == "apiKey";
+        }
+
+        void appendKeyPart(std::string& key, std::string_view part)
+        {
+            // length prefixed, so that any value is unambiguous
+            key += std::to_string(part.size());
+            key += ':';
+            key += part;
+        }
+
+        std::string computeETag(std::string_view body)
+        {
+            std::ostringstream oss;
+            oss << '"' << std::hex << std::setfill('0') << std::setw(16) << std::hash<std::string_view>{}(body) << '"';
+            return oss.str();
+        }
+
+        // IMF-fixdate, as used in HTTP headers (RFC 9110)
+        std::string toHttpDate(std::chrono::system_clock::time_point time)
+        {
+            constexpr std::array<std::string_view, 7> weekDayNames{ "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+            constexpr std::array<std::string_view, 12> monthNames{ "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+            const auto days{ std::chrono::floor<std::chrono::days>(time) };
+            const std::chrono::year_month_day date{ days };
+            const std::chrono::weekday weekDay{ days };
+            const std::chrono::hh_mm_ss timeOfDay{ std::chrono::floor<std::chrono::seconds>(time - days) };
+
+            std::ostringstream oss;
+            oss << weekDayNames[weekDay.c_encoding()] << ", "
+                << std::setfill('0') << std::setw(2) << static_cast<unsigned>(date.day()) << ' '
+                << monthNames[static_cast<unsigned>(date.month()) - 1] << ' '
+                << static_cast<int>(date.year()) << ' '
+                << std::setw(2) << timeOfDay.hours().count() << ':'
+                << std::setw(2) << timeOfDay.minutes().count() << ':'
+                << std::setw(2) << timeOfDay.seconds().count() << " GMT";
+            return oss.str();
+        }
+    } // namespace
+
+    ResponseCache::ResponseCache(std::size_t maxCacheSize, std::chrono::seconds maxEntryAge)
+        : _maxCacheSize{ maxCacheSize }
+        , _maxEntryAge{ maxEntryAge }
+    {
+    }
+
+    ResponseCache::~ResponseCache() = default;
+
+    std::string ResponseCache::computeKey(std::string_view endpoint, const Wt::Http::ParameterMap& parameters, db::UserId user)
+    {
+        std::string key;
+
+        appendKeyPart(key, endpoint);
+        appendKeyPart(key, user.toString());
+
+        // parameters are already sorted by name
+        for (const auto& [name, values] : parameters)
+        {
+            if (isAuthenticationParameter(name))
+                continue;
+
+            appendKeyPart(key, name);
+            appendKeyPart(key, std::to_string(values.size()));
+            for (const std::string& value : values)
+                appendKeyPart(key, value);
+        }
+
+        return key;
+    }
+
+    std::shared_ptr<const ResponseCache::Entry> ResponseCache::getEntry(const std::string& key)
+    {
+        const Wt::WDateTime scanGeneration{ getScanGeneration() };
+        const std::scoped_lock lock{ _mutex };
+
+        checkScanGeneration(scanGeneration);
+
+        const auto itEntry{ _entriesByKey.find(key) };
+        if (itEntry == std::cend(_entriesByKey))
+        {
+            _cacheMisses++;
+            return {};
+        }
+
+        const CachedEntries::iterator itCachedEntry{ itEntry->second };
+        if (std::chrono::steady_clock::now() - itCachedEntry->creationTime > _maxEntryAge)
+        {
+            removeEntry(itCachedEntry);
+            _cacheInvalidations++;
+            _cacheMisses++;
+            return {};
+        }
+
+        _cacheHits++;
+        _entries.splice(std::begin(_entries), _entries, itCachedEntry);
+        return itCachedEntry->entry;
+    }
+
+    std::shared_ptr<const ResponseCache::Entry> ResponseCache::addEntry(const std::string& key, db::UserId user, const Wt::WDateTime& scanGeneration, std::string body, std::string mimeType)
+    {
+        auto entry{ std::make_shared<Entry>() };
+        entry->etag = computeETag(body);
+        entry->lastModified = toHttpDate(std::chrono::system_clock::now());
+        entry->body = std::move(body);
+        entry->mimeType = std::move(mimeType);
+
+        CachedEntry cachedEntry{
+            .key = key,
+            .user = user,
+            .creationTime = std::chrono::steady_clock::now(),
+            .entry = entry,
+        };
+        const std::size_t entrySize{ getEntrySize(cachedEntry) };
+        if (entrySize > _maxCacheSize)
+            return entry;
+
+        const Wt::WDateTime currentScanGeneration{ getScanGeneration() };
+        if (scanGeneration != currentScanGeneration)
+            return entry; // computed using outdated data
+
+        const std::scoped_lock lock{ _mutex };
+
+        checkScanGeneration(currentScanGeneration);
+
+        // concurrent requests may have computed the same response
+        if (const auto itEntry{ _entriesByKey.find(key) }; itEntry != std::cend(_entriesByKey))
+            removeEntry(itEntry->second);
+
+        while (_cacheSize + entrySize > _maxCacheSize && !_entries.empty())
+        {
+            removeEntry(std::prev(std::end(_entries)));
+            _cacheEvictions++;
+        }
+
+        _entries.push_front(std::move(cachedEntry));
+        _entriesByKey.emplace(_entries.front().key, std::begin(_entries));
+        _cacheSize += entrySize;
+
+        return entry;
+    }
+
+    void ResponseCache::invalidateUserEntries(db::UserId user)
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        for (auto itEntry{ std::begin(_entries) }; itEntry != std::end(_entries);)
+        {
+            auto itNextEntry{ std::next(itEntry) };
+            if (itEntry->user == user)
+            {
+                removeEntry(itEntry);
+                _cacheInvalidations++;
+            }
+            itEntry = itNextEntry;
+        }
+    }
+
+    void ResponseCache::checkScanGeneration(const Wt::WDateTime& scanGeneration)
+    {
+        if (scanGeneration == _scanGeneration)
+            return;
+
+        LMS_LOG(API_SUBSONIC, DEBUG, "Response cache stats: hits = " << _cacheHits << ", misses = " << _cacheMisses << ", evictions = " << _cacheEvictions << ", invalidations = " << _cacheInvalidations << ", nb entries = " << _entries.size() << ", size = " << _cacheSize);
+
+        _scanGeneration = scanGeneration;
+        _cacheInvalidations += _entries.size();
+        _entriesByKey.clear();
+        _entries.clear();
+        _cacheSize = 0;
+    }
+
+    ResponseCache::Stats ResponseCache::getStats() const
+    {
+        const std::scoped_lock lock{ _mutex };
+
+        return Stats{
+            .hits = _cacheHits,
+            .misses = _cacheMisses,
+            .evictions = _cacheEvictions,
+            .invalidations = _cacheInvalidations,
+            .entryCount = _entries.size(),
+            .size = _cacheSize,
+            .maxSize = _maxCacheSize,
+        };
+    }
+
+    void ResponseCache::removeEntry(CachedEntries::iterator itEntry)
+    {
+        _cacheSize -= getEntrySize(*itEntry);
+        _entriesByKey.erase(itEntry->key);
+        _entries.erase(itEntry);
+    }
+
+    std::size_t ResponseCache::getEntrySize(const CachedEntry& entry)
+    {
+        return entry.key.size() + entry.entry->body.size() + entry.entry->mimeType.size() + entry.entry->etag.size() + entry.entry->lastModified.size();
+    }
+} // namespace lms::api::subsonic
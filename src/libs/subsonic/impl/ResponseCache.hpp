@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <Wt/Http/Request.h>
+#include <Wt/WDateTime.h>
+
+#include "database/objects/UserId.hpp"
+
+namespace lms::api::subsonic
+{
+    // ResponseCache: 只读端点的响应缓存（按端点、规范化参数、用户键入），扫描完成后失效，按 LRU 限制最大内存占用。
+    // ResponseCache: кэш ответов эндпоинтов только для чтения (по эндпоинту, нормализованным параметрам и пользователю), сбрасывается после сканирования, ограничивает память по LRU.
+    //
+    // Entries are also dropped when their user modifies its own data through the API, or when they get too old
+    // (user data can also be modified using other means)
+    class ResponseCache
+    {
+    public:
+        ResponseCache(std::size_t maxCacheSize, std::chrono::seconds maxEntryAge);
+        ~ResponseCache();
+        ResponseCache(const ResponseCache&) = delete;
+        ResponseCache& operator=(const ResponseCache&) = delete;
+
+        struct Entry
+        {
+            std::string body;
+            std::string mimeType;
+            std::string etag;         // computed from the body
+            std::string lastModified; // HTTP-date
+        };
+
+        // Authentication parameters are not part of the key (the user already is)
+        static std::string computeKey(std::string_view endpoint, const Wt::Http::ParameterMap& parameters, db::UserId user);
+
+        std::shared_ptr<const Entry> getEntry(const std::string& key);
+        // scanGeneration must have been retrieved before computing the response (see getScanGeneration)
+        std::shared_ptr<const Entry> addEntry(const std::string& key, db::UserId user, const Wt::WDateTime& scanGeneration, std::string body, std::string mimeType);
+        void invalidateUserEntries(db::UserId user);
+
+        // Counters are cumulated since the cache creation
+        struct Stats
+        {
+            std::size_t hits{};
+            std::size_t misses{};
+            std::size_t evictions{};     // to make room for new entries
+            std::size_t invalidations{}; // scan completed, user data modified or entry too old
+            std::size_t entryCount{};
+            std::size_t size{};
+            std::size_t maxSize{};
+        };
+        Stats getStats() const;
+
+    private:
+        struct CachedEntry
+        {
+            std::string key;
+            db::UserId user;
+            std::chrono::steady_clock::time_point creationTime;
+            std::shared_ptr<const Entry> entry;
+        };
+        using CachedEntries = std::list<CachedEntry>; // most recently used first
+
+        void checkScanGeneration(const Wt::WDateTime& scanGeneration);
+        void removeEntry(CachedEntries::iterator itEntry);
+        static std::size_t getEntrySize(const CachedEntry& entry);
+
+        const std::size_t _maxCacheSize;
+        const std::chrono::seconds _maxEntryAge;
+
+        mutable std::mutex _mutex;
+        Wt::WDateTime _scanGeneration;
+        CachedEntries _entries;
+        std::unordered_map<std::string_view, CachedEntries::iterator> _entriesByKey; // keys owned by _entries
+        std::size_t _cacheSize{};
+        std::size_t _cacheHits{};
+        std::size_t _cacheMisses{};
+        std::size_t _cacheEvictions{};
+        std::size_t _cacheInvalidations{};
+    };
+} // namespace lms::api::subsonic
@@ -0,0 +1,485 @@
+#include "ResponseWriter.hpp"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <streambuf>
+#include <vector>
+
+#include "core/String.hpp"
+#include "core/Utils.hpp"
+
+namespace lms::api::subsonic
+{
+    namespace
+    {
+        class StreamResponseWriter : public ResponseWriter
+        {
+        protected:
+            StreamResponseWriter(std::ostream& os)
+                : _buffer{ os }
+                , _os{ &_buffer }
+            {
+            }
+
+            // Output buffered by chunks: the target stream only sees large writes
+            std::ostream& getOutputStream() { return _os; }
+            void flushOutput() { _os.flush(); }
+
+        private:
+            class ChunkedOutputBuffer final : public std::streambuf
+            {
+            public:
+                ChunkedOutputBuffer(std::ostream& os)
+                    : _target{ os }
+                {
+                    setp(_chunk.data(), _chunk.data() + _chunk.size());
+                }
+
+            private:
+                int_type overflow(int_type ch) override
+                {
+                    flushChunk();
+
+                    if (traits_type::eq_int_type(ch, traits_type::eof()))
+                        return traits_type::not_eof(ch);
+
+                    *pptr() = traits_type::to_char_type(ch);
+                    pbump(1);
+                    return ch;
+                }
+
+                int sync() override
+                {
+                    flushChunk();
+                    return _target ? 0 : -1;
+                }
+
+                void flushChunk()
+                {
+                    if (pptr() != pbase())
+                        _target.write(pbase(), pptr() - pbase());
+
+                    setp(_chunk.data(), _chunk.data() + _chunk.size());
+                }
+
+                std::ostream& _target;
+                std::array<char, 32 * 1024> _chunk;
+            };
+
+            ChunkedOutputBuffer _buffer;
+            std::ostream _os;
+        };
+
+        class JsonResponseWriter final : public StreamResponseWriter
+        {
+        public:
+            JsonResponseWriter(std::ostream& os)
+                : StreamResponseWriter{ os }
+            {
+                getOutputStream() << '{';
+                _hasMembers.push_back(false);
+            }
+
+        private:
+            void beginNode(Key key) override
+            {
+                writeMemberKey(key);
+                getOutputStream() << '{';
+                _hasMembers.push_back(false);
+            }
+
+            void endNode() override
+            {
+                getOutputStream() << '}';
+                _hasMembers.pop_back();
+            }
+
+            void beginArray(Key key) override
+            {
+                writeMemberKey(key);
+                getOutputStream() << '[';
+                _hasMembers.push_back(false);
+            }
+
+            void beginArrayNode() override
+            {
+                writeSeparatorIfNeeded();
+                getOutputStream() << '{';
+                _hasMembers.push_back(false);
+            }
+
+            void endArray() override
+            {
+                getOutputStream() << ']';
+                _hasMembers.pop_back();
+            }
+
+            void writeAttributeValue(Key key, const Value& value) override
+            {
+                writeMemberKey(key);
+                writeJsonValue(value);
+            }
+
+            void writeNodeValue(const Value& /*value*/) override
+            {
+                // Values are handled manually (using attributes) in json format
+                assert(false);
+            }
+
+            void writeArrayElementValue(const Value& value) override
+            {
+                writeSeparatorIfNeeded();
+                writeJsonValue(value);
+            }
+
+            void finish() override
+            {
+                assert(_hasMembers.size() == 1);
+                getOutputStream() << '}';
+                flushOutput();
+            }
+
+            void writeSeparatorIfNeeded()
+            {
+                if (_hasMembers.back())
+                    getOutputStream() << ',';
+                _hasMembers.back() = true;
+            }
+
+            void writeMemberKey(Key key)
+            {
+                writeSeparatorIfNeeded();
+                writeEscapedString(key.str());
+                getOutputStream() << ':';
+            }
+
+            void writeEscapedString(std::string_view str)
+            {
+                std::ostream& os{ getOutputStream() };
+
+                os << '\"';
+                core::stringUtils::writeJsonEscapedString(os, str);
+                os << '\"';
+            }
+
+            void writeJsonValue(const Value& value)
+            {
+                std::ostream& os{ getOutputStream() };
+
+                std::visit(
+                    core::utils::overloads{
+                        [&](std::string_view str) { writeEscapedString(str); },
+                        [&](bool value) { os << (value ? "true" : "false"); },
+                        [&](float value) {
+                            if (std::isnan(value) || std::fabs(value) == std::numeric_limits<float>::infinity())
+                                os << "null";
+                            else
+                                os << value;
+                        },
+                        [&](long long value) { os << value; } },
+                    value);
+            }
+
+            std::vector<bool> _hasMembers; // for each opened object/array
+        };
+
+        class XmlResponseWriter final : public StreamResponseWriter
+        {
+        public:
+            XmlResponseWriter(std::ostream& os)
+                : StreamResponseWriter{ os }
+            {
+                getOutputStream() << R"(<?xml version="1.0" encoding="utf-8"?>)" << '\n';
+            }
+
+        private:
+            struct Element
+            {
+                Key key;
+                bool isArray{};
+                bool isOpeningTagPending{}; // attributes can still be written
+            };
+
+            void beginNode(Key key) override
+            {
+                closePendingOpeningTag();
+                openTag(key);
+            }
+
+            void endNode() override
+            {
+                assert(!_elements.empty() && !_elements.back().isArray);
+
+                const Element& element{ _elements.back() };
+                if (element.isOpeningTagPending)
+                {
+                    writeNamespaceIfNeeded(element.key);
+                    getOutputStream() << "/>"; // Self-closing tag
+                }
+                else
+                    getOutputStream() << "</" << element.key.str() << '>';
+
+                _elements.pop_back();
+            }
+
+            void beginArray(Key key) override
+            {
+                closePendingOpeningTag();
+                _elements.push_back(Element{ .key = key, .isArray = true });
+            }
+
+            void beginArrayNode() override
+            {
+                assert(!_elements.empty() && _elements.back().isArray);
+                openTag(_elements.back().key);
+            }
+
+            void endArray() override
+            {
+                assert(!_elements.empty() && _elements.back().isArray);
+                _elements.pop_back();
+            }
+
+            void writeAttributeValue(Key key, const Value& value) override
+            {
+                assert(!_elements.empty() && _elements.back().isOpeningTagPending);
+
+                std::ostream& os{ getOutputStream() };
+                os << ' ' << key.str() << "=\"";
+                writeXmlValue(value);
+                os << '"';
+            }
+
+            void writeNodeValue(const Value& value) override
+            {
+                closePendingOpeningTag();
+                writeXmlValue(value);
+            }
+
+            void writeArrayElementValue(const Value& value) override
+            {
+                assert(!_elements.empty() && _elements.back().isArray);
+
+                std::ostream& os{ getOutputStream() };
+                const std::string_view tagName{ _elements.back().key.str() };
+
+                os << '<' << tagName << '>';
+                writeXmlValue(value);
+                os << "</" << tagName << '>';
+            }
+
+            void finish() override
+            {
+                assert(_elements.empty());
+                flushOutput();
+            }
+
+            void openTag(Key key)
+            {
+                getOutputStream() << '<' << key.str();
+                _elements.push_back(Element{ .key = key, .isOpeningTagPending = true });
+            }
+
+            void closePendingOpeningTag()
+            {
+                if (!_elements.empty() && _elements.back().isOpeningTagPending)
+                {
+                    writeNamespaceIfNeeded(_elements.back().key);
+                    getOutputStream() << '>';
+                    _elements.back().isOpeningTagPending = false;
+                }
+            }
+
+            // Hack: written as the last attribute of the root element
+            void writeNamespaceIfNeeded(Key key)
+            {
+                if (key.str() == "subsonic-response")
+                    getOutputStream() << " xmlns=\"http://subsonic.org/restapi\"";
+            }
+
+            void writeXmlValue(const Value& value)
+            {
+                std::ostream& os{ getOutputStream() };
+
+                std::visit(core::utils::overloads{
+                               [&](std::string_view str) { core::stringUtils::writeXmlEscapedString(os, str); },
+                               [&](bool value) { os << (value ? "true" : "false"); },
+                               [&](float value) { os << value; },
+                               [&](long long value) { os << value; } },
+                           value);
+            }
+
+            std::vector<Element> _elements;
+        };
+
+        class NodeResponseWriter final : public ResponseWriter
+        {
+        public:
+            NodeResponseWriter(Response::Node& node)
+            {
+                _frames.push_back(Frame{ .node = &node });
+            }
+
+        private:
+            struct Frame
+            {
+                Response::Node* node{};
+                std::optional<Key> arrayKey; // set for arrays
+                bool hasArrayElements{};
+            };
+
+            void beginNode(Key key) override
+            {
+                _frames.push_back(Frame{ .node = &getCurrentNode().createChild(key) });
+            }
+
+            void endNode() override
+            {
+                assert(_frames.size() > 1 && !_frames.back().arrayKey);
+                _frames.pop_back();
+            }
+
+            void beginArray(Key key) override
+            {
+                _frames.push_back(Frame{ .node = &getCurrentNode(), .arrayKey = key });
+            }
+
+            void beginArrayNode() override
+            {
+                Frame& arrayFrame{ _frames.back() };
+                assert(arrayFrame.arrayKey);
+                arrayFrame.hasArrayElements = true;
+
+                _frames.push_back(Frame{ .node = &getCurrentNode().createArrayChild(*arrayFrame.arrayKey) });
+            }
+
+            void endArray() override
+            {
+                const Frame& arrayFrame{ _frames.back() };
+                assert(arrayFrame.arrayKey);
+
+                // empty arrays are written the same way, whether they would hold nodes or values
+                if (!arrayFrame.hasArrayElements)
+                    arrayFrame.node->createEmptyArrayChild(*arrayFrame.arrayKey);
+
+                _frames.pop_back();
+            }
+
+            void writeAttributeValue(Key key, const Value& value) override
+            {
+                Response::Node& node{ getCurrentNode() };
+                std::visit([&](auto attributeValue) { node.setAttribute(key, attributeValue); }, value);
+            }
+
+            void writeNodeValue(const Value& value) override
+            {
+                Response::Node& node{ getCurrentNode() };
+                std::visit(core::utils::overloads{
+                               [&](std::string_view str) { node.setValue(str); },
+                               [&](long long value) { node.setValue(value); },
+                               [&](auto) { assert(false); } }, // not used in responses
+                           value);
+            }
+
+            void writeArrayElementValue(const Value& value) override
+            {
+                Frame& arrayFrame{ _frames.back() };
+                assert(arrayFrame.arrayKey);
+                arrayFrame.hasArrayElements = true;
+
+                const Key key{ *arrayFrame.arrayKey };
+
+                Response::Node& node{ getCurrentNode() };
+                std::visit(core::utils::overloads{
+                               [&](std::string_view str) { node.addArrayValue(key, str); },
+                               [&](long long value) { node.addArrayValue(key, value); },
+                               [&](auto) { assert(false); } }, // not used in responses
+                           value);
+            }
+
+            void finish() override
+            {
+                assert(_frames.size() == 1);
+            }
+
+            Response::Node& getCurrentNode() { return *_frames.back().node; }
+
+            std::vector<Frame> _frames;
+        };
+    } // namespace
+
+    ResponseWriter::~ResponseWriter() = default;
+
+    void ResponseWriter::writeNode(Key key, const Response::Node& node)
+    {
+        beginNode(key);
+        writeNodeContent(node);
+        endNode();
+    }
+
+    void ResponseWriter::writeArrayNode(const Response::Node& node)
+    {
+        beginArrayNode();
+        writeNodeContent(node);
+        endNode();
+    }
+
+    void ResponseWriter::writeNodeContent(const Response::Node& node)
+    {
+        for (const auto& [key, value] : node._attributes)
+            writeAttributeValue(key, toValue(value));
+
+        if (node._value)
+            writeNodeValue(toValue(*node._value));
+
+        for (const auto& [key, childNode] : node._children)
+            writeNode(key, childNode);
+
+        for (const auto& [key, childArrayNodes] : node._childrenArrays)
+        {
+            beginArray(key);
+            for (const Response::Node& childNode : childArrayNodes)
+                writeArrayNode(childNode);
+            endArray();
+        }
+
+        for (const auto& [key, childValues] : node._childrenValues)
+        {
+            beginArray(key);
+            for (const Response::Node::ValueType& childValue : childValues)
+                writeArrayElementValue(toValue(childValue));
+            endArray();
+        }
+    }
+
+    ResponseWriter::Value ResponseWriter::toValue(const Response::Node::ValueType& value)
+    {
+        return std::visit(core::utils::overloads{
+                              [](const Response::Node::string& str) -> Value { return std::string_view{ str }; },
+                              [](bool value) -> Value { return value; },
+                              [](float value) -> Value { return value; },
+                              [](long long value) -> Value { return value; } },
+                          value);
+    }
+
+    std::unique_ptr<ResponseWriter> createResponseWriter(std::ostream& os, ResponseFormat format)
+    {
+        switch (format)
+        {
+        case ResponseFormat::xml:
+            return std::make_unique<XmlResponseWriter>(os);
+        case ResponseFormat::json:
+            return std::make_unique<JsonResponseWriter>(os);
+        }
+
+        return {};
+    }
+
+    std::unique_ptr<ResponseWriter> createNodeResponseWriter(Response::Node& node)
+    {
+        return std::make_unique<NodeResponseWriter>(node);
+    }
+} // namespace lms::api::subsonic
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "core/LiteralString.hpp"
+
+#include "ResponseFormat.hpp"
+#include "SubsonicResponse.hpp"
+
+namespace lms::api::subsonic
+{
+    // ResponseWriter: 推送式响应写入器（begin/attribute/end），直接把 JSON 或 XML 写入分块输出缓冲区，无需先构建整棵 Node 树。
+    // ResponseWriter: потоковый писатель ответа (begin/attribute/end), пишет JSON или XML прямо в буфер по частям, без построения всего дерева Node.
+    //
+    // Attributes of a node must be written before its children
+    class ResponseWriter
+    {
+    public:
+        using Key = core::LiteralString;
+
+        virtual ~ResponseWriter();
+        ResponseWriter(const ResponseWriter&) = delete;
+        ResponseWriter& operator=(const ResponseWriter&) = delete;
+
+        virtual void beginNode(Key key) = 0;
+        virtual void endNode() = 0;
+
+        // An array holds either nodes (see beginArrayNode) or values
+        virtual void beginArray(Key key) = 0;
+        virtual void beginArrayNode() = 0; // ended using endNode
+        virtual void endArray() = 0;
+
+        void writeAttribute(Key key, std::string_view value) { writeAttributeValue(key, value); }
+
+        template<typename T, std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+        void writeAttribute(Key key, T value)
+        {
+            if constexpr (std::is_same<bool, T>::value)
+                writeAttributeValue(key, value);
+            else if constexpr (std::is_floating_point<T>::value)
+                writeAttributeValue(key, static_cast<float>(value));
+            else if constexpr (std::is_integral<T>::value)
+                writeAttributeValue(key, static_cast<long long>(value));
+            else
+                static_assert("Unhandled type");
+        }
+
+        void writeArrayValue(std::string_view value) { writeArrayElementValue(value); }
+        void writeArrayValue(long long value) { writeArrayElementValue(value); }
+
+        // Compatibility with the Node based builder
+        void writeNode(Key key, const Response::Node& node);
+        void writeArrayNode(const Response::Node& node);
+        void writeNodeContent(const Response::Node& node); // attributes and children of node, written in the current node
+
+        // Must be called once the whole response has been written
+        virtual void finish() = 0;
+
+    protected:
+        ResponseWriter() = default;
+
+        using Value = std::variant<std::string_view, bool, float, long long>;
+        virtual void writeAttributeValue(Key key, const Value& value) = 0;
+        virtual void writeNodeValue(const Value& value) = 0; // text content of the current node
+        virtual void writeArrayElementValue(const Value& value) = 0;
+
+    private:
+        static Value toValue(const Response::Node::ValueType& value);
+    };
+
+    std::unique_ptr<ResponseWriter> createResponseWriter(std::ostream& os, ResponseFormat format);
+
+    // Builds node from what is written: the current node is node itself
+    // Lets the same code produce either a Node or a streamed output
+    std::unique_ptr<ResponseWriter> createNodeResponseWriter(Response::Node& node);
+} // namespace lms::api::subsonic
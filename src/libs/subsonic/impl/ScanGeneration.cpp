@@ -0,0 +1,19 @@
+#include "ScanGeneration.hpp"
+
+#include "core/Service.hpp"
+#include "services/scanner/IScannerService.hpp"
+
+namespace lms::api::subsonic
+{
+    Wt::WDateTime getScanGeneration()
+    {
+        if (const scanner::IScannerService * scanner{ core::Service<scanner::IScannerService>::get() })
+        {
+            const scanner::IScannerService::Status status{ scanner->getStatus() };
+            if (status.lastCompleteScanStats)
+                return status.lastCompleteScanStats->stopTime;
+        }
+
+        return {};
+    }
+} // namespace lms::api::subsonic
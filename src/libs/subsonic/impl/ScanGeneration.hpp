@@ -0,0 +1,10 @@
+#pragma once
+
+#include <Wt/WDateTime.h>
+
+namespace lms::api::subsonic
+{
+    // Changes each time a scan completes: any completed scan may have changed the media library contents
+    // Invalid if no scan has completed yet
+    Wt::WDateTime getScanGeneration();
+} // namespace lms::api::subsonic
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "core/Random.hpp"
+#include "database/objects/MediaLibraryId.hpp"
+#include "database/objects/UserId.hpp"
+
+namespace lms::api::subsonic
+{
+    // ScanTracker: 记录客户端正在进行的分页遍历，保存上一页最后一个对象的 ID（或键集游标），下一页据此继续（避免 offset 的开销）。
+    // ScanTracker: отслеживает постраничные обходы клиентов, сохраняет ID (или курсор) последнего объекта страницы, чтобы продолжить с него (без затрат на offset).
+    //
+    // Search and list endpoints can be used to scan/sync the database
+    // This class is used to keep track of the current scans, in order to retrieve the last objectId (or keyset cursor)
+    // to speed up the query of the following range (avoid the 'offset' cost)
+    template<typename ObjectId>
+    class ScanTracker
+    {
+    public:
+        struct ScanInfo
+        {
+            std::string clientAddress;
+            std::string clientName;
+            db::UserId user;
+            db::MediaLibraryId library;
+            std::size_t offset{};
+            auto operator<=>(const ScanInfo&) const = default;
+        };
+
+        ObjectId extractLastRetrievedObjectId(const ScanInfo& info);
+        void setObjectId(const ScanInfo& info, ObjectId lastRetrievedId);
+
+    private:
+        using ClockType = std::chrono::steady_clock;
+
+        struct Entry
+        {
+            ClockType::time_point timePoint;
+            ObjectId objectId;
+        };
+
+        static constexpr std::size_t maxScanCount{ 50 };
+        static constexpr ClockType::duration maxEntryDuration{ std::chrono::seconds{ 30 } };
+
+        std::mutex _mutex;
+        std::map<ScanInfo, Entry> _ongoingScans;
+    };
+
+    template<typename ObjectId>
+    ObjectId ScanTracker<ObjectId>::extractLastRetrievedObjectId(const ScanInfo& scanInfo)
+    {
+        ObjectId res;
+
+        {
+            const std::scoped_lock lock{ _mutex };
+
+            auto it{ _ongoingScans.find(scanInfo) };
+            if (it != _ongoingScans.end())
+            {
+                res = it->second.objectId;
+                _ongoingScans.erase(it);
+            }
+        }
+
+        return res;
+    }
+
+    template<typename ObjectId>
+    void ScanTracker<ObjectId>::setObjectId(const ScanInfo& scanInfo, ObjectId lastRetrievedId)
+    {
+        const ClockType::time_point now{ ClockType::now() };
+
+        const std::scoped_lock lock{ _mutex };
+
+        // clean outdated scan entries; we do this to not have to flush everything each time we add/remove entries in the database
+        std::erase_if(_ongoingScans, [&](const auto& entry) { return now > entry.second.timePoint + maxEntryDuration; });
+        // prevent the cache size from going out of control
+        if (_ongoingScans.size() == maxScanCount)
+            _ongoingScans.erase(core::random::pickRandom(_ongoingScans));
+
+        _ongoingScans[scanInfo] = { now, lastRetrievedId };
+    }
+} // namespace lms::api::subsonic
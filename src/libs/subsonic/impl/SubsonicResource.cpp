@@ -2,7 +2,9 @@
 #include "SubsonicResource.hpp"
 
 #include <atomic>
+#include <sstream>
 #include <unordered_map>
+#include <variant>
 
 #include "core/EnumSet.hpp"
 #include "core/IConfig.hpp"
@@ -16,10 +18,13 @@
 #include "database/objects/User.hpp"
 #include "services/auth/IAuthTokenService.hpp"
 #include "services/auth/IPasswordService.hpp"
+#include "services/scanner/IScannerService.hpp"
 
 #include "ParameterParsing.hpp"
 #include "ProtocolVersion.hpp"
 #include "RequestContext.hpp"
+#include "ResponseWriter.hpp"
+#include "ScanGeneration.hpp"
 #include "SubsonicResponse.hpp"
 #include "endpoints/AlbumSongLists.hpp"
 #include "endpoints/Bookmarks.hpp"
@@ -104,9 +109,11 @@ namespace lms::api::subsonic
             Unauthenticated,
         };
         using RequestHandlerFunc = std::function<Response(RequestContext& context)>;
+        // For large responses: content is written on the fly, without building the Node tree
+        using StreamedRequestHandlerFunc = std::function<void(RequestContext& context, ResponseWriter& writer)>;
         struct RequestEntryPointInfo
         {
-            RequestHandlerFunc func;
+            std::variant<RequestHandlerFunc, StreamedRequestHandlerFunc> func;
             AuthenticationMode authMode{ AuthenticationMode::Authenticated };
             core::EnumSet<db::UserType> allowedUserTypes{ db::UserType::DEMO, db::UserType::REGULAR, db::UserType::ADMIN };
         };
@@ -239,6 +246,62 @@ namespace lms::api::subsonic
             TLSMonotonicMemoryResourceCleaner& operator=(const TLSMonotonicMemoryResourceCleaner&) = delete;
         };
 
+        // Read only endpoints whose responses only depend on the media library and on the user data
+        bool isResponseCacheable(std::string_view requestPath, const Wt::Http::ParameterMap& parameters)
+        {
+            if (requestPath == "/getMusicFolders" || requestPath == "/getGenres" || requestPath == "/getArtists")
+                return true;
+
+            // random lists are expected to change on each call
+            if (requestPath == "/getAlbumList" || requestPath == "/getAlbumList2")
+                return getParameterAs<std::string>(parameters, "type") != "random";
+
+            return false;
+        }
+
+        bool isModifyingUserData(std::string_view requestPath)
+        {
+            return requestPath == "/star" || requestPath == "/unstar" || requestPath == "/setRating" || requestPath == "/scrobble";
+        }
+
+        bool matchesETag(std::string_view ifNoneMatch, std::string_view etag)
+        {
+            for (std::string_view candidate : core::stringUtils::splitString(ifNoneMatch, ','))
+            {
+                candidate = core::stringUtils::stringTrim(candidate);
+                if (candidate.starts_with("W/")) // weak comparison
+                    candidate.remove_prefix(2);
+
+                if (candidate == "*" || candidate == etag)
+                    return true;
+            }
+
+            return false;
+        }
+
+        // Replies "304 Not Modified" if the client already has this response
+        void writeCachedResponse(const ResponseCache::Entry& entry, const Wt::Http::Request& request, Wt::Http::Response& response)
+        {
+            response.addHeader("ETag", entry.etag);
+            response.addHeader("Last-Modified", entry.lastModified);
+            response.addHeader("Cache-Control", "private, no-cache");
+
+            bool isNotModified{};
+            if (const std::string ifNoneMatch{ request.headerValue("If-None-Match") }; !ifNoneMatch.empty())
+                isNotModified = matchesETag(ifNoneMatch, entry.etag);
+            else if (const std::string ifModifiedSince{ request.headerValue("If-Modified-Since") }; !ifModifiedSince.empty())
+                isNotModified = ifModifiedSince == entry.lastModified; // clients send back the value they were given
+
+            if (isNotModified)
+            {
+                response.setStatus(304); // Not Modified
+                return;
+            }
+
+            response.setMimeType(entry.mimeType);
+            response.out().write(entry.body.data(), static_cast<std::streamsize>(entry.body.size()));
+        }
+
         db::User::pointer getUserFromUserId(db::Session& session, db::UserId userId)
         {
             auto transaction{ session.createReadTransaction() };
@@ -254,6 +317,28 @@ namespace lms::api::subsonic
         : _config{ readSubsonicResourceConfig(*core::Service<core::IConfig>::get()) }
         , _db{ db }
     {
+        if (_config.responseCacheMaxSize > 0)
+            _responseCache = std::make_unique<ResponseCache>(_config.responseCacheMaxSize, _config.responseCacheMaxEntryAge);
+
+        // Rebuilt by the scanner thread: clients keep getting the previous index in the meantime
+        if (scanner::IScannerService * scanner{ core::Service<scanner::IScannerService>::get() })
+        {
+            _scanCompleteConnection = scanner->getEvents().scanComplete.connect([this](const scanner::ScanStats&) {
+                // cached responses are about to be invalidated by the new scan generation
+                if (_responseCache)
+                {
+                    const ResponseCache::Stats stats{ _responseCache->getStats() };
+                    LMS_LOG(API_SUBSONIC, DEBUG, "Response cache stats: hits = " << stats.hits << ", misses = " << stats.misses << ", evictions = " << stats.evictions << ", invalidations = " << stats.invalidations << ", nb entries = " << stats.entryCount << ", size = " << stats.size << "/" << stats.maxSize);
+                }
+
+                _artistIndex.rebuild(_db.getTLSSession());
+            });
+        }
+    }
+
+    SubsonicResource::~SubsonicResource()
+    {
+        _scanCompleteConnection.disconnect();
     }
 
     void SubsonicResource::handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response)
@@ -305,19 +390,69 @@ namespace lms::api::subsonic
                     checkUserTypeIsAllowed(user, itEntryPoint->second.allowedUserTypes);
                 }
 
-                RequestContext requestContext{ request, _db.getTLSSession(), user, _config };
+                RequestContext requestContext{ request, _db.getTLSSession(), user, _config, _artistIndex };
                 protocolVersion = requestContext.getServerProtocolVersion();
 
-                const Response resp{ [&] {
-                    LMS_SCOPED_TRACE_DETAILED("Subsonic", "HandleRequest");
-                    return itEntryPoint->second.func(requestContext);
-                }() };
+                auto writeEntryPoint = [&](std::ostream& os) {
+                    if (const auto* handler{ std::get_if<RequestHandlerFunc>(&itEntryPoint->second.func) })
+                    {
+                        const Response resp{ [&] {
+                            LMS_SCOPED_TRACE_DETAILED("Subsonic", "HandleRequest");
+                            return (*handler)(requestContext);
+                        }() };
+
+                        LMS_SCOPED_TRACE_DETAILED("Subsonic", "WriteResponse");
+                        resp.write(os, format);
+                    }
+                    else
+                    {
+                        LMS_SCOPED_TRACE_DETAILED("Subsonic", "HandleRequest");
+                        Response::writeOkResponse(os, format, protocolVersion, [&](ResponseWriter& writer) {
+                            std::get<StreamedRequestHandlerFunc>(itEntryPoint->second.func)(requestContext, writer);
+                        });
+                    }
+                };
 
+                if (_responseCache && isResponseCacheable(requestPath, request.getParameterMap()))
                 {
-                    LMS_SCOPED_TRACE_DETAILED("Subsonic", "WriteResponse");
+                    const std::string cacheKey{ ResponseCache::computeKey(requestPath, request.getParameterMap(), user->getId()) };
+
+                    std::shared_ptr<const ResponseCache::Entry> cacheEntry{ _responseCache->getEntry(cacheKey) };
+                    if (!cacheEntry)
+                    {
+                        const Wt::WDateTime scanGeneration{ getScanGeneration() };
+
+                        std::ostringstream oss;
+                        writeEntryPoint(oss);
 
-                    resp.write(response.out(), format);
+                        cacheEntry = _responseCache->addEntry(cacheKey, user->getId(), scanGeneration, std::move(oss).str(), std::string{ ResponseFormatToMimeType(format) });
+                    }
+                    else
+                    {
+                        LMS_LOG(API_SUBSONIC, DEBUG, "Request " << requestId << " '" << requestPath << "' served from cache");
+                    }
+
+                    writeCachedResponse(*cacheEntry, request, response);
+                }
+                else
+                {
+                    if (std::holds_alternative<StreamedRequestHandlerFunc>(itEntryPoint->second.func))
+                    {
+                        // The handler may fail once the response is started: buffer it so that the error response is sent alone
+                        std::ostringstream oss;
+                        writeEntryPoint(oss);
+
+                        const std::string body{ std::move(oss).str() };
+                        response.out().write(body.data(), static_cast<std::streamsize>(body.size()));
+                    }
+                    else
+                    {
+                        writeEntryPoint(response.out());
+                    }
                     response.setMimeType(std::string{ ResponseFormatToMimeType(format) });
+
+                    if (_responseCache && isModifyingUserData(requestPath))
+                        _responseCache->invalidateUserEntries(user->getId());
                 }
 
                 LMS_LOG(API_SUBSONIC, DEBUG, "Request " << requestId << " '" << requestPath << "' handled!");
@@ -351,7 +486,7 @@ namespace lms::api::subsonic
             if (!request.continuation())
                 user = getUserFromUserId(_db.getTLSSession(), authenticateUser(request));
 
-            RequestContext requestContext{ request, _db.getTLSSession(), user, _config };
+            RequestContext requestContext{ request, _db.getTLSSession(), user, _config, _artistIndex };
 
             handler(requestContext, request, response);
         }
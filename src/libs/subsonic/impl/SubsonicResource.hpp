@@ -1,11 +1,16 @@
 #pragma once
 
+#include <memory>
+
 #include <Wt/Http/Request.h>
 #include <Wt/Http/Response.h>
 #include <Wt/WResource.h>
+#include <Wt/WSignal.h>
 
 #include "database/objects/UserId.hpp"
 
+#include "ArtistIndex.hpp"
+#include "ResponseCache.hpp"
 #include "SubsonicResourceConfig.hpp"
 
 namespace lms::db
@@ -21,6 +26,7 @@ namespace lms::api::subsonic
     {
     public:
         SubsonicResource(db::IDb& db);
+        ~SubsonicResource() override;
 
     private:
         void handleRequest(const Wt::Http::Request& request, Wt::Http::Response& response) override;
@@ -32,5 +38,8 @@ namespace lms::api::subsonic
 
         const SubsonicResourceConfig _config;
         db::IDb& _db;
+        std::unique_ptr<ResponseCache> _responseCache; // may be null
+        ArtistIndex _artistIndex;
+        Wt::Signals::connection _scanCompleteConnection;
     };
 } // namespace lms::api::subsonic
@@ -39,7 +39,9 @@ namespace lms::api::subsonic
         return SubsonicResourceConfig{
             .serverProtocolVersionsByClient = readConfigProtocolVersions(config),
             .openSubsonicDisabledClients = readOpenSubsonicDisabledClients(config),
-            .supportUserPasswordAuthentication = config.getBool("api-subsonic-support-user-password-auth", true)
+            .supportUserPasswordAuthentication = config.getBool("api-subsonic-support-user-password-auth", true),
+            .responseCacheMaxSize = config.getULong("api-subsonic-response-cache-max-size", 16) * 1000 * 1000,
+            .responseCacheMaxEntryAge = std::chrono::seconds{ config.getULong("api-subsonic-response-cache-max-age-seconds", 300) },
         };
     }
 } // namespace lms::api::subsonic
\ No newline at end of file
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -19,6 +20,8 @@ namespace lms::api::subsonic
         std::unordered_map<std::string, ProtocolVersion> serverProtocolVersionsByClient;
         std::unordered_set<std::string> openSubsonicDisabledClients;
         bool supportUserPasswordAuthentication;
+        std::size_t responseCacheMaxSize; // 0 to disable the response cache
+        std::chrono::seconds responseCacheMaxEntryAge;
     };
 
     SubsonicResourceConfig readSubsonicResourceConfig(core::IConfig& _config);
@@ -1,15 +1,13 @@
 
 #include "SubsonicResponse.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <climits>
-#include <cmath>
 
-#include "core/String.hpp"
-#include "core/Utils.hpp"
 #include "core/Version.hpp"
 
 #include "ProtocolVersion.hpp"
+#include "ResponseWriter.hpp"
 
 namespace lms::api::subsonic
 {
@@ -94,196 +92,6 @@ namespace lms::api::subsonic
         setAttribute("version", std::to_string(protocolVersion.major) + "." + std::to_string(protocolVersion.minor) + "." + std::to_string(protocolVersion.patch));
     }
 
-    void Response::XmlSerializer::serializeNode(std::ostream& os, const Node& node, std::string_view tagName)
-    {
-        // Opening tag
-        os << '<' << tagName;
-
-        // Attributes
-        for (const auto& [key, value] : node._attributes)
-        {
-            os << ' ' << key.str() << '=';
-            os << '"';
-            serializeValue(os, value);
-            os << '"';
-        }
-
-        // Hack
-        if (tagName == "subsonic-response")
-            os << " xmlns=\"http://subsonic.org/restapi\"";
-
-        bool hasChildren = !node._children.empty() || !node._childrenArrays.empty() || !node._childrenValues.empty();
-        bool hasValue = node._value.has_value();
-
-        if (!hasChildren && !hasValue)
-        {
-            os << "/>"; // Self-closing tag
-            return;
-        }
-
-        os << '>'; // End opening tag
-
-        // Node value (text content)
-        if (hasValue)
-            serializeValue(os, *node._value);
-
-        // Child nodes
-        for (const auto& [key, childNode] : node._children)
-            serializeNode(os, childNode, key.str());
-
-        // Child arrays
-        for (const auto& [key, childArrayNodes] : node._childrenArrays)
-            for (const Node& childNode : childArrayNodes)
-                serializeNode(os, childNode, key.str());
-
-        // Array values
-        for (const auto& [key, childValues] : node._childrenValues)
-        {
-            for (const Node::ValueType& value : childValues)
-            {
-                os << '<' << key.str() << '>';
-                serializeValue(os, value);
-                os << "</" << key.str() << '>';
-            }
-        }
-
-        // Closing tag
-        os << "</" << tagName << '>';
-    }
-
-    void Response::XmlSerializer::serializeValue(std::ostream& os, const Node::ValueType& value)
-    {
-        std::visit(core::utils::overloads{
-                       [&](const Node::string& str) { core::stringUtils::writeXmlEscapedString(os, str); },
-                       [&](bool value) { os << (value ? "true" : "false"); },
-                       [&](float value) { os << value; },
-                       [&](long long value) { os << value; } },
-                   value);
-    }
-
-    void Response::XmlSerializer::serializeEscapedString(std::ostream& os, std::string_view str)
-    {
-        core::stringUtils::writeXmlEscapedString(os, str);
-    }
-
-    void Response::writeXML(std::ostream& os) const
-    {
-        os << R"(<?xml version="1.0" encoding="utf-8"?>)" << '\n';
-
-        XmlSerializer serializer;
-
-        assert(_root._children.size() == 1);
-        if (_root._children.size() == 1)
-        {
-            const auto& [tagName, node] = *_root._children.begin();
-            serializer.serializeNode(os, node, tagName.str());
-        }
-    }
-
-    void Response::JsonSerializer::serializeNode(std::ostream& os, const Response::Node& node)
-    {
-        os << '{';
-
-        bool first{ true };
-
-        for (const auto& [key, value] : node._attributes)
-        {
-            if (!first)
-                os << ',';
-
-            serializeEscapedString(os, key.str());
-            os << ':';
-            serializeValue(os, value);
-
-            first = false;
-        }
-
-        // Values are handled manually (using attributes) in json format
-        assert(!node._value);
-
-        for (const auto& [key, childNode] : node._children)
-        {
-            if (!first)
-                os << ',';
-
-            serializeEscapedString(os, key.str());
-            os << ':';
-            serializeNode(os, childNode);
-
-            first = false;
-        }
-
-        for (const auto& [key, childArrayNodes] : node._childrenArrays)
-        {
-            if (!first)
-                os << ',';
-
-            serializeEscapedString(os, key.str());
-            os << ":[";
-
-            bool firstChild{ true };
-            for (const Response::Node& childNode : childArrayNodes)
-            {
-                if (!firstChild)
-                    os << ",";
-
-                serializeNode(os, childNode);
-                firstChild = false;
-            }
-            os << ']';
-
-            first = false;
-        }
-
-        for (const auto& [key, childValues] : node._childrenValues)
-        {
-            if (!first)
-                os << ',';
-
-            serializeEscapedString(os, key.str());
-            os << ":[";
-
-            bool firstChild{ true };
-            for (const Node::ValueType& childValue : childValues)
-            {
-                if (!firstChild)
-                    os << ",";
-
-                serializeValue(os, childValue);
-
-                firstChild = false;
-            }
-            os << ']';
-
-            first = false;
-        }
-
-        os << '}';
-    }
-
-    void Response::JsonSerializer::serializeValue(std::ostream& os, const Node::ValueType& value)
-    {
-        std::visit(
-            core::utils::overloads{
-                [&](const Node::string& str) { serializeEscapedString(os, str); },
-                [&](bool value) { os << (value ? "true" : "false"); },
-                [&](float value) {
-                    if (std::isnan(value) || std::fabs(value) == std::numeric_limits<float>::infinity())
-                        os << "null";
-                    else
-                        os << value;
-                },
-                [&](long long value) { os << value; } },
-            value);
-    }
-
-    void Response::JsonSerializer::serializeEscapedString(std::ostream& os, std::string_view str)
-    {
-        os << '\"';
-        core::stringUtils::writeJsonEscapedString(os, str);
-        os << '\"';
-    }
-
     Response Response::createOkResponse(ProtocolVersion protocolVersion)
     {
         return createResponseCommon(protocolVersion);
@@ -335,20 +143,29 @@ namespace lms::api::subsonic
 
     void Response::write(std::ostream& os, ResponseFormat format) const
     {
-        switch (format)
-        {
-        case ResponseFormat::xml:
-            writeXML(os);
-            break;
-        case ResponseFormat::json:
-            writeJSON(os);
-            break;
-        }
+        const std::unique_ptr<ResponseWriter> writer{ createResponseWriter(os, format) };
+
+        assert(_root._children.size() == 1);
+        for (const auto& [key, node] : _root._children)
+            writer->writeNode(key, node);
+
+        writer->finish();
     }
 
-    void Response::writeJSON(std::ostream& os) const
+    void Response::writeOkResponse(std::ostream& os, ResponseFormat format, ProtocolVersion protocolVersion, const std::function<void(ResponseWriter&)>& writeContent)
     {
-        JsonSerializer serializer;
-        serializer.serializeNode(os, _root);
+        const Response response{ createOkResponse(protocolVersion) };
+        const std::unique_ptr<ResponseWriter> writer{ createResponseWriter(os, format) };
+
+        assert(response._root._children.size() == 1);
+        for (const auto& [key, node] : response._root._children)
+        {
+            writer->beginNode(key);
+            writer->writeNodeContent(node);
+            writeContent(*writer);
+            writer->endNode();
+        }
+
+        writer->finish();
     }
 } // namespace lms::api::subsonic
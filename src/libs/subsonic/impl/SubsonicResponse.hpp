@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <optional>
 #include <string>
@@ -15,6 +16,8 @@
 
 namespace lms::api::subsonic
 {
+    class ResponseWriter;
+
     // Max count expected from all API methods that expose a count
     static inline constexpr std::size_t defaultMaxCountSize{ 1'000 };
 
@@ -264,6 +267,7 @@ namespace lms::api::subsonic
             void setVersionAttribute(ProtocolVersion version);
 
             friend class Response;
+            friend class ResponseWriter;
 
             template<typename Key, typename Value>
             using map = std::map<Key, Value, std::less<Key>, ResponseAllocator<std::pair<const Key, Value>>>;
@@ -298,28 +302,12 @@ namespace lms::api::subsonic
 
         void write(std::ostream& os, ResponseFormat format) const;
 
+        // Alternative to the Node tree for large responses: the content of the response is directly written by writeContent
+        static void writeOkResponse(std::ostream& os, ResponseFormat format, ProtocolVersion protocolVersion, const std::function<void(ResponseWriter&)>& writeContent);
+
     private:
         static Response createResponseCommon(ProtocolVersion protocolVersion, const Error* error = nullptr);
 
-        class JsonSerializer
-        {
-        public:
-            void serializeNode(std::ostream& os, const Node& node);
-            static void serializeValue(std::ostream& os, const Node::ValueType& value);
-            static void serializeEscapedString(std::ostream&, std::string_view str);
-        };
-
-        class XmlSerializer
-        {
-        public:
-            void serializeNode(std::ostream& os, const Node& node, std::string_view tagName);
-            static void serializeValue(std::ostream& os, const Node::ValueType& value);
-            static void serializeEscapedString(std::ostream&, std::string_view str);
-        };
-
-        void writeJSON(std::ostream& os) const;
-        void writeXML(std::ostream& os) const;
-
         Response() = default;
         Node _root;
     };
@@ -15,6 +15,8 @@
 #include "services/scrobbling/IScrobblingService.hpp"
 
 #include "ParameterParsing.hpp"
+#include "ResponseWriter.hpp"
+#include "ScanTracker.hpp"
 #include "SubsonicId.hpp"
 #include "responses/Album.hpp"
 #include "responses/Artist.hpp"
@@ -48,12 +50,37 @@ namespace lms::api::subsonic
 
             if (type == "alphabeticalByName")
             {
+                static ScanTracker<KeysetCursor<ReleaseId>> currentScansInProgress;
+
+                ScanTracker<KeysetCursor<ReleaseId>>::ScanInfo scanInfo{
+                    .clientAddress = context.getClientIpAddr(),
+                    .clientName = std::string{ context.getClientName() },
+                    .user = context.getUser()->getId(),
+                    .library = mediaLibraryId,
+                    .offset = offset
+                };
+
                 Release::FindParameters params;
                 params.setSortMethod(ReleaseSortMethod::Name);
-                params.setRange(range);
                 params.filters.setMediaLibrary(mediaLibraryId);
 
+                // Clients walking the whole list: resume right after the last release of the previous page
+                if (const KeysetCursor<ReleaseId> cachedCursor{ currentScansInProgress.extractLastRetrievedObjectId(scanInfo) }; cachedCursor.id.isValid())
+                    params.setAfter(cachedCursor).setRange(Range{ 0, size });
+                else
+                    params.setRange(range);
+
                 releases = Release::findIds(context.getDbSession(), params);
+
+                // the cursor holds the name too: the last release may be removed before the next page is requested
+                if (!releases.results.empty())
+                {
+                    if (const Release::pointer lastRelease{ Release::find(context.getDbSession(), releases.results.back()) })
+                    {
+                        scanInfo.offset = offset + size;
+                        currentScansInProgress.setObjectId(scanInfo, KeysetCursor<ReleaseId>{ .sortKey = std::string{ lastRelease->getName() }, .id = lastRelease->getId() });
+                    }
+                }
             }
             else if (type == "alphabeticalByArtist")
             {
@@ -160,15 +187,15 @@ namespace lms::api::subsonic
             return response;
         }
 
-        Response handleGetStarredRequestCommon(RequestContext& context, bool id3)
+        void handleGetStarredRequestCommon(RequestContext& context, ResponseWriter& writer, bool id3)
         {
             // Optional parameters
             const MediaLibraryId mediaLibrary{ getParameterAs<MediaLibraryId>(context.getParameters(), "musicFolderId").value_or(MediaLibraryId{}) };
 
             auto transaction{ context.getDbSession().createReadTransaction() };
 
-            Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
-            Response::Node& starredNode{ response.createNode(id3 ? Response::Node::Key{ "starred2" } : Response::Node::Key{ "starred" }) };
+            // artists and albums are few, only the songs are streamed
+            Response::Node starredNode;
 
             feedback::IFeedbackService& feedbackService{ *core::Service<feedback::IFeedbackService>::get() };
 
@@ -195,13 +222,19 @@ namespace lms::api::subsonic
                     starredNode.addArrayChild("album", createAlbumNode(context, release, id3));
             }
 
+            std::vector<Track::pointer> tracks;
             for (const TrackId trackId : feedbackService.findStarredTracks(findParameters).results)
             {
                 if (auto track{ Track::find(context.getDbSession(), trackId) })
-                    starredNode.addArrayChild("song", createSongNode(context, track, context.getUser()));
+                    tracks.push_back(std::move(track));
             }
 
-            return response;
+            const SongBatch songBatch{ context.getDbSession(), tracks };
+
+            writer.beginNode(id3 ? ResponseWriter::Key{ "starred2" } : ResponseWriter::Key{ "starred" });
+            writer.writeNodeContent(starredNode);
+            writeSongArray(writer, context, tracks, context.getUser(), songBatch);
+            writer.endNode();
         }
     } // namespace
 
@@ -215,7 +248,7 @@ namespace lms::api::subsonic
         return handleGetAlbumListRequestCommon(context, true /* id3 */);
     }
 
-    Response handleGetRandomSongsRequest(RequestContext& context)
+    void handleGetRandomSongsRequest(RequestContext& context, ResponseWriter& writer)
     {
         // Optional params
         const MediaLibraryId mediaLibraryId{ getParameterAs<MediaLibraryId>(context.getParameters(), "musicFolderId").value_or(MediaLibraryId{}) };
@@ -223,9 +256,6 @@ namespace lms::api::subsonic
         if (size > defaultMaxCountSize)
             throw ParameterValueTooHighGenericError{ "size", defaultMaxCountSize };
 
-        Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
-        Response::Node& randomSongsNode{ response.createNode("randomSongs") };
-
         auto transaction{ context.getDbSession().createReadTransaction() };
 
         Track::FindParameters params;
@@ -233,14 +263,15 @@ namespace lms::api::subsonic
         params.setRange(Range{ 0, size });
         params.filters.setMediaLibrary(mediaLibraryId);
 
-        Track::find(context.getDbSession(), params, [&](const Track::pointer& track) {
-            randomSongsNode.addArrayChild("song", createSongNode(context, track, context.getUser()));
-        });
+        const auto tracks{ Track::find(context.getDbSession(), params) };
+        const SongBatch songBatch{ context.getDbSession(), tracks.results };
 
-        return response;
+        writer.beginNode("randomSongs");
+        writeSongArray(writer, context, tracks.results, context.getUser(), songBatch);
+        writer.endNode();
     }
 
-    Response handleGetSongsByGenreRequest(RequestContext& context)
+    void handleGetSongsByGenreRequest(RequestContext& context, ResponseWriter& writer)
     {
         // Mandatory params
         std::string genre{ getMandatoryParameterAs<std::string>(context.getParameters(), "genre") };
@@ -263,29 +294,27 @@ namespace lms::api::subsonic
         if (!cluster)
             throw RequestedDataNotFoundError{};
 
-        Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
-        Response::Node& songsByGenreNode{ response.createNode("songsByGenre") };
-
         Track::FindParameters params;
         params.filters.setClusters(std::initializer_list<ClusterId>{ cluster->getId() });
         params.filters.setMediaLibrary(mediaLibrary);
         params.setRange(Range{ offset, count });
 
-        Track::find(context.getDbSession(), params, [&](const Track::pointer& track) {
-            songsByGenreNode.addArrayChild("song", createSongNode(context, track, context.getUser()));
-        });
+        const auto tracks{ Track::find(context.getDbSession(), params) };
+        const SongBatch songBatch{ context.getDbSession(), tracks.results };
 
-        return response;
+        writer.beginNode("songsByGenre");
+        writeSongArray(writer, context, tracks.results, context.getUser(), songBatch);
+        writer.endNode();
     }
 
-    Response handleGetStarredRequest(RequestContext& context)
+    void handleGetStarredRequest(RequestContext& context, ResponseWriter& writer)
     {
-        return handleGetStarredRequestCommon(context, false /* no id3 */);
+        handleGetStarredRequestCommon(context, writer, false /* no id3 */);
     }
 
-    Response handleGetStarred2Request(RequestContext& context)
+    void handleGetStarred2Request(RequestContext& context, ResponseWriter& writer)
     {
-        return handleGetStarredRequestCommon(context, true /* id3 */);
+        handleGetStarredRequestCommon(context, writer, true /* id3 */);
     }
 
 } // namespace lms::api::subsonic
\ No newline at end of file
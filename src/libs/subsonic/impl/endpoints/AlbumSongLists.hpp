@@ -8,8 +8,8 @@ namespace lms::api::subsonic
 {
     Response handleGetAlbumListRequest(RequestContext& context);
     Response handleGetAlbumList2Request(RequestContext& context);
-    Response handleGetRandomSongsRequest(RequestContext& context);
-    Response handleGetSongsByGenreRequest(RequestContext& context);
-    Response handleGetStarredRequest(RequestContext& context);
-    Response handleGetStarred2Request(RequestContext& context);
+    void handleGetRandomSongsRequest(RequestContext& context, ResponseWriter& writer);
+    void handleGetSongsByGenreRequest(RequestContext& context, ResponseWriter& writer);
+    void handleGetStarredRequest(RequestContext& context, ResponseWriter& writer);
+    void handleGetStarred2Request(RequestContext& context, ResponseWriter& writer);
 } // namespace lms::api::subsonic
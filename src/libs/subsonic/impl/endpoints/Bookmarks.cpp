@@ -101,9 +101,14 @@ namespace lms::api::subsonic
             playQueueNode.setAttribute("changed", core::stringUtils::toISO8601String(playQueue->getLastModifiedDateTime()));
             playQueueNode.setAttribute("changedBy", "unknown"); // we don't store the client name (could be several same clients on several devices...)
 
+            std::vector<db::Track::pointer> tracks;
             playQueue->visitTracks([&](const db::Track::pointer& track) {
-                playQueueNode.addArrayChild("entry", createSongNode(context, track, true /* id3 */));
+                tracks.push_back(track);
             });
+
+            const SongBatch songBatch{ context.getDbSession(), tracks };
+            for (const db::Track::pointer& track : tracks)
+                playQueueNode.addArrayChild("entry", createSongNode(context, track, true /* id3 */, songBatch));
         }
 
         return response;
@@ -1,9 +1,12 @@
 
 #include "Browsing.hpp"
 
+#include <unordered_map>
+
 #include "core/ILogger.hpp"
 #include "core/Random.hpp"
 #include "core/Service.hpp"
+#include "core/String.hpp"
 #include "database/Session.hpp"
 #include "database/objects/Artist.hpp"
 #include "database/objects/ArtistInfo.hpp"
@@ -17,6 +20,8 @@
 #include "services/recommendation/IRecommendationService.hpp"
 #include "services/scrobbling/IScrobblingService.hpp"
 
+#include "ArtistIndex.hpp"
+#include "CoverArtId.hpp"
 #include "ParameterParsing.hpp"
 #include "SubsonicId.hpp"
 #include "responses/Album.hpp"
@@ -177,12 +182,19 @@ namespace lms::api::subsonic
 
             Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
             Response::Node& similarSongsNode{ response.createNode(id3 ? Response::Node::Key{ "similarSongs2" } : Response::Node::Key{ "similarSongs" }) };
+
+            std::vector<Track::pointer> similarTracks;
+            similarTracks.reserve(tracks.size());
             for (const TrackId trackId : tracks)
             {
-                const Track::pointer track{ Track::find(context.getDbSession(), trackId) };
-                similarSongsNode.addArrayChild("song", createSongNode(context, track, context.getUser()));
+                if (Track::pointer track{ Track::find(context.getDbSession(), trackId) })
+                    similarTracks.push_back(std::move(track));
             }
 
+            const SongBatch songBatch{ context.getDbSession(), similarTracks };
+            for (const Track::pointer& track : similarTracks)
+                similarSongsNode.addArrayChild("song", createSongNode(context, track, context.getUser(), songBatch));
+
             return response;
         }
 
@@ -239,9 +251,10 @@ namespace lms::api::subsonic
             Track::FindParameters params;
             params.setDirectory(rootdirectory->getId());
 
-            Track::find(context.getDbSession(), params, [&](const Track::pointer& track) {
-                indexesNode.addArrayChild("child", createSongNode(context, track, context.getUser()));
-            });
+            const auto tracks{ Track::find(context.getDbSession(), params) };
+            const SongBatch songBatch{ context.getDbSession(), tracks.results };
+            for (const Track::pointer& track : tracks.results)
+                indexesNode.addArrayChild("child", createSongNode(context, track, context.getUser(), songBatch));
 
             getIndexedChildDirectories(context, rootdirectory, indexedDirectories);
         }
@@ -325,9 +338,10 @@ namespace lms::api::subsonic
             params.setDirectory(directory->getId());
             params.setSortMethod(TrackSortMethod::AbsoluteFilePath);
 
-            Track::find(context.getDbSession(), params, [&](const Track::pointer& track) {
-                directoryNode.addArrayChild("child", createSongNode(context, track, context.getUser()));
-            });
+            const auto tracks{ Track::find(context.getDbSession(), params) };
+            const SongBatch songBatch{ context.getDbSession(), tracks.results };
+            for (const Track::pointer& track : tracks.results)
+                directoryNode.addArrayChild("child", createSongNode(context, track, context.getUser(), songBatch));
         }
 
         return response;
@@ -364,69 +378,34 @@ namespace lms::api::subsonic
         artistsNode.setAttribute("ignoredArticles", "");
         artistsNode.setAttribute("lastModified", reportedDummyDateULong); // TODO report last file write?
 
-        Artist::FindParameters parameters;
+        SubsonicArtistListMode artistListMode;
         {
             auto transaction{ context.getDbSession().createReadTransaction() };
-
-            parameters.setSortMethod(ArtistSortMethod::SortName);
-            switch (context.getUser()->getSubsonicArtistListMode())
-            {
-            case SubsonicArtistListMode::AllArtists:
-                break;
-            case SubsonicArtistListMode::ReleaseArtists:
-                parameters.setLinkType(TrackArtistLinkType::ReleaseArtist);
-                break;
-            case SubsonicArtistListMode::TrackArtists:
-                parameters.setLinkType(TrackArtistLinkType::Artist);
-                break;
-            }
+            artistListMode = context.getUser()->getSubsonicArtistListMode();
         }
-        parameters.filters.setMediaLibrary(mediaLibrary);
 
-        // This endpoint does not scale: make sort lived transactions in order not to block the whole application
-
-        // first pass: dispatch the artists by first letter
-        LMS_LOG(API_SUBSONIC, DEBUG, "GetArtists: fetching all artists...");
-        std::map<char, std::vector<ArtistId>> artistsSortedByFirstChar;
-        std::size_t currentArtistOffset{ 0 };
-        constexpr std::size_t batchSize{ 100 };
-        bool hasMoreArtists{ true };
-        while (hasMoreArtists)
-        {
-            auto transaction{ context.getDbSession().createReadTransaction() };
-
-            parameters.setRange(Range{ currentArtistOffset, batchSize });
-            const auto artists{ Artist::find(context.getDbSession(), parameters) };
-            for (const Artist::pointer& artist : artists.results)
-            {
-                std::string_view sortName{ artist->getSortName() };
-
-                char sortChar;
-                if (sortName.empty() || !std::isalpha(sortName[0]))
-                    sortChar = '#';
-                else
-                    sortChar = std::toupper(sortName[0]);
-
-                artistsSortedByFirstChar[sortChar].push_back(artist->getId());
-            }
-
-            hasMoreArtists = artists.moreResults;
-            currentArtistOffset += artists.results.size();
-        }
+        // User feedback is not part of the index: fetched at once for all the artists
+        feedback::IFeedbackService& feedbackService{ *core::Service<feedback::IFeedbackService>::get() };
+        std::unordered_map<ArtistId, Wt::WDateTime> starredDateTimes;
+        feedbackService.getStarredArtistDateTimes(context.getUser()->getId(), [&](ArtistId artistId, const Wt::WDateTime& dateTime) {
+            starredDateTimes.emplace(artistId, dateTime);
+        });
+        std::unordered_map<ArtistId, Rating> ratings;
+        feedbackService.getArtistRatings(context.getUser()->getId(), [&](ArtistId artistId, Rating rating) {
+            ratings.emplace(artistId, rating);
+        });
 
-        // second pass: add each artist
-        LMS_LOG(API_SUBSONIC, DEBUG, "GetArtists: constructing response...");
-        for (const auto& [sortChar, artistIds] : artistsSortedByFirstChar)
+        const std::shared_ptr<const ArtistIndex::Buckets> buckets{ context.getArtistIndex().getBuckets(context.getDbSession(), mediaLibrary, artistListMode) };
+        for (const ArtistIndex::Bucket& bucket : *buckets)
         {
             Response::Node& indexNode{ artistsNode.createArrayChild("index") };
-            indexNode.setAttribute("name", std::string{ sortChar });
+            indexNode.setAttribute("name", std::string{ bucket.name });
 
-            for (const ArtistId artistId : artistIds)
+            for (const ArtistIndex::Artist& artist : bucket.artists)
             {
-                auto transaction{ context.getDbSession().createReadTransaction() };
-
-                if (const Artist::pointer artist{ Artist::find(context.getDbSession(), artistId) })
-                    indexNode.addArrayChild("artist", createArtistNode(context, artist));
+                const auto itStarred{ starredDateTimes.find(artist.id) };
+                const auto itRating{ ratings.find(artist.id) };
+                indexNode.addArrayChild("artist", createArtistNode(context, artist, itStarred != std::cend(starredDateTimes) ? itStarred->second : Wt::WDateTime{}, itRating != std::cend(ratings) ? std::optional<Rating>{ itRating->second } : std::nullopt));
             }
         }
 
@@ -471,8 +450,9 @@ namespace lms::api::subsonic
         Response::Node albumNode{ createAlbumNode(context, release, true /* id3 */) };
 
         const auto tracks{ Track::find(context.getDbSession(), Track::FindParameters{}.setRelease(id).setSortMethod(TrackSortMethod::Release)) };
+        const SongBatch songBatch{ context.getDbSession(), tracks.results };
         for (const Track::pointer& track : tracks.results)
-            albumNode.addArrayChild("song", createSongNode(context, track, true /* id3 */));
+            albumNode.addArrayChild("song", createSongNode(context, track, true /* id3 */, songBatch));
 
         response.addNode("album", std::move(albumNode));
 
@@ -622,11 +602,18 @@ namespace lms::api::subsonic
             params.setArtist(artists.front()->getId());
 
             const auto trackIds{ core::Service<scrobbling::IScrobblingService>::get()->getTopTracks(params) };
+
+            std::vector<Track::pointer> tracks;
+            tracks.reserve(trackIds.results.size());
             for (const TrackId trackId : trackIds.results)
             {
                 if (Track::pointer track{ Track::find(context.getDbSession(), trackId) })
-                    topSongs.addArrayChild("song", createSongNode(context, track, context.getUser()));
+                    tracks.push_back(std::move(track));
             }
+
+            const SongBatch songBatch{ context.getDbSession(), tracks };
+            for (const Track::pointer& track : tracks)
+                topSongs.addArrayChild("song", createSongNode(context, track, context.getUser(), songBatch));
         }
 
         return response;
@@ -31,6 +31,20 @@ namespace lms::api::subsonic
                 throw RequestedDataNotFoundError{};
             }
         }
+
+        void addPlaylistEntries(RequestContext& context, const db::TrackList::pointer& trackList, Response::Node& playlistNode)
+        {
+            const auto entries{ trackList->getEntries() };
+
+            std::vector<Track::pointer> tracks;
+            tracks.reserve(entries.results.size());
+            for (const TrackListEntry::pointer& entry : entries.results)
+                tracks.push_back(entry->getTrack());
+
+            const SongBatch songBatch{ context.getDbSession(), tracks };
+            for (const Track::pointer& track : tracks)
+                playlistNode.addArrayChild("entry", createSongNode(context, track, context.getUser(), songBatch));
+        }
     } // namespace
 
     Response handleGetPlaylistsRequest(RequestContext& context)
@@ -88,9 +102,7 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
         Response::Node playlistNode{ createPlaylistNode(context, trackList) };
 
-        auto entries{ trackList->getEntries() };
-        for (const TrackListEntry::pointer& entry : entries.results)
-            playlistNode.addArrayChild("entry", createSongNode(context, entry->getTrack(), context.getUser()));
+        addPlaylistEntries(context, trackList, playlistNode);
 
         response.addNode("playlist", std::move(playlistNode));
 
@@ -141,9 +153,7 @@ namespace lms::api::subsonic
         Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
         Response::Node playlistNode{ createPlaylistNode(context, trackList) };
 
-        auto entries{ trackList->getEntries() };
-        for (const TrackListEntry::pointer& entry : entries.results)
-            playlistNode.addArrayChild("entry", createSongNode(context, entry->getTrack(), context.getUser()));
+        addPlaylistEntries(context, trackList, playlistNode);
 
         response.addNode("playlist", std::move(playlistNode));
 
@@ -1,11 +1,6 @@
 
 #include "Searching.hpp"
 
-#include <chrono>
-#include <map>
-#include <mutex>
-
-#include "core/Random.hpp"
 #include "database/Session.hpp"
 #include "database/objects/Artist.hpp"
 #include "database/objects/Directory.hpp"
@@ -14,6 +9,8 @@
 #include "database/objects/User.hpp"
 
 #include "ParameterParsing.hpp"
+#include "ResponseWriter.hpp"
+#include "ScanTracker.hpp"
 #include "SubsonicId.hpp"
 #include "responses/Album.hpp"
 #include "responses/Artist.hpp"
@@ -25,77 +22,6 @@ namespace lms::api::subsonic
 
     namespace
     {
-        // Search endpoints can be used to scan/sync the database
-        // This class is used to keep track of the current scans, in order to retrieve the last objectId
-        // to speed up the query of the following range (avoid the 'offset' cost)
-        template<typename ObjectId>
-        class ScanTracker
-        {
-        public:
-            struct ScanInfo
-            {
-                std::string clientAddress;
-                std::string clientName;
-                UserId user;
-                MediaLibraryId library;
-                std::size_t offset{};
-                auto operator<=>(const ScanInfo&) const = default;
-            };
-
-            ObjectId extractLastRetrievedObjectId(const ScanInfo& info);
-            void setObjectId(const ScanInfo& info, ObjectId lastRetrievedId);
-
-        private:
-            using ClockType = std::chrono::steady_clock;
-
-            struct Entry
-            {
-                ClockType::time_point timePoint;
-                ObjectId objectId;
-            };
-
-            static constexpr std::size_t maxScanCount{ 50 };
-            static constexpr ClockType::duration maxEntryDuration{ std::chrono::seconds{ 30 } };
-
-            std::mutex _mutex;
-            std::map<ScanInfo, Entry> _ongoingScans;
-        };
-
-        template<typename ObjectId>
-        ObjectId ScanTracker<ObjectId>::extractLastRetrievedObjectId(const ScanInfo& scanInfo)
-        {
-            ObjectId res;
-
-            {
-                const std::scoped_lock lock{ _mutex };
-
-                auto it{ _ongoingScans.find(scanInfo) };
-                if (it != _ongoingScans.end())
-                {
-                    res = it->second.objectId;
-                    _ongoingScans.erase(it);
-                }
-            }
-
-            return res;
-        }
-
-        template<typename ObjectId>
-        void ScanTracker<ObjectId>::setObjectId(const ScanInfo& scanInfo, ObjectId lastRetrievedId)
-        {
-            const ClockType::time_point now{ ClockType::now() };
-
-            const std::scoped_lock lock{ _mutex };
-
-            // clean outdated scan entries; we do this to not have to flush everything each time we add/remove entries in the database
-            std::erase_if(_ongoingScans, [&](const auto& entry) { return now > entry.second.timePoint + maxEntryDuration; });
-            // prevent the cache size from going out of control
-            if (_ongoingScans.size() == maxScanCount)
-                _ongoingScans.erase(core::random::pickRandom(_ongoingScans));
-
-            _ongoingScans[scanInfo] = { now, lastRetrievedId };
-        }
-
         void findRequestedArtistDirectories(RequestContext& context, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, Response::Node& searchResultNode)
         {
             // For now, no need to optimize all this
@@ -144,7 +70,8 @@ namespace lms::api::subsonic
                 params.filters.setMediaLibrary(mediaLibrary);
                 params.setKeywords(keywords);
                 params.setRange(Range{ artistOffset, artistCount });
-                params.setSortMethod(ArtistSortMethod::Id); // must be consistent with both methods
+                // when scanning the whole database, sorting by id must be consistent with both methods
+                params.setSortMethod(keywords.empty() ? ArtistSortMethod::Id : ArtistSortMethod::Relevance);
 
                 Artist::find(context.getDbSession(), params, [&](const Artist::pointer& artist) {
                     searchResultNode.addArrayChild("artist", createArtistNode(context, artist));
@@ -208,7 +135,8 @@ namespace lms::api::subsonic
                 params.setKeywords(keywords);
                 params.setRange(Range{ albumOffset, albumCount });
                 params.filters.setMediaLibrary(mediaLibrary);
-                params.setSortMethod(ReleaseSortMethod::Id); // must be consistent with both methods
+                // when scanning the whole database, sorting by id must be consistent with both methods
+                params.setSortMethod(keywords.empty() ? ReleaseSortMethod::Id : ReleaseSortMethod::Relevance);
 
                 Release::find(context.getDbSession(), params, [&](const Release::pointer& release) {
                     searchResultNode.addArrayChild("album", createAlbumNode(context, release, id3));
@@ -252,13 +180,13 @@ namespace lms::api::subsonic
             }
         }
 
-        void findRequestedTracks(RequestContext& context, bool id3, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary, Response::Node& searchResultNode)
+        std::vector<Track::pointer> findRequestedTracks(RequestContext& context, const std::vector<std::string_view>& keywords, MediaLibraryId mediaLibrary)
         {
             static ScanTracker<TrackId> currentScansInProgress;
 
             const std::size_t songCount{ getParameterAs<std::size_t>(context.getParameters(), "songCount").value_or(20) };
             if (songCount == 0)
-                return;
+                return {};
 
             if (songCount > defaultMaxCountSize)
                 throw ParameterValueTooHighGenericError{ "songCount", defaultMaxCountSize };
@@ -266,16 +194,18 @@ namespace lms::api::subsonic
             const std::size_t songOffset{ getParameterAs<std::size_t>(context.getParameters(), "songOffset").value_or(0) };
 
             TrackId lastRetrievedId;
+            std::vector<Track::pointer> tracks;
 
             auto findTracks{ [&] {
                 Track::FindParameters params;
                 params.setKeywords(keywords);
                 params.setRange(Range{ songOffset, songCount });
                 params.filters.setMediaLibrary(mediaLibrary);
-                params.setSortMethod(TrackSortMethod::Id); // must be consistent with both methods
+                // when scanning the whole database, sorting by id must be consistent with both methods
+                params.setSortMethod(keywords.empty() ? TrackSortMethod::Id : TrackSortMethod::Relevance);
 
                 Track::find(context.getDbSession(), params, [&](const Track::pointer& track) {
-                    searchResultNode.addArrayChild("song", createSongNode(context, track, id3));
+                    tracks.push_back(track);
                     lastRetrievedId = track->getId();
                 });
             } };
@@ -298,7 +228,7 @@ namespace lms::api::subsonic
                 {
                     Track::find(
                         context.getDbSession(), cachedLastRetrievedId, songCount, [&](const Track::pointer& track) {
-                            searchResultNode.addArrayChild("song", createSongNode(context, track, id3));
+                            tracks.push_back(track);
                         },
                         mediaLibrary);
                     lastRetrievedId = cachedLastRetrievedId;
@@ -314,9 +244,11 @@ namespace lms::api::subsonic
                     currentScansInProgress.setObjectId(scanInfo, lastRetrievedId);
                 }
             }
+
+            return tracks;
         }
 
-        Response handleSearchRequestCommon(RequestContext& context, bool id3)
+        void handleSearchRequestCommon(RequestContext& context, ResponseWriter& writer, bool id3)
         {
             // Mandatory params
             const std::string queryString{ getMandatoryParameterAs<std::string>(context.getParameters(), "query") };
@@ -333,8 +265,8 @@ namespace lms::api::subsonic
             if (!query.empty())
                 keywords = core::stringUtils::splitString(query, ' ');
 
-            Response response{ Response::createOkResponse(context.getServerProtocolVersion()) };
-            Response::Node& searchResultNode{ response.createNode(id3 ? "searchResult3" : "searchResult2") };
+            // artists and albums are few, only the songs are streamed
+            Response::Node searchResultNode;
 
             auto transaction{ context.getDbSession().createReadTransaction() };
 
@@ -343,19 +275,23 @@ namespace lms::api::subsonic
             else
                 findRequestedArtistDirectories(context, keywords, mediaLibrary, searchResultNode);
             findRequestedAlbums(context, id3, keywords, mediaLibrary, searchResultNode);
-            findRequestedTracks(context, id3, keywords, mediaLibrary, searchResultNode);
+            const std::vector<Track::pointer> tracks{ findRequestedTracks(context, keywords, mediaLibrary) };
+            const SongBatch songBatch{ context.getDbSession(), tracks };
 
-            return response;
+            writer.beginNode(id3 ? "searchResult3" : "searchResult2");
+            writer.writeNodeContent(searchResultNode);
+            writeSongArray(writer, context, tracks, id3, songBatch);
+            writer.endNode();
         }
     } // namespace
 
-    Response handleSearch2Request(RequestContext& context)
+    void handleSearch2Request(RequestContext& context, ResponseWriter& writer)
     {
-        return handleSearchRequestCommon(context, false /* no id3 */);
+        handleSearchRequestCommon(context, writer, false /* no id3 */);
     }
 
-    Response handleSearch3Request(RequestContext& context)
+    void handleSearch3Request(RequestContext& context, ResponseWriter& writer)
     {
-        return handleSearchRequestCommon(context, true /* id3 */);
+        handleSearchRequestCommon(context, writer, true /* id3 */);
     }
 } // namespace lms::api::subsonic
\ No newline at end of file
@@ -6,6 +6,6 @@
 
 namespace lms::api::subsonic
 {
-    Response handleSearch2Request(RequestContext& context);
-    Response handleSearch3Request(RequestContext& context);
+    void handleSearch2Request(RequestContext& context, ResponseWriter& writer);
+    void handleSearch3Request(RequestContext& context, ResponseWriter& writer);
 } // namespace lms::api::subsonic
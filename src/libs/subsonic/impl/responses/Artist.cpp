@@ -48,41 +48,57 @@ namespace lms::api::subsonic
     {
         LMS_SCOPED_TRACE_DETAILED("Subsonic", "CreateArtist");
 
-        Response::Node artistNode{ createArtistNode(artist) };
+        ArtistIndex::Artist artistData{
+            .id = artist->getId(),
+            .name = artist->getName(),
+            .sortName = artist->getSortName(),
+            .mbid = artist->getMBID(),
+            .albumCount = Release::getCount(context.getDbSession(), Release::FindParameters{}.setArtist(artist->getId())),
+        };
 
-        artistNode.setAttribute("id", idToString(artist->getId()));
-        artistNode.setAttribute("name", artist->getName());
         if (const auto artwork{ artist->getPreferredArtwork() })
         {
-            CoverArtId coverArtId{ artwork->getId(), artwork->getLastWrittenTime().toTime_t() };
+            artistData.artworkId = artwork->getId();
+            artistData.artworkLastWrittenTime = artwork->getLastWrittenTime().toTime_t();
+        }
+
+        // roles are only reported with OpenSubsonic
+        if (context.isOpenSubsonicEnabled())
+            artistData.roles = TrackArtistLink::findUsedTypes(context.getDbSession(), artist->getId());
+
+        feedback::IFeedbackService& feedbackService{ *core::Service<feedback::IFeedbackService>::get() };
+        return createArtistNode(context, artistData, feedbackService.getStarredDateTime(context.getUser()->getId(), artist->getId()), feedbackService.getRating(context.getUser()->getId(), artist->getId()));
+    }
+
+    Response::Node createArtistNode(RequestContext& context, const ArtistIndex::Artist& artist, const Wt::WDateTime& starredDateTime, std::optional<Rating> rating)
+    {
+        Response::Node artistNode;
+
+        artistNode.setAttribute("id", idToString(artist.id));
+        artistNode.setAttribute("name", artist.name);
+        if (artist.artworkId.isValid())
+        {
+            CoverArtId coverArtId{ artist.artworkId, artist.artworkLastWrittenTime };
             artistNode.setAttribute("coverArt", idToString(coverArtId));
         }
 
-        const std::size_t count{ Release::getCount(context.getDbSession(), Release::FindParameters{}.setArtist(artist->getId())) };
-        artistNode.setAttribute("albumCount", count);
+        artistNode.setAttribute("albumCount", artist.albumCount);
 
-        if (const Wt::WDateTime dateTime{ core::Service<feedback::IFeedbackService>::get()->getStarredDateTime(context.getUser()->getId(), artist->getId()) }; dateTime.isValid())
-            artistNode.setAttribute("starred", core::stringUtils::toISO8601String(dateTime));
+        if (starredDateTime.isValid())
+            artistNode.setAttribute("starred", core::stringUtils::toISO8601String(starredDateTime));
 
-        if (const auto rating{ core::Service<feedback::IFeedbackService>::get()->getRating(context.getUser()->getId(), artist->getId()) })
+        if (rating)
             artistNode.setAttribute("userRating", *rating);
 
         // OpenSubsonic specific fields (must always be set)
         if (context.isOpenSubsonicEnabled())
         {
             artistNode.setAttribute("mediaType", "artist");
+            artistNode.setAttribute("musicBrainzId", artist.mbid ? artist.mbid->getAsString() : "");
+            artistNode.setAttribute("sortName", artist.sortName);
 
-            {
-                std::optional<core::UUID> mbid{ artist->getMBID() };
-                artistNode.setAttribute("musicBrainzId", mbid ? mbid->getAsString() : "");
-            }
-
-            artistNode.setAttribute("sortName", artist->getSortName());
-
-            // roles
-            Response::Node roles;
             artistNode.createEmptyArrayValue("roles");
-            for (const TrackArtistLinkType linkType : TrackArtistLink::findUsedTypes(context.getDbSession(), artist->getId()))
+            for (const TrackArtistLinkType linkType : artist.roles)
                 artistNode.addArrayValue("roles", utils::toString(linkType));
         }
 
@@ -1,12 +1,16 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <vector>
 
+#include <Wt/WDateTime.h>
+
 #include "database/Object.hpp"
 #include "database/Types.hpp"
 
+#include "ArtistIndex.hpp"
 #include "SubsonicResponse.hpp"
 
 namespace lms::db
@@ -27,5 +31,7 @@ namespace lms::api::subsonic
     } // namespace utils
 
     Response::Node createArtistNode(RequestContext& context, const db::ObjectPtr<db::Artist>& artist);
+    // Using precomputed data, feedback of the current user included
+    Response::Node createArtistNode(RequestContext& context, const ArtistIndex::Artist& artist, const Wt::WDateTime& starredDateTime, std::optional<db::Rating> rating);
     Response::Node createArtistNode(const db::ObjectPtr<db::Artist>& artist); // only minimal info
 } // namespace lms::api::subsonic
\ No newline at end of file
@@ -1,6 +1,8 @@
 
 #include "responses/Song.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <filesystem>
 #include <string_view>
 #include <system_error>
@@ -25,6 +27,7 @@
 
 #include "CoverArtId.hpp"
 #include "RequestContext.hpp"
+#include "ResponseWriter.hpp"
 #include "SubsonicId.hpp"
 #include "responses/Artist.hpp"
 #include "responses/Contributor.hpp"
@@ -57,32 +60,122 @@ namespace lms::api::subsonic
         }
     } // namespace
 
+    SongBatch::SongBatch(Session& session, std::span<const Track::pointer> tracks)
+    {
+        LMS_SCOPED_TRACE_DETAILED("Subsonic", "LoadSongBatch");
+
+        // keep the IN lists reasonably sized
+        constexpr std::size_t maxChunkSize{ 500 };
+        for (std::size_t offset{}; offset < tracks.size(); offset += maxChunkSize)
+            load(session, tracks.subspan(offset, std::min(maxChunkSize, tracks.size() - offset)));
+    }
+
+    void SongBatch::load(Session& session, std::span<const Track::pointer> tracks)
+    {
+        std::vector<TrackId> trackIds;
+        std::vector<ArtworkId> artworkIds;
+        trackIds.reserve(tracks.size());
+        for (const Track::pointer& track : tracks)
+        {
+            trackIds.push_back(track->getId());
+            _trackInfos.try_emplace(track->getId());
+
+            if (const ArtworkId artworkId{ track->getPreferredMediaArtworkId() }; artworkId.isValid())
+                artworkIds.push_back(artworkId);
+            else if (const ArtworkId artworkId{ track->getPreferredArtworkId() }; artworkId.isValid())
+                artworkIds.push_back(artworkId);
+        }
+
+        Track::loadRelatedObjects(session, tracks);
+
+        TrackArtistLink::find(session, trackIds, [&](const TrackArtistLink::pointer& link, const Artist::pointer& artist) {
+            _trackInfos[link->getTrackId()].artistLinks.push_back(ArtistLink{ link, artist });
+        });
+
+        Cluster::find(session, trackIds, "GENRE", [&](TrackId trackId, const Cluster::pointer& cluster) {
+            _trackInfos[trackId].genres.push_back(cluster);
+        });
+
+        Cluster::find(session, trackIds, "MOOD", [&](TrackId trackId, const Cluster::pointer& cluster) {
+            _trackInfos[trackId].moods.push_back(cluster);
+        });
+
+        std::sort(std::begin(artworkIds), std::end(artworkIds));
+        artworkIds.erase(std::unique(std::begin(artworkIds), std::end(artworkIds)), std::end(artworkIds));
+        Artwork::findLastWrittenTimes(session, artworkIds, [&](ArtworkId artworkId, const Wt::WDateTime& lastWrittenTime) {
+            _artworkLastWrittenTimes.emplace(artworkId, lastWrittenTime);
+        });
+    }
+
+    SongBatch::~SongBatch() = default;
+
+    std::span<const SongBatch::ArtistLink> SongBatch::getArtistLinks(TrackId trackId) const
+    {
+        if (const TrackInfo * trackInfo{ getTrackInfo(trackId) })
+            return trackInfo->artistLinks;
+
+        return {};
+    }
+
+    std::span<const Cluster::pointer> SongBatch::getGenres(TrackId trackId) const
+    {
+        if (const TrackInfo * trackInfo{ getTrackInfo(trackId) })
+            return trackInfo->genres;
+
+        return {};
+    }
+
+    std::span<const Cluster::pointer> SongBatch::getMoods(TrackId trackId) const
+    {
+        if (const TrackInfo * trackInfo{ getTrackInfo(trackId) })
+            return trackInfo->moods;
+
+        return {};
+    }
+
+    Wt::WDateTime SongBatch::getArtworkLastWrittenTime(ArtworkId artworkId) const
+    {
+        const auto it{ _artworkLastWrittenTimes.find(artworkId) };
+        return it != std::cend(_artworkLastWrittenTimes) ? it->second : Wt::WDateTime{};
+    }
+
+    const SongBatch::TrackInfo* SongBatch::getTrackInfo(TrackId trackId) const
+    {
+        const auto it{ _trackInfos.find(trackId) };
+        assert(it != std::cend(_trackInfos));
+        return it != std::cend(_trackInfos) ? &it->second : nullptr;
+    }
+
     Response::Node createSongNode(RequestContext& context, const Track::pointer& track, bool id3)
+    {
+        const SongBatch batch{ context.getDbSession(), std::span{ &track, 1 } };
+        return createSongNode(context, track, id3, batch);
+    }
+
+    void writeSongContent(ResponseWriter& writer, RequestContext& context, const Track::pointer& track, bool id3, const SongBatch& batch)
     {
         LMS_SCOPED_TRACE_DETAILED("Subsonic", "CreateSong");
 
         const auto medium{ track->getMedium() };
 
-        Response::Node trackResponse;
-
         if (!id3)
         {
             if (const auto directory{ track->getDirectory() })
-                trackResponse.setAttribute("parent", idToString(directory->getId()));
+                writer.writeAttribute("parent", idToString(directory->getId()));
         }
 
-        trackResponse.setAttribute("isDir", false);
-        trackResponse.setAttribute("id", idToString(track->getId()));
-        trackResponse.setAttribute("title", track->getName());
+        writer.writeAttribute("isDir", false);
+        writer.writeAttribute("id", idToString(track->getId()));
+        writer.writeAttribute("title", track->getName());
         if (track->getTrackNumber())
-            trackResponse.setAttribute("track", *track->getTrackNumber());
+            writer.writeAttribute("track", *track->getTrackNumber());
         if (medium && medium->getPosition())
-            trackResponse.setAttribute("discNumber", *medium->getPosition());
+            writer.writeAttribute("discNumber", *medium->getPosition());
         if (const auto originalYear{ track->getOriginalYear() })
-            trackResponse.setAttribute("year", *originalYear);
+            writer.writeAttribute("year", *originalYear);
         else if (const auto year{ track->getYear() })
-            trackResponse.setAttribute("year", *year);
-        trackResponse.setAttribute("playCount", core::Service<scrobbling::IScrobblingService>::get()->getCount(context.getUser()->getId(), track->getId()));
+            writer.writeAttribute("year", *year);
+        writer.writeAttribute("playCount", core::Service<scrobbling::IScrobblingService>::get()->getCount(context.getUser()->getId(), track->getId()));
 
         // maybe not available if user just removed the library without rescanning
         if (const db::MediaLibrary::pointer library{ track->getMediaLibrary() })
@@ -90,22 +183,22 @@ namespace lms::api::subsonic
             std::error_code ec;
             const std::filesystem::path relativeTrackPath{ std::filesystem::relative(track->getAbsoluteFilePath(), library->getPath(), ec) };
             if (!ec && !relativeTrackPath.empty())
-                trackResponse.setAttribute("path", relativeTrackPath.c_str());
+                writer.writeAttribute("path", relativeTrackPath.c_str());
         }
 
-        trackResponse.setAttribute("size", track->getFileSize());
+        writer.writeAttribute("size", track->getFileSize());
 
         if (track->getAbsoluteFilePath().has_extension())
         {
             auto extension{ track->getAbsoluteFilePath().extension() };
-            trackResponse.setAttribute("suffix", extension.string().substr(1) /* skip leading .*/);
+            writer.writeAttribute("suffix", extension.string().substr(1) /* skip leading .*/);
         }
 
         if (context.getUser()->getSubsonicEnableTranscodingByDefault())
         {
             const std::string fileSuffix{ formatToSuffix(context.getUser()->getSubsonicDefaultTranscodingOutputFormat()) };
-            trackResponse.setAttribute("transcodedSuffix", fileSuffix);
-            trackResponse.setAttribute("transcodedContentType", core::getMimeType(std::filesystem::path{ "." + fileSuffix }));
+            writer.writeAttribute("transcodedSuffix", fileSuffix);
+            writer.writeAttribute("transcodedContentType", core::getMimeType(std::filesystem::path{ "." + fileSuffix }));
         }
 
         auto artwork{ track->getPreferredMediaArtwork() };
@@ -114,114 +207,77 @@ namespace lms::api::subsonic
 
         if (artwork)
         {
-            CoverArtId coverArtId{ artwork->getId(), artwork->getLastWrittenTime().toTime_t() };
-            trackResponse.setAttribute("coverArt", idToString(coverArtId));
+            CoverArtId coverArtId{ artwork->getId(), batch.getArtworkLastWrittenTime(artwork->getId()).toTime_t() };
+            writer.writeAttribute("coverArt", idToString(coverArtId));
         }
 
-        const std::vector<Artist::pointer>& artists{ track->getArtists({ TrackArtistLinkType::Artist }) };
+        std::vector<Artist::pointer> artists;
+        for (const SongBatch::ArtistLink& artistLink : batch.getArtistLinks(track->getId()))
+        {
+            if (artistLink.link->getType() != TrackArtistLinkType::Artist)
+                continue;
+
+            if (std::none_of(std::cbegin(artists), std::cend(artists), [&](const Artist::pointer& artist) { return artist->getId() == artistLink.artist->getId(); }))
+                artists.push_back(artistLink.artist);
+        }
         if (!artists.empty())
         {
             if (!track->getArtistDisplayName().empty())
-                trackResponse.setAttribute("artist", track->getArtistDisplayName());
+                writer.writeAttribute("artist", track->getArtistDisplayName());
             else
-                trackResponse.setAttribute("artist", utils::joinArtistNames(artists));
+                writer.writeAttribute("artist", utils::joinArtistNames(artists));
 
             if (artists.size() == 1)
-                trackResponse.setAttribute("artistId", idToString(artists.front()->getId()));
+                writer.writeAttribute("artistId", idToString(artists.front()->getId()));
         }
 
         const Release::pointer release{ track->getRelease() };
         if (release)
         {
-            trackResponse.setAttribute("album", release->getName());
-            trackResponse.setAttribute("albumId", idToString(release->getId()));
+            writer.writeAttribute("album", release->getName());
+            writer.writeAttribute("albumId", idToString(release->getId()));
         }
 
-        trackResponse.setAttribute("duration", std::chrono::duration_cast<std::chrono::seconds>(track->getDuration()).count());
-        trackResponse.setAttribute("bitRate", (track->getBitrate() / 1000));
-        trackResponse.setAttribute("type", "music");
-        trackResponse.setAttribute("created", core::stringUtils::toISO8601String(track->getAddedTime()));
-        trackResponse.setAttribute("contentType", core::getMimeType(track->getAbsoluteFilePath().extension()));
+        writer.writeAttribute("duration", std::chrono::duration_cast<std::chrono::seconds>(track->getDuration()).count());
+        writer.writeAttribute("bitRate", (track->getBitrate() / 1000));
+        writer.writeAttribute("type", "music");
+        writer.writeAttribute("created", core::stringUtils::toISO8601String(track->getAddedTime()));
+        writer.writeAttribute("contentType", core::getMimeType(track->getAbsoluteFilePath().extension()));
         if (const auto rating{ core::Service<feedback::IFeedbackService>::get()->getRating(context.getUser()->getId(), track->getId()) })
-            trackResponse.setAttribute("userRating", *rating);
+            writer.writeAttribute("userRating", *rating);
 
         if (const Wt::WDateTime dateTime{ core::Service<feedback::IFeedbackService>::get()->getStarredDateTime(context.getUser()->getId(), track->getId()) }; dateTime.isValid())
-            trackResponse.setAttribute("starred", core::stringUtils::toISO8601String(dateTime));
+            writer.writeAttribute("starred", core::stringUtils::toISO8601String(dateTime));
 
         // Report the first GENRE for this track
-        std::vector<Cluster::pointer> genres;
-        {
-            Cluster::FindParameters params;
-            params.setTrack(track->getId());
-            params.setClusterTypeName("GENRE");
-
-            genres = Cluster::find(context.getDbSession(), params).results;
-            if (!genres.empty())
-                trackResponse.setAttribute("genre", genres.front()->getName());
-        }
+        const std::span<const Cluster::pointer> genres{ batch.getGenres(track->getId()) };
+        if (!genres.empty())
+            writer.writeAttribute("genre", genres.front()->getName());
 
         // OpenSubsonic specific fields (must always be set)
         if (!context.isOpenSubsonicEnabled())
-            return trackResponse;
+            return;
 
-        trackResponse.setAttribute("comment", track->getComment());
-        trackResponse.setAttribute("bitDepth", track->getBitsPerSample());
-        trackResponse.setAttribute("samplingRate", track->getSampleRate());
-        trackResponse.setAttribute("channelCount", track->getChannelCount());
+        writer.writeAttribute("comment", track->getComment());
+        writer.writeAttribute("bitDepth", track->getBitsPerSample());
+        writer.writeAttribute("samplingRate", track->getSampleRate());
+        writer.writeAttribute("channelCount", track->getChannelCount());
 
-        trackResponse.setAttribute("mediaType", "song");
+        writer.writeAttribute("mediaType", "song");
 
         {
             const Wt::WDateTime dateTime{ core::Service<scrobbling::IScrobblingService>::get()->getLastListenDateTime(context.getUser()->getId(), track->getId()) };
-            trackResponse.setAttribute("played", dateTime.isValid() ? core::stringUtils::toISO8601String(dateTime) : "");
+            writer.writeAttribute("played", dateTime.isValid() ? core::stringUtils::toISO8601String(dateTime) : "");
         }
 
         {
             std::optional<core::UUID> mbid{ track->getRecordingMBID() };
-            trackResponse.setAttribute("musicBrainzId", mbid ? mbid->getAsString() : "");
+            writer.writeAttribute("musicBrainzId", mbid ? mbid->getAsString() : "");
         }
 
-        {
-            trackResponse.createEmptyArrayChild("albumartists");
-            trackResponse.createEmptyArrayChild("artists");
-            trackResponse.createEmptyArrayChild("contributors");
-
-            TrackArtistLink::find(context.getDbSession(), track->getId(), [&](const TrackArtistLink::pointer& link, const Artist::pointer& artist) {
-                switch (link->getType())
-                {
-                case TrackArtistLinkType::Artist:
-                    trackResponse.addArrayChild("artists", createArtistNode(artist));
-                    break;
-                case TrackArtistLinkType::ReleaseArtist:
-                    trackResponse.addArrayChild("albumartists", createArtistNode(artist));
-                    break;
-                default:
-                    trackResponse.addArrayChild("contributors", createContributorNode(link, artist));
-                }
-            });
-        }
-
-        trackResponse.setAttribute("displayArtist", track->getArtistDisplayName());
+        writer.writeAttribute("displayArtist", track->getArtistDisplayName());
         if (release)
-            trackResponse.setAttribute("displayAlbumArtist", release->getArtistDisplayName());
-
-        auto addClusters{ [&](Response::Node::Key field, std::string_view clusterTypeName) {
-            trackResponse.createEmptyArrayValue(field);
-
-            Cluster::FindParameters params;
-            params.setTrack(track->getId());
-            params.setClusterTypeName(clusterTypeName);
-
-            for (const auto& cluster : Cluster::find(context.getDbSession(), params).results)
-                trackResponse.addArrayValue(field, cluster->getName());
-        } };
-
-        addClusters("moods", "MOOD");
-
-        // Genres
-        trackResponse.createEmptyArrayChild("genres");
-        for (const auto& genre : genres)
-            trackResponse.addArrayChild("genres", createItemGenreNode(genre->getName()));
+            writer.writeAttribute("displayAlbumArtist", release->getArtistDisplayName());
 
         auto advisoryToExplicitStatus = [](db::Advisory advisory) -> std::string_view {
             switch (advisory)
@@ -237,10 +293,71 @@ namespace lms::api::subsonic
 
             return "";
         };
-        trackResponse.setAttribute("explicitStatus", advisoryToExplicitStatus(track->getAdvisory()));
+        writer.writeAttribute("explicitStatus", advisoryToExplicitStatus(track->getAdvisory()));
 
-        trackResponse.addChild("replayGain", createReplayGainNode(track, medium));
+        // Children, once all the attributes are written
+        const std::span<const SongBatch::ArtistLink> artistLinks{ batch.getArtistLinks(track->getId()) };
+
+        writer.beginArray("albumartists");
+        for (const SongBatch::ArtistLink& artistLink : artistLinks)
+        {
+            if (artistLink.link->getType() == TrackArtistLinkType::ReleaseArtist)
+                writer.writeArrayNode(createArtistNode(artistLink.artist));
+        }
+        writer.endArray();
+
+        writer.beginArray("artists");
+        for (const SongBatch::ArtistLink& artistLink : artistLinks)
+        {
+            if (artistLink.link->getType() == TrackArtistLinkType::Artist)
+                writer.writeArrayNode(createArtistNode(artistLink.artist));
+        }
+        writer.endArray();
+
+        writer.beginArray("contributors");
+        for (const SongBatch::ArtistLink& artistLink : artistLinks)
+        {
+            if (artistLink.link->getType() != TrackArtistLinkType::Artist && artistLink.link->getType() != TrackArtistLinkType::ReleaseArtist)
+                writer.writeArrayNode(createContributorNode(artistLink.link, artistLink.artist));
+        }
+        writer.endArray();
+
+        writer.beginArray("moods");
+        for (const Cluster::pointer& mood : batch.getMoods(track->getId()))
+            writer.writeArrayValue(mood->getName());
+        writer.endArray();
+
+        writer.beginArray("genres");
+        for (const auto& genre : genres)
+            writer.writeArrayNode(createItemGenreNode(genre->getName()));
+        writer.endArray();
+
+        writer.writeNode("replayGain", createReplayGainNode(track, medium));
+    }
+
+    Response::Node createSongNode(RequestContext& context, const Track::pointer& track, bool id3, const SongBatch& batch)
+    {
+        Response::Node trackResponse;
+
+        const std::unique_ptr<ResponseWriter> writer{ createNodeResponseWriter(trackResponse) };
+        writeSongContent(*writer, context, track, id3, batch);
+        writer->finish();
 
         return trackResponse;
     }
-} // namespace lms::api::subsonic
\ No newline at end of file
+
+    void writeSongArray(ResponseWriter& writer, RequestContext& context, std::span<const Track::pointer> tracks, bool id3, const SongBatch& batch)
+    {
+        if (tracks.empty())
+            return;
+
+        writer.beginArray("song");
+        for (const Track::pointer& track : tracks)
+        {
+            writer.beginArrayNode();
+            writeSongContent(writer, context, track, id3, batch);
+            writer.endNode();
+        }
+        writer.endArray();
+    }
+} // namespace lms::api::subsonic
@@ -1,13 +1,23 @@
-
 #pragma once
 
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <Wt/WDateTime.h>
+
 #include "database/Object.hpp"
+#include "database/objects/ArtworkId.hpp"
+#include "database/objects/TrackId.hpp"
 
 #include "SubsonicResponse.hpp"
 
 namespace lms::db
 {
+    class Artist;
+    class Cluster;
     class Track;
+    class TrackArtistLink;
     class User;
     class Session;
 } // namespace lms::db
@@ -16,5 +26,48 @@ namespace lms::api::subsonic
 {
     struct RequestContext;
 
+    // SongBatch: 批量加载一组曲目的关联数据（艺术家链接、流派、情绪、封面、专辑、碟片等），每种数据只需一次查询。
+    // SongBatch: пакетно загружает связанные данные набора треков (ссылки на артистов, жанры, настроения, обложки, альбомы, диски), один запрос на тип данных.
+    //
+    // Must be used within the transaction used to load the tracks
+    class SongBatch
+    {
+    public:
+        SongBatch(db::Session& session, std::span<const db::ObjectPtr<db::Track>> tracks);
+        ~SongBatch();
+        SongBatch(const SongBatch&) = delete;
+        SongBatch& operator=(const SongBatch&) = delete;
+
+        struct ArtistLink
+        {
+            db::ObjectPtr<db::TrackArtistLink> link;
+            db::ObjectPtr<db::Artist> artist;
+        };
+
+        std::span<const ArtistLink> getArtistLinks(db::TrackId trackId) const;
+        std::span<const db::ObjectPtr<db::Cluster>> getGenres(db::TrackId trackId) const;
+        std::span<const db::ObjectPtr<db::Cluster>> getMoods(db::TrackId trackId) const;
+        Wt::WDateTime getArtworkLastWrittenTime(db::ArtworkId artworkId) const;
+
+    private:
+        struct TrackInfo
+        {
+            std::vector<ArtistLink> artistLinks; // ordered by link creation
+            std::vector<db::ObjectPtr<db::Cluster>> genres;
+            std::vector<db::ObjectPtr<db::Cluster>> moods;
+        };
+        void load(db::Session& session, std::span<const db::ObjectPtr<db::Track>> tracks);
+        const TrackInfo* getTrackInfo(db::TrackId trackId) const;
+
+        std::unordered_map<db::TrackId, TrackInfo> _trackInfos;
+        std::unordered_map<db::ArtworkId, Wt::WDateTime> _artworkLastWrittenTimes;
+    };
+
     Response::Node createSongNode(RequestContext& context, const db::ObjectPtr<db::Track>& track, bool id3);
-} // namespace lms::api::subsonic
\ No newline at end of file
+    // batch must contain track
+    Response::Node createSongNode(RequestContext& context, const db::ObjectPtr<db::Track>& track, bool id3, const SongBatch& batch);
+
+    // Push based alternatives, batch must contain the tracks
+    void writeSongContent(ResponseWriter& writer, RequestContext& context, const db::ObjectPtr<db::Track>& track, bool id3, const SongBatch& batch); // attributes and children of the current node
+    void writeSongArray(ResponseWriter& writer, RequestContext& context, std::span<const db::ObjectPtr<db::Track>> tracks, bool id3, const SongBatch& batch); // "song" array, nothing written if no track
+} // namespace lms::api::subsonic
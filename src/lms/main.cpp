@@ -475,11 +475,11 @@ namespace lms
             }
 
             image::init(argv[0]);
-            core::Service<artwork::IArtworkService> artworkService{ artwork::createArtworkService(*database, server.appRoot() + "/images/unknown-cover.svg", server.appRoot() + "/images/unknown-artist.svg") };
+            core::Service<artwork::IArtworkService> artworkService{ artwork::createArtworkService(*database, server.appRoot() + "/images/unknown-cover.svg", server.appRoot() + "/images/unknown-artist.svg", cachePath / "artwork") };
             core::Service<recommendation::IRecommendationService> recommendationService{ recommendation::createRecommendationService(*database) };
             core::Service<recommendation::IPlaylistGeneratorService> playlistGeneratorService{ recommendation::createPlaylistGeneratorService(*database, *recommendationService) };
             core::Service<scanner::IScannerService> scannerService{ scanner::createScannerService(*database, cachePath) };
-            core::Service<transcoding::ITranscodeService> transcodingService{ transcoding::createTranscodeService(*database, *childProcessManagerService) };
+            core::Service<transcoding::ITranscodeService> transcodingService{ transcoding::createTranscodeService(*database, *childProcessManagerService, cachePath / "transcode") };
             core::Service<podcast::IPodcastService> podcastService{ podcast::createPodcastService(ioContext, *database, cachePath / "podcasts") };
 
             // 扫描完成时刷新封面缓存（即使没有变更）
@@ -492,6 +492,13 @@ namespace lms
                 artworkService->flushCache();
             });
 
+            // 扫描有变更时重建相似度索引
+            // При изменениях после сканирования перестраиваем индекс похожести
+            scannerService->getEvents().scanComplete.connect([&](const scanner::ScanStats& stats) {
+                if (stats.getChangesCount() > 0)
+                    recommendationService->reload();
+            });
+
             core::Service<feedback::IFeedbackService> feedbackService{ feedback::createFeedbackService(ioContext, *database) };
             core::Service<scrobbling::IScrobblingService> scrobblingService{ scrobbling::createScrobblingService(ioContext, *database) };
 